@@ -3,9 +3,10 @@
 #include "VertexBuffer.h"
 #include "ChunkManager.h"
 #include "NeighbouringChunks.h"
-#include "glm/gtc/noise.hpp"
+#include "Profiler.h"
 #include <algorithm>
 #include <limits>
+#include <random>
 
 //OLD VALUES
 
@@ -57,21 +58,16 @@ namespace
 	{
 		return { worldPosition.x - chunkStartingPosition.x, worldPosition.y - chunkStartingPosition.y, worldPosition.z - chunkStartingPosition.z };
 	}
-
-	const CubeTypeComparison NON_STACKABLE_CUBE_TYPES =
-	{
-		{eCubeType::Water,
-		eCubeType::Shrub,
-		eCubeType::TallGrass}
-	};
-
-	static int SEED = Globals::getRandomNumber(0, Globals::MAP_SIZE);
 }
 
 Chunk::Chunk()
 	: m_startingPosition(),
 	m_endingPosition(),
 	m_chunk(),
+	m_surfaceHeights(),
+	m_maxHeight(-1),
+	m_trees(),
+	m_treeCount(0),
 	m_AABB()
 {}
 
@@ -81,6 +77,10 @@ Chunk::Chunk(const glm::ivec3& startingPosition)
 		startingPosition.y + Globals::CHUNK_HEIGHT, 
 		startingPosition.z + Globals::CHUNK_DEPTH),
 	m_chunk(),
+	m_surfaceHeights(),
+	m_maxHeight(-1),
+	m_trees(),
+	m_treeCount(0),
 	m_AABB(glm::ivec2(m_startingPosition.x, m_startingPosition.z) +
 		glm::ivec2(Globals::CHUNK_WIDTH / 2, Globals::CHUNK_DEPTH / 2), 16)
 {
@@ -91,6 +91,10 @@ Chunk::Chunk(Chunk&& orig) noexcept
 	: m_startingPosition(orig.m_startingPosition),
 	m_endingPosition(orig.m_endingPosition),
 	m_chunk(std::move(orig.m_chunk)),
+	m_surfaceHeights(orig.m_surfaceHeights),
+	m_maxHeight(orig.m_maxHeight),
+	m_trees(orig.m_trees),
+	m_treeCount(orig.m_treeCount),
 	m_AABB(orig.m_AABB)
 {}
 
@@ -99,6 +103,10 @@ Chunk& Chunk::operator=(Chunk&& orig) noexcept
 	m_startingPosition = orig.m_startingPosition;
 	m_endingPosition = orig.m_endingPosition;
 	m_chunk = std::move(orig.m_chunk);
+	m_surfaceHeights = orig.m_surfaceHeights;
+	m_maxHeight = orig.m_maxHeight;
+	m_trees = orig.m_trees;
+	m_treeCount = orig.m_treeCount;
 	m_AABB = orig.m_AABB;
 
 	return *this;
@@ -106,7 +114,7 @@ Chunk& Chunk::operator=(Chunk&& orig) noexcept
 
 glm::ivec3 Chunk::getHighestCubeAtPosition(const glm::ivec3& position) const
 {
-	for (int y = Globals::CHUNK_HEIGHT - 1; y >= 0; --y)
+	for (int y = std::min(m_maxHeight, Globals::CHUNK_HEIGHT - 1); y >= 0; --y)
 	{
 		if (isCubeAtLocalPosition(convertToLocalPosition({ position.x, y, position.z }, m_startingPosition)))
 		{
@@ -158,6 +166,11 @@ const glm::ivec3& Chunk::getEndingPosition() const
 	return m_endingPosition;
 }
 
+int Chunk::getMaxHeight() const
+{
+	return std::min(m_maxHeight, Globals::CHUNK_HEIGHT - 1);
+}
+
 char Chunk::getCubeDetailsWithoutBoundsCheck(const glm::ivec3& position) const
 {
 	glm::ivec3 positionOnGrid(position.x - m_startingPosition.x, position.y - m_startingPosition.y, position.z - m_startingPosition.z);
@@ -165,6 +178,12 @@ char Chunk::getCubeDetailsWithoutBoundsCheck(const glm::ivec3& position) const
 	return m_chunk[converTo1D(positionOnGrid)];
 }
 
+const char* Chunk::getCubeRowWithoutBoundsCheck(int localY, int localZ) const
+{
+	assert(isPositionInLocalBounds({ 0, localY, localZ }));
+	return &m_chunk[converTo1D({ 0, localY, localZ })];
+}
+
 bool Chunk::isCubeAtPosition(const glm::ivec3& position) const
 {
 	if (isPositionInBounds(position))
@@ -193,10 +212,47 @@ bool Chunk::isCubeAtLocalPosition(const glm::ivec3& localPosition) const
 	return m_chunk[converTo1D(localPosition)] != static_cast<char>(eCubeType::Air);
 }
 
+int Chunk::getTreeCount() const
+{
+	return m_treeCount;
+}
+
+const TreePlacement& Chunk::getTree(int index) const
+{
+	assert(index >= 0 && index < m_treeCount);
+	return m_trees[index];
+}
+
 void Chunk::changeCubeAtLocalPosition(const glm::ivec3& position, eCubeType cubeType)
 {
 	assert(isPositionInLocalBounds(position));
 	m_chunk[converTo1D(position)] = static_cast<char>(cubeType);
+	if (cubeType != eCubeType::Air)
+	{
+		m_maxHeight = std::max(m_maxHeight, position.y);
+	}
+}
+
+void Chunk::fillRows(int localZ, int startY, int endY, eCubeType cubeType)
+{
+	if (startY <= endY)
+	{
+		assert(isPositionInLocalBounds({ 0, startY, localZ }) && isPositionInLocalBounds({ 0, endY, localZ }));
+		memset(&m_chunk[converTo1D({ 0, startY, localZ })], static_cast<char>(cubeType), (endY - startY + 1) * Globals::CHUNK_WIDTH);
+	}
+}
+
+void Chunk::fillColumn(int localX, int localZ, int startY, int endY, eCubeType cubeType)
+{
+	if (startY <= endY)
+	{
+		assert(isPositionInLocalBounds({ localX, startY, localZ }) && isPositionInLocalBounds({ localX, endY, localZ }));
+		char* cube = &m_chunk[converTo1D({ localX, startY, localZ })];
+		for (int y = startY; y <= endY; ++y, cube += Globals::CHUNK_WIDTH)
+		{
+			*cube = static_cast<char>(cubeType);
+		}
+	}
 }
 
 bool Chunk::addCubeAtPosition(const glm::ivec3& placementPosition, const NeighbouringChunks& neighbouringChunks, eCubeType cubeType)
@@ -207,7 +263,7 @@ bool Chunk::addCubeAtPosition(const glm::ivec3& placementPosition, const Neighbo
 	if (localPosition.y < Globals::CHUNK_HEIGHT && !isCubeAtLocalPosition(localPosition))
 	{
 		if (isCubeAtLocalPosition({ localPosition.x, localPosition.y - 1, localPosition.z }) &&
-			!NON_STACKABLE_CUBE_TYPES.isMatch(getCubeTypeByLocalPosition({ localPosition.x, localPosition.y - 1, localPosition.z })))
+			getCubeTypeProperties(getCubeTypeByLocalPosition({ localPosition.x, localPosition.y - 1, localPosition.z })).stackable)
 		{
 			changeCubeAtLocalPosition(localPosition, cubeType);
 			return true;
@@ -291,138 +347,197 @@ void Chunk::reset()
 	m_AABB = Rectangle();
 }
 
-void Chunk::reuse(const glm::ivec3& startingPosition)
+void Chunk::reuse(const glm::ivec3& startingPosition, bool caves)
 {	
-	memset(&m_chunk, static_cast<char>(eCubeType::Air), m_chunk.size());
-
 	m_startingPosition = startingPosition;
 	m_endingPosition = glm::ivec3(startingPosition.x + Globals::CHUNK_WIDTH, startingPosition.y + Globals::CHUNK_HEIGHT,
 		startingPosition.z + Globals::CHUNK_DEPTH);
 	m_AABB.reset(glm::ivec2(m_startingPosition.x, m_startingPosition.z) +
 		glm::ivec2(Globals::CHUNK_WIDTH / 2, Globals::CHUNK_DEPTH / 2), 16);
 
-	regen(m_startingPosition);	
+	regen(m_startingPosition, caves);	
 }
 
 
-void Chunk::regen(const glm::ivec3& startingPosition)
+//Writes every column from the bottom up to the highest cube in its row of columns, water included
+//Only rows the previous occupant left cubes in are cleared above that
+void Chunk::regen(const glm::ivec3& startingPosition, bool caves)
 {
-	for (int z = startingPosition.z; z < startingPosition.z + Globals::CHUNK_DEPTH; ++z)
+	PROFILE_SCOPE("Chunk::regen");
+	ChunkBiomeTypes biomeTypes;
+	TerrainNoise::sampleChunk(startingPosition, TerrainNoise::SAMPLING, m_surfaceHeights, biomeTypes);
+
+	int previousMaxHeight = m_maxHeight;
+	m_maxHeight = -1;
+	for (int z = 0; z < Globals::CHUNK_DEPTH; ++z)
 	{
-		for (int x = startingPosition.x; x < startingPosition.x + Globals::CHUNK_WIDTH; ++x)
+		int minElevation = Globals::CHUNK_HEIGHT - 1;
+		int maxHeight = Globals::WATER_MAX_HEIGHT;
+		for (int x = 0; x < Globals::CHUNK_WIDTH; ++x)
 		{
-			int elevation = getElevationAtPosition(x, z);
-			glm::ivec3 positionOnGrid(x - startingPosition.x, elevation, z - startingPosition.z);
-			eCubeType cubeType;
+			minElevation = std::min(minElevation, getSurfaceHeight(x, z));
+			maxHeight = std::max(maxHeight, getSurfaceHeight(x, z));
+		}
 
-			switch (getBiomeType(x, z))
-			{
-			case eBiomeType::Plains :
-			{
-				bool firstBlockPlaced = false;
-				for (int y = elevation; y >= 0; --y)
-				{
-					if (y <= Globals::STONE_MAX_HEIGHT)
-					{
-						cubeType = eCubeType::Stone;
-					}
-					else
-					{
-						if (firstBlockPlaced)
-						{
-							cubeType = eCubeType::Dirt;
-						}
-						else
-						{
-							cubeType = eCubeType::Grass;
-							firstBlockPlaced = true;
-						}
-					}
+		int sharedStoneHeight = std::min(minElevation, Globals::STONE_MAX_HEIGHT);
+		fillRows(z, 0, sharedStoneHeight, eCubeType::Stone);
+		for (int x = 0; x < Globals::CHUNK_WIDTH; ++x)
+		{
+			int elevation = getSurfaceHeight(x, z);
+			int stoneHeight = std::min(elevation, Globals::STONE_MAX_HEIGHT);
+			fillColumn(x, z, sharedStoneHeight + 1, stoneHeight, eCubeType::Stone);
 
-					changeCubeAtLocalPosition({ positionOnGrid.x, y, positionOnGrid.z }, cubeType);
-				}
-			}
-			break;
-			case eBiomeType::Desert:
+			switch (biomeTypes[z * Globals::CHUNK_WIDTH + x])
 			{
-				for (int y = elevation; y >= 0; --y)
+			case eBiomeType::Plains:
+				fillColumn(x, z, stoneHeight + 1, elevation - 1, eCubeType::Dirt);
+				if (elevation > Globals::STONE_MAX_HEIGHT)
 				{
-					if (y <= Globals::STONE_MAX_HEIGHT)
-					{
-						cubeType = eCubeType::Stone;
-					}
-					else
-					{
-						cubeType = eCubeType::Sand;
-					}
-
-					changeCubeAtLocalPosition({ positionOnGrid.x, y, positionOnGrid.z }, cubeType);
+					fillColumn(x, z, elevation, elevation, eCubeType::Grass);
 				}
-			}
-			break;
+				break;
+			case eBiomeType::Desert:
+				fillColumn(x, z, stoneHeight + 1, elevation, eCubeType::Sand);
+				break;
 			default:
 				assert(false);
 			}
+
+			fillColumn(x, z, elevation + 1, Globals::WATER_MAX_HEIGHT, eCubeType::Water);
+			fillColumn(x, z, std::max(elevation, Globals::WATER_MAX_HEIGHT) + 1, maxHeight, eCubeType::Air);
 		}
+
+		fillRows(z, maxHeight + 1, previousMaxHeight, eCubeType::Air);
+		m_maxHeight = std::max(m_maxHeight, maxHeight);
 	}
 
-	//Spawn Decoration
-	spawnWater();
-	spawnTrees();
-	spawnCactus();
-	spawnPlant(Globals::MAX_SHRUB_PER_CHUNK, eCubeType::Sand, eCubeType::Shrub);
-	spawnPlant(Globals::MAX_TALL_GRASS_PER_CHUNK, eCubeType::Grass, eCubeType::TallGrass);
+	if (caves)
+	{
+		spawnCaves();
+	}
+	placeTrees();
 }
 
-void Chunk::spawnWater()
+//Sections that are solid throughout or above the terrain are skipped
+void Chunk::spawnCaves()
 {
-	for (int z = 0; z < Globals::CHUNK_DEPTH; ++z)
+	thread_local CaveDensityField caveDensityField;
+	caveDensityField.sample(m_startingPosition, m_surfaceHeights);
+
+	std::array<float, CaveDensityField::SECTION_VOLUME> densities;
+	for (int sectionZ = 0; sectionZ < CaveDensityField::SECTIONS_DEPTH; ++sectionZ)
 	{
-		for (int x = 0; x < Globals::CHUNK_WIDTH; ++x)
+		for (int sectionX = 0; sectionX < CaveDensityField::SECTIONS_WIDTH; ++sectionX)
 		{
-			for (int y = 0; y <= Globals::WATER_MAX_HEIGHT; ++y)
+			int highestSurface = caveDensityField.getHighestSurface(sectionX, sectionZ);
+			for (int sectionY = caveDensityField.getMinSection(); sectionY * CaveDensityField::HEIGHT_SPACING <= highestSurface; ++sectionY)
 			{
-				glm::ivec3 position(x, y, z);
-				if ((isCubeAtLocalPosition(position, eCubeType::Air)))
+				glm::ivec3 sectionPosition(sectionX * CaveDensityField::SPACING, sectionY * CaveDensityField::HEIGHT_SPACING,
+					sectionZ * CaveDensityField::SPACING);
+				int startY = std::max(sectionPosition.y, Globals::WATER_MAX_HEIGHT + 1);
+				int endY = std::min(sectionPosition.y + CaveDensityField::HEIGHT_SPACING - 1, highestSurface);
+
+				switch (caveDensityField.getSection(sectionX, sectionY, sectionZ))
 				{
-					changeCubeAtLocalPosition(position, eCubeType::Water);
+				case eCaveSection::Solid:
+					break;
+				case eCaveSection::Carved:
+					for (int y = startY; y <= endY; ++y)
+					{
+						for (int z = sectionPosition.z; z < sectionPosition.z + CaveDensityField::SPACING; ++z)
+						{
+							memset(&m_chunk[converTo1D({ sectionPosition.x, y, z })], static_cast<char>(eCubeType::Air), CaveDensityField::SPACING);
+						}
+					}
+					break;
+				case eCaveSection::Mixed:
+					caveDensityField.interpolateSection(sectionX, sectionY, sectionZ, densities);
+					for (int y = startY; y <= endY; ++y)
+					{
+						for (int z = 0; z < CaveDensityField::SPACING; ++z)
+						{
+							const float* densityRow = &densities[((y - sectionPosition.y) * CaveDensityField::SPACING + z) * CaveDensityField::SPACING];
+							char* cubeRow = &m_chunk[converTo1D({ sectionPosition.x, y, sectionPosition.z + z })];
+							for (int x = 0; x < CaveDensityField::SPACING; ++x)
+							{
+								if (densityRow[x] > CaveDensityField::DENSITY_THRESHOLD)
+								{
+									cubeRow[x] = static_cast<char>(eCubeType::Air);
+								}
+							}
+						}
+					}
+					break;
+				default:
+					assert(false);
 				}
 			}
 		}
 	}
 }
 
-void Chunk::spawnTrees()
+void Chunk::decorate(const SurroundingChunks& surroundingChunks)
 {
-	if (Globals::getRandomNumber(0, 100) < Globals::CHANCE_TREE_SPAWN_IN_CHUNK)
+	for (int i = 0; i < m_treeCount; ++i)
 	{
-		return;
+		spawnTree(m_trees[i]);
 	}
-	
-	int attemptsCount = 0;
-	int spawnCount = 0;
-	while (attemptsCount < Globals::MAX_TREE_SPAWN_ATTEMPTS && spawnCount < Globals::MAX_TREE_PER_CHUNK)
+	for (const Chunk* surroundingChunk : surroundingChunks)
 	{
-		glm::ivec3 spawnPosition;
-		spawnPosition.x = Globals::getRandomNumber(MAX_LEAVES_DISTANCE, Globals::CHUNK_WIDTH - MAX_LEAVES_DISTANCE - 1);
-		spawnPosition.z = Globals::getRandomNumber(MAX_LEAVES_DISTANCE, Globals::CHUNK_DEPTH - MAX_LEAVES_DISTANCE - 1);
+		assert(surroundingChunk);
+		for (int i = 0; i < surroundingChunk->getTreeCount(); ++i)
+		{
+			spawnTree(surroundingChunk->getTree(i));
+		}
+	}
 
-		//Find Spawn Location
-		for (int y = Globals::CHUNK_HEIGHT - Globals::MAX_TREE_HEIGHT - MAX_LEAVES_DISTANCE - 1; y >= Globals::SAND_MAX_HEIGHT; --y)
+	spawnCactus();
+	spawnPlant(Globals::MAX_SHRUB_PER_CHUNK, eCubeType::Sand, eCubeType::Shrub);
+	spawnPlant(Globals::MAX_TALL_GRASS_PER_CHUNK, eCubeType::Grass, eCubeType::TallGrass);
+}
+
+//Trunks can stand anywhere in the chunk - leaves past its edges are stamped in by the surrounding chunks
+void Chunk::placeTrees()
+{
+	m_treeCount = 0;
+	std::mt19937 generator(TerrainNoise::getStructureSeed(m_startingPosition));
+	std::uniform_int_distribution<> chanceDistribution(0, 99);
+	std::uniform_int_distribution<> xDistribution(0, Globals::CHUNK_WIDTH - 1);
+	std::uniform_int_distribution<> zDistribution(0, Globals::CHUNK_DEPTH - 1);
+	std::uniform_int_distribution<> heightDistribution(Globals::MIN_TREE_HEIGHT, Globals::MAX_TREE_HEIGHT);
+	for (int i = 0; i < Globals::MAX_TREE_SPAWN_ATTEMPTS; ++i)
+	{
+		//Drawn every attempt so each attempt's tree doesn't depend on whether the ones before it fit
+		bool spawn = chanceDistribution(generator) < Globals::CHANCE_TREE_SPAWN;
+		glm::ivec3 spawnPosition;
+		spawnPosition.x = xDistribution(generator);
+		spawnPosition.z = zDistribution(generator);
+		int treeHeight = heightDistribution(generator);
+
+		//Grass only ever sits on the surface
+		spawnPosition.y = getSurfaceHeight(spawnPosition.x, spawnPosition.z);
+		if (spawn &&
+			spawnPosition.y >= Globals::SAND_MAX_HEIGHT && 
+			spawnPosition.y <= Globals::CHUNK_HEIGHT - Globals::MAX_TREE_HEIGHT - MAX_LEAVES_DISTANCE - 1 &&
+			isCubeAtLocalPosition(spawnPosition, eCubeType::Grass) &&
+			isCubeAtLocalPosition({ spawnPosition.x, spawnPosition.y + 1, spawnPosition.z }, eCubeType::Air))
 		{
-			spawnPosition.y = y;
-			if (isCubeAtLocalPosition(spawnPosition, eCubeType::Grass) &&
-				isCubeAtLocalPosition({ spawnPosition.x, spawnPosition.y + 1, spawnPosition.z }, eCubeType::Air))
-			{
-				int treeHeight = Globals::getRandomNumber(Globals::MIN_TREE_HEIGHT, Globals::MAX_TREE_HEIGHT);
-				spawnLeaves(spawnPosition, treeHeight);
-				spawnTreeStump(spawnPosition, treeHeight);
-				++spawnCount;
-				break;
-			}
+			m_trees[m_treeCount].position = m_startingPosition + spawnPosition;
+			m_trees[m_treeCount].height = treeHeight;
+			++m_treeCount;
 		}
+	}
+}
 
-		++attemptsCount;
+void Chunk::spawnTree(const TreePlacement& tree)
+{
+	if (tree.position.x + MAX_LEAVES_DISTANCE >= m_startingPosition.x &&
+		tree.position.x - MAX_LEAVES_DISTANCE < m_endingPosition.x &&
+		tree.position.z + MAX_LEAVES_DISTANCE >= m_startingPosition.z &&
+		tree.position.z - MAX_LEAVES_DISTANCE < m_endingPosition.z)
+	{
+		spawnLeaves(tree);
+		spawnTreeStump(tree);
 	}
 }
 
@@ -436,30 +551,27 @@ void Chunk::spawnCactus()
 		spawnPosition.x = Globals::getRandomNumber(0, Globals::CHUNK_WIDTH - 1);
 		spawnPosition.z = Globals::getRandomNumber(0, Globals::CHUNK_DEPTH - 1);
 
-		//Find Spawn Location
-		for (int y = Globals::CHUNK_HEIGHT - Globals::CACTUS_MAX_HEIGHT - 1; y >= 0; --y)
+		//Sand only ever sits on the surface
+		spawnPosition.y = getSurfaceHeight(spawnPosition.x, spawnPosition.z);
+		if (spawnPosition.y >= 0 && spawnPosition.y <= Globals::CHUNK_HEIGHT - Globals::CACTUS_MAX_HEIGHT - 1 &&
+			isCubeAtLocalPosition(spawnPosition, eCubeType::Sand) &&
+			isCubeAtLocalPosition({ spawnPosition.x, spawnPosition.y + 1, spawnPosition.z }, eCubeType::Air))
 		{
-			spawnPosition.y = y;
-			if (isCubeAtLocalPosition(spawnPosition, eCubeType::Sand) &&
-				isCubeAtLocalPosition({ spawnPosition.x, y + 1, spawnPosition.z }, eCubeType::Air))
+			//Spawn Cactus
+			int cactusHeight = Globals::getRandomNumber(Globals::CACTUS_MIN_HEIGHT, Globals::CACTUS_MAX_HEIGHT);
+			for (int i = 1; i <= cactusHeight; ++i)
 			{
-				//Spawn Cactus
-				int cactusHeight = Globals::getRandomNumber(Globals::CACTUS_MIN_HEIGHT, Globals::CACTUS_MAX_HEIGHT);
-				for (int i = 1; i <= cactusHeight; ++i)
+				if (i == cactusHeight)
 				{
-					if (i == cactusHeight)
-					{
-						changeCubeAtLocalPosition({ spawnPosition.x, spawnPosition.y + i, spawnPosition.z }, eCubeType::CactusTop);
-					}
-					else
-					{
-						changeCubeAtLocalPosition({ spawnPosition.x, spawnPosition.y + i, spawnPosition.z }, eCubeType::Cactus);
-					}
+					changeCubeAtLocalPosition({ spawnPosition.x, spawnPosition.y + i, spawnPosition.z }, eCubeType::CactusTop);
+				}
+				else
+				{
+					changeCubeAtLocalPosition({ spawnPosition.x, spawnPosition.y + i, spawnPosition.z }, eCubeType::Cactus);
 				}
-
-				++spawnCount;
-				break;
 			}
+
+			++spawnCount;
 		}
 
 		++attemptsCount;
@@ -476,30 +588,30 @@ void Chunk::spawnPlant(int maxQuantity, eCubeType baseCubeType, eCubeType plantC
 		spawnPosition.x = Globals::getRandomNumber(0, Globals::CHUNK_WIDTH - 1);
 		spawnPosition.z = Globals::getRandomNumber(0, Globals::CHUNK_DEPTH - 1);
 
-		for (int y = Globals::CHUNK_HEIGHT - 5; y >= Globals::WATER_MAX_HEIGHT; --y)
+		spawnPosition.y = getSurfaceHeight(spawnPosition.x, spawnPosition.z) + 1;
+		if (spawnPosition.y >= Globals::WATER_MAX_HEIGHT && spawnPosition.y <= Globals::CHUNK_HEIGHT - 5 &&
+			isCubeAtLocalPosition(spawnPosition, eCubeType::Air) &&
+			isCubeAtLocalPosition({ spawnPosition.x, spawnPosition.y - 1, spawnPosition.z }, baseCubeType))
 		{
-			spawnPosition.y = y;
-			if (isCubeAtLocalPosition(spawnPosition, eCubeType::Air) &&
-				isCubeAtLocalPosition({ spawnPosition.x, y - 1, spawnPosition.z }, baseCubeType))
-			{
-				changeCubeAtLocalPosition(spawnPosition, plantCubeType);
-				++spawnCount;
-			}
+			changeCubeAtLocalPosition(spawnPosition, plantCubeType);
+			++spawnCount;
 		}
 
 		++attemptsCount;
 	}
 }
 
-void Chunk::spawnLeaves(const glm::ivec3& startingPosition, int treeHeight)
+//Only the part of the tree inside this chunk is spawned
+void Chunk::spawnLeaves(const TreePlacement& tree)
 {
-	int y = startingPosition.y + treeHeight / 2; //Starting Height
+	glm::ivec3 startingPosition = convertToLocalPosition(tree.position, m_startingPosition);
+	int y = startingPosition.y + tree.height / 2; //Starting Height
 	for (int distance : LEAVES_DISTANCES)
 	{
 		++y;
-		for (int z = startingPosition.z - distance; z <= startingPosition.z + distance; ++z)
+		for (int z = std::max(startingPosition.z - distance, 0); z <= std::min(startingPosition.z + distance, Globals::CHUNK_DEPTH - 1); ++z)
 		{
-			for (int x = startingPosition.x - distance; x <= startingPosition.x + distance; ++x)
+			for (int x = std::max(startingPosition.x - distance, 0); x <= std::min(startingPosition.x + distance, Globals::CHUNK_WIDTH - 1); ++x)
 			{
 				glm::ivec3 position(x, y, z);
 				if (isCubeAtLocalPosition(position, eCubeType::Air))
@@ -511,11 +623,17 @@ void Chunk::spawnLeaves(const glm::ivec3& startingPosition, int treeHeight)
 	}
 }
 
-void Chunk::spawnTreeStump(const glm::ivec3& startingPosition, int treeHeight)
+void Chunk::spawnTreeStump(const TreePlacement& tree)
 {
-	for (int y = startingPosition.y; y <= startingPosition.y + treeHeight / 2; ++y)
+	glm::ivec3 startingPosition = convertToLocalPosition(tree.position, m_startingPosition);
+	if (!isPositionInLocalBounds(startingPosition))
+	{
+		return;
+	}
+
+	for (int y = startingPosition.y; y <= startingPosition.y + tree.height / 2; ++y)
 	{
-		if (y == startingPosition.y + treeHeight / 2)
+		if (y == startingPosition.y + tree.height / 2)
 		{
 			changeCubeAtLocalPosition({ startingPosition.x, y, startingPosition.z }, eCubeType::LogTop);
 		}
@@ -532,6 +650,12 @@ eCubeType Chunk::getCubeTypeByLocalPosition(const glm::ivec3& localPosition) con
 	return static_cast<eCubeType>(m_chunk[converTo1D(localPosition)]);
 }
 
+int Chunk::getSurfaceHeight(int localX, int localZ) const
+{
+	assert(isPositionInLocalBounds({ localX, 0, localZ }));
+	return m_surfaceHeights[localZ * Globals::CHUNK_WIDTH + localX];
+}
+
 bool Chunk::isPositionInLocalBounds(const glm::ivec3& position) const
 {
 	return (position.x >= 0 &&
@@ -546,77 +670,4 @@ bool Chunk::isCubeAtLocalPosition(const glm::ivec3& localPosition, eCubeType cub
 {
 	assert(isPositionInLocalBounds(localPosition));
 	return m_chunk[converTo1D(localPosition)] == static_cast<char>(cubeType);
-}
-
-int Chunk::getElevationAtPosition(int x, int z) const
-{
-	double ex = (x + SEED) / static_cast<float>(Globals::MAP_SIZE);
-	double ey = (z + SEED) / static_cast<float>(Globals::MAP_SIZE);
-
-	float elevation = 0.0f;
-
-	float persistence = Globals::TERRAIN_PERSISTENCE;
-	float lacunarity = Globals::TERRAIN_LACUNARITY;
-	for (int i = 0; i < Globals::TERRAIN_OCTAVES; ++i)
-	{
-		elevation += persistence * glm::perlin(glm::vec2((ex * 1.5f)* lacunarity, (ey * 1.5f) * lacunarity));
-
-		persistence /= 2.0f;
-		lacunarity *= 2.0f;
-	}
-	
-	persistence = Globals::TERRAIN_PERSISTENCE;
-	float total = 0.0f;
-	for (int i = 0; i < Globals::TERRAIN_OCTAVES; ++i)
-	{
-		total += persistence;
-		persistence /= 2.0f;
-	}
-
-	
-	elevation /= total;
-	elevation = (elevation + 1) / 2;
-	elevation = glm::pow(elevation, 3.0f);
-	elevation = elevation * (float)Globals::CHUNK_HEIGHT - 1;
-
-	return static_cast<int>(elevation);
-}
-
-//elevation = (elevation - -1) / (1 - -1) * (Utilities::CHUNK_HEIGHT - 1) + 1;
-
-eBiomeType Chunk::getBiomeType(int x, int z) const
-{
-	double bx = x / 1000.0f;
-	double by = z / 1000.0f;
-
-	float biomeType = 0.0f;
-	float moisturePersistence = Globals::BIOME_PERSISTENCE;
-	float moistureLacunarity = Globals::BIOME_LACUNARITY;
-	for (int i = 0; i < Globals::BIOME_OCTAVES; ++i)
-	{
-		biomeType += moisturePersistence * glm::perlin(glm::vec2(bx * moistureLacunarity, by * moistureLacunarity));
-
-		moisturePersistence /= 2.0f;
-		moistureLacunarity *= 2.0f;
-	}
-
-	float persistence = Globals::BIOME_PERSISTENCE;
-	float total = 0.0f;
-	for (int i = 0; i < Globals::BIOME_OCTAVES; ++i)
-	{
-		total += persistence;
-		persistence /= 2.0f;
-	}
-
-	biomeType /= total;
-	biomeType = (biomeType + 1) / 2;
-
-	if (biomeType >= 0.4f)
-	{
-		return eBiomeType::Plains;
-	}
-	else
-	{
-		return eBiomeType::Desert;
-	}
 }
\ No newline at end of file
@@ -5,16 +5,22 @@
 #include "Globals.h"
 #include "Rectangle.h"
 #include "NonCopyable.h"
+#include "TerrainNoise.h"
 #include <array>
 
-enum class eBiomeType
+//Placed from the terrain of the chunk the trunk stands in
+struct TreePlacement
 {
-	Plains = 0,
-	Desert
+	glm::ivec3 position;
+	int height;
 };
 
 //position.y * (CHUNK_AREA) + position.z * CHUNK_SIZE + position.x;
 struct NeighbouringChunks;
+class Chunk;
+//The chunks around a chunk, diagonals included
+constexpr size_t SURROUNDING_CHUNK_COUNT = 8;
+using SurroundingChunks = std::array<const Chunk*, SURROUNDING_CHUNK_COUNT>;
 class Chunk : private NonCopyable
 {
 public:
@@ -29,34 +35,48 @@ public:
 	bool isPositionInBounds(const glm::ivec3& position) const;
 	const glm::ivec3& getStartingPosition() const;
 	const glm::ivec3& getEndingPosition() const;
+	//No cube is ever above this height
+	int getMaxHeight() const;
 	char getCubeDetailsWithoutBoundsCheck(const glm::ivec3& position) const;
+	const char* getCubeRowWithoutBoundsCheck(int localY, int localZ) const;
 	bool isCubeAtPosition(const glm::ivec3& position) const;
 	bool isCubeAtPosition(const glm::ivec3& position, eCubeType cubeType) const;
 	bool isCubeAtLocalPosition(const glm::ivec3& localPosition) const;
+	eCubeType getCubeTypeByLocalPosition(const glm::ivec3& localPosition) const;
+	int getTreeCount() const;
+	const TreePlacement& getTree(int index) const;
 
 	bool addCubeAtPosition(const glm::ivec3& position, const NeighbouringChunks& neighbouringChunks, eCubeType cubeType);
 	bool destroyCubeAtPosition(const glm::ivec3& position, eCubeType& destroyedCubeType);
 	void reset();
-	void reuse(const glm::ivec3& startingPosition);
+	//Caves are only left out to measure what they cost
+	void reuse(const glm::ivec3& startingPosition, bool caves = true);
+	//Stamps in the trees of this chunk and its surrounding chunks that reach into it
+	void decorate(const SurroundingChunks& surroundingChunks);
 
 private:
 	glm::ivec3 m_startingPosition;
 	glm::ivec3 m_endingPosition;
 	std::array<char, Globals::CHUNK_VOLUME> m_chunk;
+	ChunkElevations m_surfaceHeights;
+	int m_maxHeight;
+	std::array<TreePlacement, Globals::MAX_TREE_SPAWN_ATTEMPTS> m_trees;
+	int m_treeCount;
 	Rectangle m_AABB;
 
 	bool isPositionInLocalBounds(const glm::ivec3& position) const;
 	bool isCubeAtLocalPosition(const glm::ivec3& localPosition, eCubeType cubeType) const;
-	int getElevationAtPosition(int x, int y) const;
-	eBiomeType getBiomeType(int x, int y) const;
 	
 	void changeCubeAtLocalPosition(const glm::ivec3& position, eCubeType cubeType);
-	void regen(const glm::ivec3& startingPosition);
-	void spawnWater();
-	void spawnTrees();
+	void fillRows(int localZ, int startY, int endY, eCubeType cubeType);
+	void fillColumn(int localX, int localZ, int startY, int endY, eCubeType cubeType);
+	void regen(const glm::ivec3& startingPosition, bool caves = true);
+	void spawnCaves();
+	void placeTrees();
+	void spawnTree(const TreePlacement& tree);
 	void spawnCactus();
 	void spawnPlant(int maxQuantity, eCubeType baseCubeType, eCubeType plantCubeType);
-	void spawnLeaves(const glm::ivec3& startingPosition, int treeHeight);
-	void spawnTreeStump(const glm::ivec3& startingPosition, int treeHeight);
-	eCubeType getCubeTypeByLocalPosition(const glm::ivec3& localPosition) const;
+	void spawnLeaves(const TreePlacement& tree);
+	void spawnTreeStump(const TreePlacement& tree);
+	int getSurfaceHeight(int localX, int localZ) const;
 };
\ No newline at end of file
@@ -9,43 +9,146 @@
 #include "MeshGenerator.h"
 #include "BoundingBox.h"
 #include "NeighbouringChunks.h"
+#include "SlabAllocator.h"
+#include "Profiler.h"
+#include "Metrics.h"
 #include <deque>
+#include <limits>
 
 namespace
 {
 	constexpr int THREAD_TRANSFER_PER_FRAME = 8;
+	constexpr int CHUNK_DECORATION_DEPENDENCY_COUNT = static_cast<int>(SURROUNDING_CHUNK_COUNT) + 1;
+	constexpr int CHUNK_MESH_DEPENDENCY_COUNT = 5;
+	constexpr size_t CHUNKS_PER_SLAB = 8;
+	//Edge chunks are meshed once their neighbours are decorated, which needs the chunks surrounding those neighbours
+	//So terrain is kept two chunks past the visibility distance for every chunk within it to be meshed
+	constexpr int CHUNK_DEPENDENCY_MARGIN = Globals::CHUNK_WIDTH * 2;
+	//Chunks out of view are only evicted for missing chunks when they are this much farther away
+	constexpr float EVICTION_SQR_DISTANCE_RATIO = 2.25f;
 
-	int getMaxChunksSize()
+	constexpr std::array<eDirection, static_cast<size_t>(eDirection::Max) + 1> NEIGHBOURING_CHUNK_DIRECTIONS =
 	{
-		int x = 2 * Globals::VISIBILITY_DISTANCE / Globals::CHUNK_WIDTH + 1;
-		int z = 2 * Globals::VISIBILITY_DISTANCE / Globals::CHUNK_DEPTH + 1;
+		eDirection::Left,
+		eDirection::Right,
+		eDirection::Forward,
+		eDirection::Back
+	};
+
+	//Meshes only change level of detail once they are this far into another ring
+	constexpr float CHUNK_MESH_LOD_HYSTERESIS = Globals::CHUNK_WIDTH / 2.0f;
+
+	constexpr float AUTO_VISIBILITY_DISTANCE_SMOOTHING = 0.05f;
+	constexpr float AUTO_VISIBILITY_DISTANCE_INTERVAL = 1.0f;
+	constexpr float AUTO_VISIBILITY_DISTANCE_DECREASE_THRESHOLD = 1.15f;
+	constexpr float AUTO_VISIBILITY_DISTANCE_INCREASE_THRESHOLD = 0.8f;
+
+	int getMaxChunksSize(int visibilityDistance)
+	{
+		int x = 2 * visibilityDistance / Globals::CHUNK_WIDTH + 1;
+		int z = 2 * visibilityDistance / Globals::CHUNK_DEPTH + 1;
 
 		return x * z;
 	}
 
+	int getLoadedDistance(int visibilityDistance)
+	{
+		return visibilityDistance + CHUNK_DEPENDENCY_MARGIN;
+	}
+
+	size_t getChunkMemoryUsage(int visibilityDistance)
+	{
+		return static_cast<size_t>(getMaxChunksSize(getLoadedDistance(visibilityDistance))) * sizeof(Chunk) +
+			static_cast<size_t>(getMaxChunksSize(visibilityDistance)) * sizeof(VertexArray);
+	}
+
+	int clampVisibilityDistance(int visibilityDistance)
+	{
+		visibilityDistance -= visibilityDistance % Globals::CHUNK_WIDTH;
+		return glm::clamp(visibilityDistance, Globals::MIN_VISIBILITY_DISTANCE, Globals::MAX_VISIBILITY_DISTANCE);
+	}
+
+	float getChunkMeshDistance(const glm::ivec3& chunkStartingPosition, const glm::vec3& playerPosition)
+	{
+		return glm::length(glm::vec2(chunkStartingPosition.x + Globals::CHUNK_WIDTH / 2.0f - playerPosition.x,
+			chunkStartingPosition.z + Globals::CHUNK_DEPTH / 2.0f - playerPosition.z));
+	}
+
+	eChunkMeshLOD getChunkMeshLOD(float chunkMeshDistance)
+	{
+		int ring = static_cast<int>(std::max(chunkMeshDistance, 0.0f)) / Globals::CHUNK_MESH_LOD_DISTANCE;
+		return static_cast<eChunkMeshLOD>(std::min(ring, static_cast<int>(eChunkMeshLOD::Max)));
+	}
+
+	static_assert((Globals::CHUNK_WIDTH & (Globals::CHUNK_WIDTH - 1)) == 0 && (Globals::CHUNK_DEPTH & (Globals::CHUNK_DEPTH - 1)) == 0,
+		"Chunk positions are found by masking");
+
 	glm::ivec3 getClosestChunkStartingPosition(const glm::ivec3& position)
 	{
-		glm::ivec3 closestChunkStartingPosition = position;
-		if (position.x % Globals::CHUNK_WIDTH < 0)
-		{
-			closestChunkStartingPosition.x += std::abs(position.x % Globals::CHUNK_WIDTH);
-			closestChunkStartingPosition.x -= Globals::CHUNK_WIDTH;
-		}
-		else if (position.x % Globals::CHUNK_WIDTH > 0)
-		{
-			closestChunkStartingPosition.x -= std::abs(position.x % Globals::CHUNK_WIDTH);
-		}
-		if (position.z % Globals::CHUNK_DEPTH < 0)
-		{
-			closestChunkStartingPosition.z += std::abs(position.z % Globals::CHUNK_DEPTH);
-			closestChunkStartingPosition.z -= Globals::CHUNK_DEPTH;
-		}
-		else if (position.z % Globals::CHUNK_DEPTH > 0)
-		{
-			closestChunkStartingPosition.z -= std::abs(position.z % Globals::CHUNK_DEPTH);
-		}
+		return { position.x & ~(Globals::CHUNK_WIDTH - 1), 0, position.z & ~(Globals::CHUNK_DEPTH - 1) };
+	}
+
+	glm::ivec3 getLocalPosition(const glm::ivec3& position)
+	{
+		return { position.x & (Globals::CHUNK_WIDTH - 1), position.y, position.z & (Globals::CHUNK_DEPTH - 1) };
+	}
+
+	//Shared by every chunk manager - a new one is made on each reset
+	struct ChunkManagerMetrics : private NonCopyable, private NonMovable
+	{
+		ChunkManagerMetrics()
+			: chunksToDecorateQueue(Metrics::getGauge("Chunks to decorate queue")),
+			chunkMeshesToGenerateQueue(Metrics::getGauge("Chunk meshes to generate queue")),
+			deletionQueue(Metrics::getGauge("Chunk deletion queue")),
+			generatedChunkQueue(Metrics::getGauge("Generated chunk queue")),
+			generatedChunkMeshQueue(Metrics::getGauge("Generated chunk mesh queue")),
+			chunkMeshRegenerationQueue(Metrics::getGauge("Chunk mesh regeneration queue")),
+			chunks(Metrics::getGauge("Chunks")),
+			chunkMeshes(Metrics::getGauge("Chunk meshes")),
+			chunkPoolCapacity(Metrics::getGauge("Chunk pool capacity")),
+			chunkPoolFree(Metrics::getGauge("Chunk pool free")),
+			chunkPoolHighWaterMark(Metrics::getGauge("Chunk pool high water mark")),
+			chunkMeshPoolCapacity(Metrics::getGauge("Chunk mesh pool capacity")),
+			chunkMeshPoolFree(Metrics::getGauge("Chunk mesh pool free")),
+			chunkMeshPoolHighWaterMark(Metrics::getGauge("Chunk mesh pool high water mark")),
+			chunksAdded(Metrics::getCounter("Chunks added")),
+			chunksDeleted(Metrics::getCounter("Chunks deleted")),
+			chunkPoolExhausted(Metrics::getCounter("Chunk pool exhausted")),
+			updateTime(Metrics::getHistogram("Chunk update time (us)"))
+		{}
+
+		MetricGauge& chunksToDecorateQueue;
+		MetricGauge& chunkMeshesToGenerateQueue;
+		MetricGauge& deletionQueue;
+		MetricGauge& generatedChunkQueue;
+		MetricGauge& generatedChunkMeshQueue;
+		MetricGauge& chunkMeshRegenerationQueue;
+		MetricGauge& chunks;
+		MetricGauge& chunkMeshes;
+		MetricGauge& chunkPoolCapacity;
+		MetricGauge& chunkPoolFree;
+		MetricGauge& chunkPoolHighWaterMark;
+		MetricGauge& chunkMeshPoolCapacity;
+		MetricGauge& chunkMeshPoolFree;
+		MetricGauge& chunkMeshPoolHighWaterMark;
+		MetricCounter& chunksAdded;
+		MetricCounter& chunksDeleted;
+		MetricCounter& chunkPoolExhausted;
+		MetricHistogram& updateTime;
+	};
 
-		return { closestChunkStartingPosition.x, 0, closestChunkStartingPosition.z };
+	ChunkManagerMetrics& getMetrics()
+	{
+		static ChunkManagerMetrics metrics;
+		return metrics;
+	}
+
+	void publishObjectPoolStats(const ObjectPoolStats& stats, MetricGauge& capacity, MetricGauge& free, MetricGauge& highWaterMark)
+	{
+		capacity.set(static_cast<int64_t>(stats.capacity));
+		//Goes below zero while objects past a reduced capacity are still in use
+		free.set(static_cast<int64_t>(stats.capacity) - static_cast<int64_t>(stats.occupancy));
+		highWaterMark.set(static_cast<int64_t>(stats.highWaterMark));
 	}
 }
 
@@ -55,30 +158,70 @@ ChunkToAdd::ChunkToAdd(float distanceFromCamera, const glm::ivec3& startingPosit
 	startingPosition(startingPosition)
 {}
 
+//ChunkGenerationState
+ChunkGenerationState::ChunkGenerationState(int terrainDependencies, int decoratedDependencies)
+	: state(eChunkState::Queued),
+	terrainDependencies(terrainDependencies),
+	decoratedDependencies(decoratedDependencies),
+	meshLOD(eChunkMeshLOD::Full),
+	meshEditGeneration(0)
+{}
+
 //ChunkManager
-ChunkManager::ChunkManager()
-	: m_chunkPool(getMaxChunksSize()),
-	m_chunkMeshPool(getMaxChunksSize()),
+ChunkManager::ChunkManager(int visibilityDistance, size_t memoryBudget)
+	: m_targetVisibilityDistance(clampVisibilityDistance(visibilityDistance)),
+	m_visibilityDistance(m_targetVisibilityDistance),
+	m_residencyManager(memoryBudget),
+	m_nearestMissingChunkDistance(-1.0f),
+	m_chunksToEvict(),
+	m_chunkPool(getMaxChunksSize(getLoadedDistance(m_visibilityDistance)), getMaxChunksSize(getLoadedDistance(Globals::MAX_VISIBILITY_DISTANCE)),
+		std::make_unique<SlabAllocator<Chunk, CHUNKS_PER_SLAB>>(eMemoryCategory::Voxels)),
+	m_chunkMeshPool(getMaxChunksSize(m_visibilityDistance), getMaxChunksSize(Globals::MAX_VISIBILITY_DISTANCE)),
 	m_chunks(),
 	m_chunkMeshes(),
+	m_chunkGenerationStates(),
 	m_chunksToAdd(),
+	m_chunksToDecorateQueue(),
 	m_chunkMeshesToGenerateQueue(),
 	m_deletionQueue(),
 	m_generatedChunkMeshQueue(),
 	m_generatedChunkQueue(),
-	m_chunkMeshRegenerationQueue()
+	m_chunkMeshRegenerationQueue(),
+	m_chunkEditGeneration(0),
+	m_chunkEditGenerations(),
+	m_chunkMeshEditGeneration(0)
 {
-	m_chunksToAdd.reserve(getMaxChunksSize());
+	m_chunksToAdd.reserve(getMaxChunksSize(getLoadedDistance(Globals::MAX_VISIBILITY_DISTANCE)));
 	addChunks(Globals::PLAYER_STARTING_POSITION);
 }
 
+int ChunkManager::getVisibilityDistance() const
+{
+	return m_targetVisibilityDistance;
+}
+
+void ChunkManager::setVisibilityDistance(int visibilityDistance)
+{
+	m_targetVisibilityDistance = clampVisibilityDistance(visibilityDistance);
+}
+
+size_t ChunkManager::getMemoryBudget() const
+{
+	return m_residencyManager.getMemoryBudget();
+}
+
+MemoryUsage ChunkManager::getMemoryUsage() const
+{
+	return MemoryAccounting::getUsage();
+}
+
 bool ChunkManager::getHighestCubeAtPosition(const glm::vec3& playerPosition, glm::vec3& position) const
 {
 	glm::ivec3 closestChunkStartingPosition = getClosestChunkStartingPosition(playerPosition);
 	auto chunk = m_chunks.find(closestChunkStartingPosition);
 	if (chunk != m_chunks.cend())
 	{
-		position = chunk->second.object.get().getHighestCubeAtPosition(playerPosition);
+		position = chunk->second.get().getHighestCubeAtPosition(playerPosition);
 		return true;
 	}
 
@@ -87,35 +230,128 @@ bool ChunkManager::getHighestCubeAtPosition(const glm::vec3& playerPosition, glm
 
 bool ChunkManager::isCubeAtPosition(const glm::vec3& playerPosition) const
 {
-	glm::ivec3 closestChunkStartingPosition = getClosestChunkStartingPosition(playerPosition);
+	return VoxelAccessor(*this).getCubeType(playerPosition) != eCubeType::Air;
+}
+
+bool ChunkManager::isCubeAtPosition(const glm::vec3& playerPosition, eCubeType& cubeType) const
+{
+	return VoxelAccessor(*this).isCubeAtPosition(playerPosition, cubeType);
+}
+
+bool ChunkManager::isChunkAtPosition(const glm::vec3& position) const
+{
+	glm::ivec3 closestChunkStartingPosition = getClosestChunkStartingPosition(position);
 	auto chunk = m_chunks.find(closestChunkStartingPosition);
-	if (chunk != m_chunks.cend())
+	
+	return chunk != m_chunks.cend();
+}
+
+bool ChunkManager::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+	const std::function<bool(eCubeType)>& filter, VoxelRaycastHit& hit) const
+{
+	assert(direction != glm::vec3());
+	glm::vec3 rayDirection = glm::normalize(direction);
+	glm::ivec3 position(std::floor(origin.x), std::floor(origin.y), std::floor(origin.z));
+	glm::ivec3 step(0);
+	//Distance along the ray to the next cell boundary on each axis - and between boundaries
+	glm::vec3 distanceToBoundary(std::numeric_limits<float>::infinity());
+	glm::vec3 distanceBetweenBoundaries(std::numeric_limits<float>::infinity());
+	for (int axis = 0; axis < 3; ++axis)
 	{
-		return chunk->second.object.get().isCubeAtPosition(playerPosition);
+		if (rayDirection[axis] > 0.0f)
+		{
+			step[axis] = 1;
+			distanceBetweenBoundaries[axis] = 1.0f / rayDirection[axis];
+			distanceToBoundary[axis] = (position[axis] + 1 - origin[axis]) * distanceBetweenBoundaries[axis];
+		}
+		else if (rayDirection[axis] < 0.0f)
+		{
+			step[axis] = -1;
+			distanceBetweenBoundaries[axis] = -1.0f / rayDirection[axis];
+			distanceToBoundary[axis] = (origin[axis] - position[axis]) * distanceBetweenBoundaries[axis];
+		}
+	}
+
+	VoxelAccessor voxelAccessor(*this);
+	glm::ivec3 previousPosition = position;
+	glm::ivec3 normal(0);
+	float distance = 0.0f;
+	bool nonAirCubeFound = false;
+	hit.placementFound = false;
+	while (distance <= maxDistance)
+	{
+		eCubeType cubeType = voxelAccessor.getCubeType(position);
+		if (cubeType != eCubeType::Air)
+		{
+			if (!nonAirCubeFound)
+			{
+				nonAirCubeFound = true;
+				hit.placementPosition = previousPosition;
+				hit.placementFound = previousPosition != position;
+			}
+
+			if (filter(cubeType))
+			{
+				hit.position = position;
+				hit.normal = normal;
+				hit.cubeType = cubeType;
+				hit.distance = distance;
+				return true;
+			}
+		}
+
+		int axis = 0;
+		if (distanceToBoundary.y < distanceToBoundary[axis])
+		{
+			axis = 1;
+		}
+		if (distanceToBoundary.z < distanceToBoundary[axis])
+		{
+			axis = 2;
+		}
+
+		previousPosition = position;
+		position[axis] += step[axis];
+		normal = glm::ivec3(0);
+		normal[axis] = -step[axis];
+		distance = distanceToBoundary[axis];
+		distanceToBoundary[axis] += distanceBetweenBoundaries[axis];
 	}
 
 	return false;
 }
 
-bool ChunkManager::isCubeAtPosition(const glm::vec3& playerPosition, eCubeType& cubeType) const
+void ChunkManager::getCollidableCubes(const glm::ivec3& minimumPosition, const glm::ivec3& maximumPosition, 
+	std::vector<glm::ivec3>& collidableCubes) const
 {
-	glm::ivec3 closestChunkStartingPosition = getClosestChunkStartingPosition(playerPosition);
-	auto chunk = m_chunks.find(closestChunkStartingPosition);
-  	if (chunk != m_chunks.cend() && chunk->second.object.get().isCubeAtPosition(playerPosition))
+	int minimumY = std::max(minimumPosition.y, 0);
+	int maximumY = std::min(maximumPosition.y, Globals::CHUNK_HEIGHT - 1);
+	VoxelAccessor voxelAccessor(*this);
+	for (int x = minimumPosition.x; x <= maximumPosition.x; ++x)
 	{
-		cubeType = static_cast<eCubeType>(chunk->second.object.get().getCubeDetailsWithoutBoundsCheck(playerPosition));
-		return true;
+		for (int z = minimumPosition.z; z <= maximumPosition.z; ++z)
+		{
+			for (int y = minimumY; y <= maximumY; ++y)
+			{
+				if (getCubeTypeProperties(voxelAccessor.getCubeType({ x, y, z })).collidable)
+				{
+					collidableCubes.emplace_back(x, y, z);
+				}
+			}
+		}
 	}
-
-	return false;
 }
 
-bool ChunkManager::isChunkAtPosition(const glm::vec3& position) const
+void ChunkManager::getCubeTypes(const std::vector<glm::ivec3>& positions, std::vector<eCubeType>& cubeTypes, 
+	InstrumentedMutex& chunkInteractionMutex) const
 {
-	glm::ivec3 closestChunkStartingPosition = getClosestChunkStartingPosition(position);
-	auto chunk = m_chunks.find(closestChunkStartingPosition);
-	
-	return chunk != m_chunks.cend();
+	cubeTypes.resize(positions.size());
+	InstrumentedLock chunkInteractionLock(chunkInteractionMutex, LOCK_SITE("ChunkManager::getCubeTypes"));
+	VoxelAccessor voxelAccessor(*this);
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		cubeTypes[i] = voxelAccessor.getCubeType(positions[i]);
+	}
 }
 
 bool ChunkManager::placeCubeAtPosition(const glm::ivec3& placementPosition, eCubeType cubeTypeToPlace)
@@ -127,12 +363,13 @@ bool ChunkManager::placeCubeAtPosition(const glm::ivec3& placementPosition, eCub
 		return false;
 	}
 
-	if (chunk->second.object.get().addCubeAtPosition(placementPosition, getAllNeighbouringChunks(m_chunks, chunkStartingPosition), cubeTypeToPlace))
+	if (chunk->second.get().addCubeAtPosition(placementPosition, getAllNeighbouringChunks(m_chunks, chunkStartingPosition), cubeTypeToPlace))
 	{
+		onCubeEdited(placementPosition);
 		auto chunkMesh = m_chunkMeshes.find(chunkStartingPosition);
 		if (chunkMesh != m_chunkMeshes.cend() &&  !m_chunkMeshRegenerationQueue.contains(chunkStartingPosition))
 		{
-			m_chunkMeshRegenerationQueue.add({ chunkStartingPosition, chunkMesh->second.object });
+			m_chunkMeshRegenerationQueue.add({ chunkStartingPosition, chunkMesh->second.get() });
 		}
 
 		//Left Chunk
@@ -142,7 +379,7 @@ bool ChunkManager::placeCubeAtPosition(const glm::ivec3& placementPosition, eCub
 			auto leftChunkMesh = m_chunkMeshes.find(leftChunkStartingPosition);
 			if (leftChunkMesh != m_chunkMeshes.cend())
 			{
-				m_chunkMeshRegenerationQueue.add({ leftChunkStartingPosition, leftChunkMesh->second.object });
+				m_chunkMeshRegenerationQueue.add({ leftChunkStartingPosition, leftChunkMesh->second.get() });
 			}
 		}
 
@@ -153,7 +390,7 @@ bool ChunkManager::placeCubeAtPosition(const glm::ivec3& placementPosition, eCub
 			auto rightChunkMesh = m_chunkMeshes.find(rightChunkStartingPosition);
 			if (rightChunkMesh != m_chunkMeshes.cend())
 			{
-				m_chunkMeshRegenerationQueue.add({ rightChunkStartingPosition, rightChunkMesh->second.object });
+				m_chunkMeshRegenerationQueue.add({ rightChunkStartingPosition, rightChunkMesh->second.get() });
 			}
 		}
 
@@ -164,7 +401,7 @@ bool ChunkManager::placeCubeAtPosition(const glm::ivec3& placementPosition, eCub
 			auto forwardChunkMesh = m_chunkMeshes.find(forwardChunkStartingPosition);
 			if (forwardChunkMesh != m_chunkMeshes.cend())
 			{
-				m_chunkMeshRegenerationQueue.add({ forwardChunkStartingPosition, forwardChunkMesh->second.object });
+				m_chunkMeshRegenerationQueue.add({ forwardChunkStartingPosition, forwardChunkMesh->second.get() });
 			}
 		}
 
@@ -175,7 +412,7 @@ bool ChunkManager::placeCubeAtPosition(const glm::ivec3& placementPosition, eCub
 			auto backChunkMesh = m_chunkMeshes.find(backChunkStartingPosition);
 			if (backChunkMesh != m_chunkMeshes.cend())
 			{
-				m_chunkMeshRegenerationQueue.add({ backChunkStartingPosition, backChunkMesh->second.object });
+				m_chunkMeshRegenerationQueue.add({ backChunkStartingPosition, backChunkMesh->second.get() });
 			}
 		}
 
@@ -194,12 +431,13 @@ bool ChunkManager::destroyCubeAtPosition(const glm::ivec3& blockToDestroy, eCube
 		return false;
 	}
 	
-	if (chunk->second.object.get().destroyCubeAtPosition(blockToDestroy, destroyedCubeType))
+	if (chunk->second.get().destroyCubeAtPosition(blockToDestroy, destroyedCubeType))
 	{
+		onCubeEdited(blockToDestroy);
 		auto chunkMesh = m_chunkMeshes.find(chunkStartingPosition);
-		if (!m_chunkMeshRegenerationQueue.contains(chunkStartingPosition))
+		if (chunkMesh != m_chunkMeshes.cend() && !m_chunkMeshRegenerationQueue.contains(chunkStartingPosition))
 		{
-			m_chunkMeshRegenerationQueue.add({ chunkStartingPosition, chunkMesh->second.object });
+			m_chunkMeshRegenerationQueue.add({ chunkStartingPosition, chunkMesh->second.get() });
 		}
 
 		//Left Chunk
@@ -209,7 +447,7 @@ bool ChunkManager::destroyCubeAtPosition(const glm::ivec3& blockToDestroy, eCube
 			auto leftChunkMesh = m_chunkMeshes.find(leftChunkStartingPosition);
 			if (leftChunkMesh != m_chunkMeshes.cend())
 			{
-				m_chunkMeshRegenerationQueue.add({ leftChunkStartingPosition, leftChunkMesh->second.object });
+				m_chunkMeshRegenerationQueue.add({ leftChunkStartingPosition, leftChunkMesh->second.get() });
 			}
 		}
 		
@@ -220,7 +458,7 @@ bool ChunkManager::destroyCubeAtPosition(const glm::ivec3& blockToDestroy, eCube
 			auto rightChunkMesh = m_chunkMeshes.find(rightChunkStartingPosition);
 			if (rightChunkMesh != m_chunkMeshes.cend())
 			{
-				m_chunkMeshRegenerationQueue.add({ rightChunkStartingPosition, rightChunkMesh->second.object });
+				m_chunkMeshRegenerationQueue.add({ rightChunkStartingPosition, rightChunkMesh->second.get() });
 			}
 		}
 		
@@ -231,7 +469,7 @@ bool ChunkManager::destroyCubeAtPosition(const glm::ivec3& blockToDestroy, eCube
 			auto forwardChunkMesh = m_chunkMeshes.find(forwardChunkStartingPosition);
 			if (forwardChunkMesh != m_chunkMeshes.cend())
 			{
-				m_chunkMeshRegenerationQueue.add({ forwardChunkStartingPosition, forwardChunkMesh->second.object });
+				m_chunkMeshRegenerationQueue.add({ forwardChunkStartingPosition, forwardChunkMesh->second.get() });
 			}
 		}
 		
@@ -242,7 +480,7 @@ bool ChunkManager::destroyCubeAtPosition(const glm::ivec3& blockToDestroy, eCube
 			auto backChunkMesh = m_chunkMeshes.find(backChunkStartingPosition);
 			if (backChunkMesh != m_chunkMeshes.cend())
 			{
-				m_chunkMeshRegenerationQueue.add({ backChunkStartingPosition, backChunkMesh->second.object });
+				m_chunkMeshRegenerationQueue.add({ backChunkStartingPosition, backChunkMesh->second.get() });
 			}
 		}
 		
@@ -253,24 +491,38 @@ bool ChunkManager::destroyCubeAtPosition(const glm::ivec3& blockToDestroy, eCube
 }
 
 void ChunkManager::update(const Player& player, const sf::Window& window, std::atomic<bool>& resetGame,
-	std::mutex& chunkInteractionMutex, std::mutex& renderingMutex)	
+	InstrumentedMutex& chunkInteractionMutex, InstrumentedMutex& renderingMutex)	
 {
+	PROFILE_THREAD_NAME("Chunk generation");
 	while (!resetGame && window.isOpen())
 	{
-		std::unique_lock<std::mutex> playerLock(chunkInteractionMutex);
-		glm::vec3 playerPosition = player.getPosition();
-		playerLock.unlock();
+		PROFILE_SCOPE("ChunkManager::update");
+		ScopedMetricTimer updateTimer(getMetrics().updateTime);
+		glm::vec3 playerPosition;
+		glm::vec3 cameraFront;
+		{
+			InstrumentedLock playerLock(chunkInteractionMutex, LOCK_SITE("ChunkManager::update player"));
+			playerPosition = player.getPosition();
+			cameraFront = player.getCamera().front;
+			m_chunkMeshEditGeneration = m_chunkEditGeneration;
+		}
 
-		glm::ivec3 startingPosition = Globals::getClosestMiddlePosition(playerPosition);
-		Rectangle visibilityRect(glm::vec2(startingPosition.x, startingPosition.z), Globals::VISIBILITY_DISTANCE);
+		applyVisibilityDistance();
+		applyMemoryBudget(playerPosition, cameraFront);
+		Rectangle visibilityRect = Globals::getVisibilityRect(playerPosition, m_visibilityDistance);
+		Rectangle loadedRect = Globals::getVisibilityRect(playerPosition, getLoadedDistance(m_visibilityDistance));
 
-		clearQueues(playerPosition, visibilityRect);
-		deleteChunks(playerPosition, visibilityRect);
+		clearQueues(playerPosition, visibilityRect, loadedRect);
+		deleteChunks(playerPosition, loadedRect);
 		addChunks(playerPosition);
-		handleChunkMeshesToGenerateQueue();
+		handleChunkMeshesToGenerateQueue(playerPosition);
+		updateChunkMeshLODs(playerPosition);
 
-		playerLock.lock();
-		std::lock_guard<std::mutex> renderingLock(renderingMutex); 
+		//Decorating writes voxels the player reads but nothing that is rendered
+		InstrumentedLock chunkInteractionLock(chunkInteractionMutex, LOCK_SITE("ChunkManager::update transfer"));
+		handleChunksToDecorateQueue();
+		InstrumentedLock renderingLock(renderingMutex, LOCK_SITE("ChunkManager::update render"));
+		deleteChunkMeshes(visibilityRect);
 		handleChunkMeshRegenerationQueue();
 		for (int i = 0; i < THREAD_TRANSFER_PER_FRAME; ++i)
 		{
@@ -287,84 +539,192 @@ void ChunkManager::update(const Player& player, const sf::Window& window, std::a
 				if (chunk != m_chunks.end())
 				{
 					m_chunks.erase(chunk);
+					onChunkUnavailable(chunkStartingPosition);
 				}
 
 				m_deletionQueue.pop();
+				getMetrics().chunksDeleted.add();
 			}
 
 			handleGeneratedChunkQueue();
 			handleGeneratedChunkMeshQueue();
 		}
+
+		updateMetrics();
 	}
 }
 
 void ChunkManager::renderOpaque(const Frustum& frustum) const
 {
+	PROFILE_SCOPE("ChunkManager::renderOpaque");
+	int64_t drawCalls = 0;
+	int64_t indices = 0;
 	for (const auto& chunkMesh : m_chunkMeshes)
 	{
-		if (chunkMesh.second.object.get().m_opaqueVertexBuffer.bindToVAO)
+		if (chunkMesh.second.get().m_opaqueVertexBuffer.bindToVAO)
 		{
-			chunkMesh.second.object.get().attachOpaqueVBO();
+			chunkMesh.second.get().attachOpaqueVBO();
 		}
 
-		if (chunkMesh.second.object.get().m_opaqueVertexBuffer.displayable &&
+		if (chunkMesh.second.get().m_opaqueVertexBuffer.displayable &&
 			frustum.isChunkInFustrum(chunkMesh.first))
 		{
-			chunkMesh.second.object.get().bindOpaqueVAO();
-			glDrawElements(GL_TRIANGLES, chunkMesh.second.object.get().m_opaqueVertexBuffer.indicies.size(), GL_UNSIGNED_INT, nullptr);
+			chunkMesh.second.get().bindOpaqueVAO();
+			glDrawElements(GL_TRIANGLES, chunkMesh.second.get().m_opaqueVertexBuffer.indicies.size(), GL_UNSIGNED_INT, nullptr);
+			++drawCalls;
+			indices += static_cast<int64_t>(chunkMesh.second.get().m_opaqueVertexBuffer.indicies.size());
 		}
 	}
+
+	Metrics::addFrameDraws(drawCalls, indices);
 }
 
 void ChunkManager::renderTransparent(const Frustum& frustum) const
 {
+	PROFILE_SCOPE("ChunkManager::renderTransparent");
+	int64_t drawCalls = 0;
+	int64_t indices = 0;
 	for (const auto& chunkMesh : m_chunkMeshes)
 	{
-		if (chunkMesh.second.object.get().m_transparentVertexBuffer.bindToVAO)
+		if (chunkMesh.second.get().m_transparentVertexBuffer.bindToVAO)
 		{
-			chunkMesh.second.object.get().attachTransparentVBO();
+			chunkMesh.second.get().attachTransparentVBO();
 		}
 
-		if (chunkMesh.second.object.get().m_transparentVertexBuffer.displayable && 
+		if (chunkMesh.second.get().m_transparentVertexBuffer.displayable && 
 			frustum.isChunkInFustrum(chunkMesh.first))
 		{
-			chunkMesh.second.object.get().bindTransparentVAO();
-			glDrawElements(GL_TRIANGLES, chunkMesh.second.object.get().m_transparentVertexBuffer.indicies.size(), GL_UNSIGNED_INT, nullptr);
+			chunkMesh.second.get().bindTransparentVAO();
+			glDrawElements(GL_TRIANGLES, chunkMesh.second.get().m_transparentVertexBuffer.indicies.size(), GL_UNSIGNED_INT, nullptr);
+			++drawCalls;
+			indices += static_cast<int64_t>(chunkMesh.second.get().m_transparentVertexBuffer.indicies.size());
 		}
 	}
+
+	Metrics::addFrameDraws(drawCalls, indices);
+}
+
+void ChunkManager::destroyRetiredChunkMeshes()
+{
+	m_chunkMeshPool.destroyRetiredObjects();
 }
 
-void ChunkManager::deleteChunks(const glm::ivec3& playerPosition, const Rectangle& visibilityRect)
+void ChunkManager::applyVisibilityDistance()
 {
+	PROFILE_SCOPE("ChunkManager::applyVisibilityDistance");
+	int visibilityDistance = m_targetVisibilityDistance;
+	if (visibilityDistance != m_visibilityDistance)
+	{
+		m_visibilityDistance = visibilityDistance;
+		m_chunkMeshPool.resize(getMaxChunksSize(m_visibilityDistance));
+	}
+}
+
+void ChunkManager::applyMemoryBudget(const glm::vec3& playerPosition, const glm::vec3& cameraFront)
+{
+	PROFILE_SCOPE("ChunkManager::applyMemoryBudget");
+	m_residencyManager.setViewPoint(playerPosition, cameraFront);
+
+	//Held back to whole slabs so small changes in mesh memory don't resize the pool every update
+	size_t maxChunks = getMaxChunksSize(getLoadedDistance(m_visibilityDistance));
+	size_t chunkLimit = m_residencyManager.getResidentChunkLimit();
+	chunkLimit = chunkLimit >= maxChunks ? maxChunks : chunkLimit / CHUNKS_PER_SLAB * CHUNKS_PER_SLAB;
+	ObjectPoolStats chunkPoolStats = m_chunkPool.getStats();
+	if (chunkLimit != chunkPoolStats.capacity && 
+		(chunkLimit < chunkPoolStats.capacity || chunkLimit >= chunkPoolStats.capacity + CHUNKS_PER_SLAB || chunkLimit == maxChunks))
+	{
+		m_chunkPool.resize(chunkLimit);
+		chunkPoolStats.capacity = chunkLimit;
+	}
+
+	assert(m_chunksToEvict.empty());
+	size_t pendingDeletions = m_deletionQueue.size();
+	if (chunkPoolStats.occupancy > chunkPoolStats.capacity + pendingDeletions)
+	{
+		m_residencyManager.getChunksToEvict(m_chunks, m_deletionQueue, chunkPoolStats.occupancy - chunkPoolStats.capacity - pendingDeletions,
+			0.0f, true, m_chunksToEvict);
+	}
+	else if (chunkPoolStats.capacity < maxChunks && m_nearestMissingChunkDistance >= 0.0f &&
+		pendingDeletions < static_cast<size_t>(THREAD_TRANSFER_PER_FRAME))
+	{
+		m_residencyManager.getChunksToEvict(m_chunks, m_deletionQueue, static_cast<size_t>(THREAD_TRANSFER_PER_FRAME) - pendingDeletions,
+			m_nearestMissingChunkDistance * EVICTION_SQR_DISTANCE_RATIO, false, m_chunksToEvict);
+	}
+
+	for (const auto& chunkStartingPosition : m_chunksToEvict)
+	{
+		m_deletionQueue.add({ chunkStartingPosition });
+	}
+	m_chunksToEvict.clear();
+
+	m_chunkPool.destroyRetiredObjects();
+}
+
+void ChunkManager::deleteChunks(const glm::ivec3& playerPosition, const Rectangle& loadedRect)
+{
+	PROFILE_SCOPE("ChunkManager::deleteChunks");
 	for (auto chunk = m_chunks.begin(); chunk != m_chunks.end(); ++chunk)
 	{
-		const glm::ivec3& chunkStartingPosition = chunk->second.object.get().getStartingPosition();
+		const glm::ivec3& chunkStartingPosition = chunk->second.get().getStartingPosition();
 		if (!m_deletionQueue.contains(chunkStartingPosition) &&
-			!visibilityRect.contains(chunk->second.object.get().getAABB()))
+			!loadedRect.contains(chunk->second.get().getAABB()))
 		{
 			m_deletionQueue.add({ chunkStartingPosition });
 		}
 	}
 }
 
+//Chunks kept past the visibility distance for their neighbours' sake lose their mesh - addChunks meshes them again if they come back
+void ChunkManager::deleteChunkMeshes(const Rectangle& visibilityRect)
+{
+	PROFILE_SCOPE("ChunkManager::deleteChunkMeshes");
+	for (auto chunkMesh = m_chunkMeshes.begin(); chunkMesh != m_chunkMeshes.end();)
+	{
+		const glm::ivec3& chunkStartingPosition = chunkMesh->first;
+		auto chunk = m_chunks.find(chunkStartingPosition);
+		if (chunk == m_chunks.end() || visibilityRect.contains(chunk->second.get().getAABB()))
+		{
+			++chunkMesh;
+			continue;
+		}
+
+		auto chunkGenerationState = m_chunkGenerationStates.find(chunkStartingPosition);
+		assert(chunkGenerationState != m_chunkGenerationStates.end());
+		if (chunkGenerationState->second.state == eChunkState::Uploaded)
+		{
+			chunkGenerationState->second.state = eChunkState::Decorated;
+		}
+
+		m_chunkMeshRegenerationQueue.remove(chunkStartingPosition);
+		chunkMesh = m_chunkMeshes.erase(chunkMesh);
+	}
+}
+
 void ChunkManager::addChunks(const glm::ivec3& playerPosition)
 {
+	PROFILE_SCOPE("ChunkManager::addChunks");
 	assert(m_chunksToAdd.empty());
+	m_nearestMissingChunkDistance = -1.0f;
 	glm::ivec3 startPosition = Globals::getClosestMiddlePosition(playerPosition);
 	startPosition = getClosestChunkStartingPosition(startPosition);
-	for (int z = startPosition.z - Globals::VISIBILITY_DISTANCE; z <= startPosition.z + Globals::VISIBILITY_DISTANCE; z += Globals::CHUNK_DEPTH)
+	Rectangle visibilityRect = Globals::getVisibilityRect(playerPosition, m_visibilityDistance);
+	int loadedDistance = getLoadedDistance(m_visibilityDistance);
+	for (int z = startPosition.z - loadedDistance; z <= startPosition.z + loadedDistance; z += Globals::CHUNK_DEPTH)
 	{
-		for (int x = startPosition.x - Globals::VISIBILITY_DISTANCE; x <= startPosition.x + Globals::VISIBILITY_DISTANCE; x += Globals::CHUNK_WIDTH)
+		for (int x = startPosition.x - loadedDistance; x <= startPosition.x + loadedDistance; x += Globals::CHUNK_WIDTH)
 		{
 			glm::ivec3 chunkStartingPosition(x, 0, z);
-			if (m_chunks.find(chunkStartingPosition) == m_chunks.cend() && 
-				m_chunkMeshes.find(chunkStartingPosition) == m_chunkMeshes.cend() && 
-				!m_chunkMeshesToGenerateQueue.contains(chunkStartingPosition) &&
-				!m_generatedChunkMeshQueue.contains(chunkStartingPosition) && 
-				!m_generatedChunkQueue.contains(chunkStartingPosition))
+			auto chunkGenerationState = m_chunkGenerationStates.find(chunkStartingPosition);
+			if (chunkGenerationState == m_chunkGenerationStates.end())
 			{
 				m_chunksToAdd.emplace_back(Globals::getSqrMagnitude(chunkStartingPosition, playerPosition), chunkStartingPosition);
 			}
+			//Back within the visibility distance after losing its mesh
+			else if (chunkGenerationState->second.state == eChunkState::Decorated &&
+				visibilityRect.contains(m_chunks.at(chunkStartingPosition).get().getAABB()))
+			{
+				tryScheduleChunkMesh(chunkStartingPosition, chunkGenerationState->second);
+			}
 		}
 	}
 
@@ -379,11 +739,41 @@ void ChunkManager::addChunks(const glm::ivec3& playerPosition)
 		{
 			if (m_chunkPool.isObjectAvailable())
 			{
+				int availableSurroundingChunks = 0;
+				for (const glm::ivec3& surroundingChunkStartingPosition : getSurroundingChunkPositions(chunkToAdd.startingPosition))
+				{
+					if (m_chunks.find(surroundingChunkStartingPosition) != m_chunks.cend())
+					{
+						++availableSurroundingChunks;
+					}
+				}
+
+				int decoratedNeighbours = 0;
+				for (eDirection direction : NEIGHBOURING_CHUNK_DIRECTIONS)
+				{
+					glm::ivec3 neighbouringChunkStartingPosition = getNeighbouringChunkPosition(chunkToAdd.startingPosition, direction);
+					auto neighbouringChunkGenerationState = m_chunkGenerationStates.find(neighbouringChunkStartingPosition);
+					if (m_chunks.find(neighbouringChunkStartingPosition) != m_chunks.cend() &&
+						neighbouringChunkGenerationState->second.state >= eChunkState::Decorated)
+					{
+						++decoratedNeighbours;
+					}
+				}
+
+				m_chunkGenerationStates.emplace(std::piecewise_construct,
+					std::forward_as_tuple(chunkToAdd.startingPosition),
+					std::forward_as_tuple(availableSurroundingChunks, decoratedNeighbours));
+
+				//Trees are placed here but only stamped in once the surrounding chunks have placed theirs
 				ObjectFromPool<Chunk> chunkFromPool = m_chunkPool.getAvailableObject();
-				chunkFromPool.object.get().reuse(chunkToAdd.startingPosition);
-				m_generatedChunkQueue.add({ chunkToAdd.startingPosition, std::move(chunkFromPool) });
+				chunkFromPool.get().reuse(chunkToAdd.startingPosition);
 
-				m_chunkMeshesToGenerateQueue.add({ chunkToAdd.startingPosition });
+				m_generatedChunkQueue.add({ chunkToAdd.startingPosition, std::move(chunkFromPool) });
+			}
+			else if (m_nearestMissingChunkDistance < 0.0f)
+			{
+				m_nearestMissingChunkDistance = chunkToAdd.distanceFromCamera;
+				getMetrics().chunkPoolExhausted.add();
 			}
 		}
 
@@ -391,88 +781,325 @@ void ChunkManager::addChunks(const glm::ivec3& playerPosition)
 	}
 }
 
-void ChunkManager::clearQueues(const glm::ivec3& playerPosition, const Rectangle& visibilityRect)
+//Only chunks within the visibility distance are meshed but the ones around them are still decorated
+void ChunkManager::clearQueues(const glm::ivec3& playerPosition, const Rectangle& visibilityRect, const Rectangle& loadedRect)
 {
-	m_chunkMeshesToGenerateQueue.removeOutOfBoundsElements(visibilityRect);
-	m_generatedChunkMeshQueue.removeOutOfBoundsElements(visibilityRect);
-	m_generatedChunkQueue.removeOutOfBoundsElements(visibilityRect);
+	PROFILE_SCOPE("ChunkManager::clearQueues");
+	m_chunksToDecorateQueue.removeOutOfBoundsElements(loadedRect, [this](const ObjectQueuePositionNode& chunkToDecorate)
+	{
+		auto chunkGenerationState = m_chunkGenerationStates.find(chunkToDecorate.getPosition());
+		assert(chunkGenerationState != m_chunkGenerationStates.end());
+		chunkGenerationState->second.state = eChunkState::TerrainReady;
+	});
+	m_chunkMeshesToGenerateQueue.removeOutOfBoundsElements(visibilityRect, [this](const ObjectQueuePositionNode& chunkMeshToGenerate)
+	{
+		auto chunkGenerationState = m_chunkGenerationStates.find(chunkMeshToGenerate.getPosition());
+		assert(chunkGenerationState != m_chunkGenerationStates.end());
+		chunkGenerationState->second.state = eChunkState::Decorated;
+	});
+	m_generatedChunkMeshQueue.removeOutOfBoundsElements(visibilityRect, [this](const ObjectQueueObjectNode<ObjectFromPool<VertexArray>>& generatedChunkMesh)
+	{
+		//Chunks being given a new level of detail keep the mesh they have
+		auto chunkGenerationState = m_chunkGenerationStates.find(generatedChunkMesh.getPosition());
+		if (chunkGenerationState != m_chunkGenerationStates.end() && chunkGenerationState->second.state == eChunkState::Meshed)
+		{
+			chunkGenerationState->second.state = eChunkState::Decorated;
+		}
+	});
+	m_generatedChunkQueue.removeOutOfBoundsElements(loadedRect, [this](const ObjectQueueObjectNode<ObjectFromPool<Chunk>>& generatedChunk)
+	{
+		m_chunkGenerationStates.erase(generatedChunk.getPosition());
+	});
 	m_chunkMeshRegenerationQueue.removeOutOfBoundsElements(visibilityRect);
 }
 
-void ChunkManager::handleChunkMeshesToGenerateQueue()
+//The chunk the cube is in and any loaded neighbour whose faces border it
+//Entries go once the chunk is unloaded or a mesh built since the edit is uploaded
+void ChunkManager::onCubeEdited(const glm::ivec3& position)
 {
-	if (m_chunkMeshesToGenerateQueue.isEmpty())
+	++m_chunkEditGeneration;
+	for (const glm::ivec3& offset : { glm::ivec3(0, 0, 0), glm::ivec3(-1, 0, 0), glm::ivec3(1, 0, 0), glm::ivec3(0, 0, 1), glm::ivec3(0, 0, -1) })
 	{
-		return;
+		glm::ivec3 chunkStartingPosition = getClosestChunkStartingPosition(position + offset);
+		if (m_chunks.find(chunkStartingPosition) != m_chunks.cend())
+		{
+			m_chunkEditGenerations[chunkStartingPosition] = m_chunkEditGeneration;
+		}
 	}
+}
+
+void ChunkManager::onChunkAvailable(const glm::ivec3& chunkStartingPosition)
+{
+	auto chunkGenerationState = m_chunkGenerationStates.find(chunkStartingPosition);
+	assert(chunkGenerationState != m_chunkGenerationStates.end());
+	++chunkGenerationState->second.terrainDependencies;
+	tryScheduleChunkDecoration(chunkStartingPosition, chunkGenerationState->second);
 
-	ObjectQueuePositionNode* chunkMeshToGenerate = &m_chunkMeshesToGenerateQueue.front();
-	while (chunkMeshToGenerate)
+	for (const glm::ivec3& surroundingChunkStartingPosition : getSurroundingChunkPositions(chunkStartingPosition))
 	{
-		const glm::ivec3& chunkStartingPosition = chunkMeshToGenerate->getPosition();
-		if (isAllNeighbouringChunksAvailable(m_chunks, chunkStartingPosition))
+		auto surroundingChunkGenerationState = m_chunkGenerationStates.find(surroundingChunkStartingPosition);
+		if (surroundingChunkGenerationState != m_chunkGenerationStates.end())
 		{
-			if (m_chunkMeshPool.isObjectAvailable())
-			{
-				ObjectFromPool<VertexArray> chunkMeshFromPool = m_chunkMeshPool.getAvailableObject();
-				auto chunk = m_chunks.find(chunkStartingPosition);
-				if (chunk != m_chunks.cend())
-				{
-					MeshGenerator::generateChunkMesh(chunkMeshFromPool.object, chunk->second.object,
-						getAllNeighbouringChunks(m_chunks, chunkStartingPosition));
+			++surroundingChunkGenerationState->second.terrainDependencies;
+			tryScheduleChunkDecoration(surroundingChunkStartingPosition, surroundingChunkGenerationState->second);
+		}
+	}
+}
+
+void ChunkManager::onChunkDecorated(const glm::ivec3& chunkStartingPosition)
+{
+	auto chunkGenerationState = m_chunkGenerationStates.find(chunkStartingPosition);
+	assert(chunkGenerationState != m_chunkGenerationStates.end());
+	++chunkGenerationState->second.decoratedDependencies;
+	tryScheduleChunkMesh(chunkStartingPosition, chunkGenerationState->second);
 
-					m_generatedChunkMeshQueue.add(
-						ObjectQueueObjectNode<ObjectFromPool<VertexArray>>(chunkStartingPosition, std::move(chunkMeshFromPool) ));
+	for (eDirection direction : NEIGHBOURING_CHUNK_DIRECTIONS)
+	{
+		glm::ivec3 neighbouringChunkStartingPosition = getNeighbouringChunkPosition(chunkStartingPosition, direction);
+		auto neighbouringChunkGenerationState = m_chunkGenerationStates.find(neighbouringChunkStartingPosition);
+		if (neighbouringChunkGenerationState != m_chunkGenerationStates.end())
+		{
+			++neighbouringChunkGenerationState->second.decoratedDependencies;
+			tryScheduleChunkMesh(neighbouringChunkStartingPosition, neighbouringChunkGenerationState->second);
+		}
+	}
+}
 
-					chunkMeshToGenerate = m_chunkMeshesToGenerateQueue.remove(chunkMeshToGenerate);
-				}
-				else
-				{
-					chunkMeshToGenerate = m_chunkMeshesToGenerateQueue.next(chunkMeshToGenerate);
-				}
+void ChunkManager::onChunkUnavailable(const glm::ivec3& chunkStartingPosition)
+{
+	auto chunkGenerationState = m_chunkGenerationStates.find(chunkStartingPosition);
+	assert(chunkGenerationState != m_chunkGenerationStates.end());
+	bool decorated = chunkGenerationState->second.state >= eChunkState::Decorated;
+	m_chunkGenerationStates.erase(chunkGenerationState);
+	m_chunkEditGenerations.erase(chunkStartingPosition);
+	m_chunksToDecorateQueue.remove(chunkStartingPosition);
+	m_chunkMeshesToGenerateQueue.remove(chunkStartingPosition);
+	m_generatedChunkMeshQueue.remove(chunkStartingPosition);
+
+	for (const glm::ivec3& surroundingChunkStartingPosition : getSurroundingChunkPositions(chunkStartingPosition))
+	{
+		auto surroundingChunkGenerationState = m_chunkGenerationStates.find(surroundingChunkStartingPosition);
+		if (surroundingChunkGenerationState != m_chunkGenerationStates.end())
+		{
+			--surroundingChunkGenerationState->second.terrainDependencies;
+			assert(surroundingChunkGenerationState->second.terrainDependencies >= 0);
+
+			if (surroundingChunkGenerationState->second.state == eChunkState::Decoratable)
+			{
+				surroundingChunkGenerationState->second.state = eChunkState::TerrainReady;
+				m_chunksToDecorateQueue.remove(surroundingChunkStartingPosition);
 			}
-			else
+		}
+	}
+
+	if (!decorated)
+	{
+		return;
+	}
+
+	for (eDirection direction : NEIGHBOURING_CHUNK_DIRECTIONS)
+	{
+		glm::ivec3 neighbouringChunkStartingPosition = getNeighbouringChunkPosition(chunkStartingPosition, direction);
+		auto neighbouringChunkGenerationState = m_chunkGenerationStates.find(neighbouringChunkStartingPosition);
+		if (neighbouringChunkGenerationState != m_chunkGenerationStates.end())
+		{
+			--neighbouringChunkGenerationState->second.decoratedDependencies;
+			assert(neighbouringChunkGenerationState->second.decoratedDependencies >= 0);
+
+			if (neighbouringChunkGenerationState->second.state == eChunkState::Meshable)
 			{
-				chunkMeshToGenerate = m_chunkMeshesToGenerateQueue.next(chunkMeshToGenerate);
+				neighbouringChunkGenerationState->second.state = eChunkState::Decorated;
+				m_chunkMeshesToGenerateQueue.remove(neighbouringChunkStartingPosition);
 			}
 		}
-		else
+	}
+}
+
+void ChunkManager::tryScheduleChunkDecoration(const glm::ivec3& chunkStartingPosition, ChunkGenerationState& chunkGenerationState)
+{
+	assert(chunkGenerationState.terrainDependencies <= CHUNK_DECORATION_DEPENDENCY_COUNT);
+	if (chunkGenerationState.state == eChunkState::TerrainReady &&
+		chunkGenerationState.terrainDependencies == CHUNK_DECORATION_DEPENDENCY_COUNT)
+	{
+		chunkGenerationState.state = eChunkState::Decoratable;
+		m_chunksToDecorateQueue.add({ chunkStartingPosition });
+	}
+}
+
+void ChunkManager::tryScheduleChunkMesh(const glm::ivec3& chunkStartingPosition, ChunkGenerationState& chunkGenerationState)
+{
+	assert(chunkGenerationState.decoratedDependencies <= CHUNK_MESH_DEPENDENCY_COUNT);
+	if (chunkGenerationState.state == eChunkState::Decorated &&
+		chunkGenerationState.decoratedDependencies == CHUNK_MESH_DEPENDENCY_COUNT)
+	{
+		chunkGenerationState.state = eChunkState::Meshable;
+		m_chunkMeshesToGenerateQueue.add({ chunkStartingPosition });
+	}
+}
+
+//A chunk is only ever written to here before it or any of its neighbours have been meshed
+//Done with the player locked out as the chunk is already available to it
+void ChunkManager::handleChunksToDecorateQueue()
+{
+	PROFILE_SCOPE("ChunkManager::handleChunksToDecorateQueue");
+	for (int i = 0; i < THREAD_TRANSFER_PER_FRAME && !m_chunksToDecorateQueue.isEmpty(); ++i)
+	{
+		glm::ivec3 chunkStartingPosition = m_chunksToDecorateQueue.front().getPosition();
+		auto chunk = m_chunks.find(chunkStartingPosition);
+		auto chunkGenerationState = m_chunkGenerationStates.find(chunkStartingPosition);
+		assert(chunk != m_chunks.end() && chunkGenerationState != m_chunkGenerationStates.end() &&
+			chunkGenerationState->second.state == eChunkState::Decoratable);
+
+		chunk->second.get().decorate(getAllSurroundingChunks(m_chunks, chunkStartingPosition));
+		chunkGenerationState->second.state = eChunkState::Decorated;
+
+		m_chunksToDecorateQueue.pop();
+		onChunkDecorated(chunkStartingPosition);
+	}
+}
+
+void ChunkManager::handleChunkMeshesToGenerateQueue(const glm::vec3& playerPosition)
+{
+	PROFILE_SCOPE("ChunkManager::handleChunkMeshesToGenerateQueue");
+	//Every queued chunk is Meshable - its dependencies were satisfied when it was added
+	while (!m_chunkMeshesToGenerateQueue.isEmpty() && m_chunkMeshPool.isObjectAvailable())
+	{
+		const glm::ivec3& chunkStartingPosition = m_chunkMeshesToGenerateQueue.front().getPosition();
+		auto chunk = m_chunks.find(chunkStartingPosition);
+		auto chunkGenerationState = m_chunkGenerationStates.find(chunkStartingPosition);
+		assert(chunk != m_chunks.cend() && chunkGenerationState != m_chunkGenerationStates.end() &&
+			chunkGenerationState->second.state == eChunkState::Meshable);
+
+		ObjectFromPool<VertexArray> chunkMeshFromPool = m_chunkMeshPool.getAvailableObject();
+		chunkGenerationState->second.meshLOD = getChunkMeshLOD(getChunkMeshDistance(chunkStartingPosition, playerPosition));
+		chunkGenerationState->second.meshEditGeneration = m_chunkMeshEditGeneration;
+		MeshGenerator::generateChunkMesh(chunkMeshFromPool.get(), chunk->second.get(),
+			getAllNeighbouringChunks(m_chunks, chunkStartingPosition), chunkGenerationState->second.meshLOD);
+		chunkGenerationState->second.state = eChunkState::Meshed;
+
+		m_generatedChunkMeshQueue.add(
+			ObjectQueueObjectNode<ObjectFromPool<VertexArray>>(chunkStartingPosition, std::move(chunkMeshFromPool)));
+
+		m_chunkMeshesToGenerateQueue.pop();
+	}
+}
+
+//The new mesh replaces the old one once it's uploaded so the chunk is never left without one
+//Chunks without a mesh yet come first
+void ChunkManager::updateChunkMeshLODs(const glm::vec3& playerPosition)
+{
+	PROFILE_SCOPE("ChunkManager::updateChunkMeshLODs");
+	if (!m_chunkMeshesToGenerateQueue.isEmpty() || m_generatedChunkMeshQueue.size() >= static_cast<size_t>(THREAD_TRANSFER_PER_FRAME))
+	{
+		return;
+	}
+
+	int chunkMeshesGenerated = 0;
+	for (auto& chunkGenerationState : m_chunkGenerationStates)
+	{
+		if (chunkMeshesGenerated == THREAD_TRANSFER_PER_FRAME || !m_chunkMeshPool.isObjectAvailable())
+		{
+			break;
+		}
+
+		const glm::ivec3& chunkStartingPosition = chunkGenerationState.first;
+		if (chunkGenerationState.second.state != eChunkState::Uploaded ||
+			chunkGenerationState.second.decoratedDependencies != CHUNK_MESH_DEPENDENCY_COUNT ||
+			m_generatedChunkMeshQueue.contains(chunkStartingPosition))
+		{
+			continue;
+		}
+
+		float chunkMeshDistance = getChunkMeshDistance(chunkStartingPosition, playerPosition);
+		eChunkMeshLOD chunkMeshLOD = chunkGenerationState.second.meshLOD;
+		if (getChunkMeshLOD(chunkMeshDistance - CHUNK_MESH_LOD_HYSTERESIS) <= chunkMeshLOD &&
+			getChunkMeshLOD(chunkMeshDistance + CHUNK_MESH_LOD_HYSTERESIS) >= chunkMeshLOD)
 		{
-			chunkMeshToGenerate = m_chunkMeshesToGenerateQueue.next(chunkMeshToGenerate);
+			continue;
 		}
+
+		auto chunk = m_chunks.find(chunkStartingPosition);
+		assert(chunk != m_chunks.cend());
+
+		ObjectFromPool<VertexArray> chunkMeshFromPool = m_chunkMeshPool.getAvailableObject();
+		chunkGenerationState.second.meshLOD = getChunkMeshLOD(chunkMeshDistance);
+		chunkGenerationState.second.meshEditGeneration = m_chunkMeshEditGeneration;
+		MeshGenerator::generateChunkMesh(chunkMeshFromPool.get(), chunk->second.get(),
+			getAllNeighbouringChunks(m_chunks, chunkStartingPosition), chunkGenerationState.second.meshLOD);
+
+		m_generatedChunkMeshQueue.add(
+			ObjectQueueObjectNode<ObjectFromPool<VertexArray>>(chunkStartingPosition, std::move(chunkMeshFromPool)));
+		++chunkMeshesGenerated;
 	}
 }
 
 void ChunkManager::handleChunkMeshRegenerationQueue()
 {
-	if (!m_chunkMeshRegenerationQueue.isEmpty())
+	PROFILE_SCOPE("ChunkManager::handleChunkMeshRegenerationQueue");
+	while (!m_chunkMeshRegenerationQueue.isEmpty())
 	{
-		ObjectQueueObjectNode<std::reference_wrapper<VertexArray>>* regenNode = &m_chunkMeshRegenerationQueue.front();
-		while (regenNode)
-		{
-			regenNode->object.get().reset();
+		ObjectQueueObjectNode<std::reference_wrapper<VertexArray>>& regenNode = m_chunkMeshRegenerationQueue.front();
+		regenNode.object.get().reset();
 
-			const glm::ivec3& chunkStartingPosition = regenNode->getPosition();
-			auto chunk = m_chunks.find(chunkStartingPosition);
-			assert(chunk != m_chunks.cend());
+		const glm::ivec3& chunkStartingPosition = regenNode.getPosition();
+		auto chunk = m_chunks.find(chunkStartingPosition);
+		auto chunkGenerationState = m_chunkGenerationStates.find(chunkStartingPosition);
+		assert(chunk != m_chunks.cend() && chunkGenerationState != m_chunkGenerationStates.end());
 
-			MeshGenerator::generateChunkMesh(regenNode->object.get(), chunk->second.object,
-				getAllNeighbouringChunks(m_chunks, chunkStartingPosition));
+		MeshGenerator::generateChunkMesh(regenNode.object.get(), chunk->second.get(),
+			getAllNeighbouringChunks(m_chunks, chunkStartingPosition), chunkGenerationState->second.meshLOD);
 
-			regenNode = m_chunkMeshRegenerationQueue.remove(regenNode);
-		}
+		m_chunkMeshRegenerationQueue.pop();
 	}
 }
 
 void ChunkManager::handleGeneratedChunkMeshQueue()
 {
+	PROFILE_SCOPE("ChunkManager::handleGeneratedChunkMeshQueue");
 	if (!m_generatedChunkMeshQueue.isEmpty())
 	{
 		ObjectQueueObjectNode<ObjectFromPool<VertexArray>>& generatedChunkMesh = m_generatedChunkMeshQueue.front();
+		const glm::ivec3& chunkStartingPosition = generatedChunkMesh.getPosition();
+
+		//Meshes are built without holding chunkInteractionMutex so the chunk may have been edited since
+		auto chunkGenerationState = m_chunkGenerationStates.find(chunkStartingPosition);
+		auto chunkEditGeneration = m_chunkEditGenerations.find(chunkStartingPosition);
+		bool edited = chunkGenerationState != m_chunkGenerationStates.end() && chunkEditGeneration != m_chunkEditGenerations.end() &&
+			chunkEditGeneration->second > chunkGenerationState->second.meshEditGeneration;
+
+		auto chunkMesh = m_chunkMeshes.find(chunkStartingPosition);
+		if (chunkMesh != m_chunkMeshes.end())
+		{
+			//The edit has already been regenerated into the current mesh
+			if (!edited)
+			{
+				assert(!m_chunkMeshRegenerationQueue.contains(chunkStartingPosition));
+				chunkMesh->second = std::move(generatedChunkMesh.object);
+			}
+		}
+		else
+		{
+			chunkMesh = m_chunkMeshes.emplace(std::piecewise_construct,
+				std::forward_as_tuple(chunkStartingPosition),
+				std::forward_as_tuple(std::move(generatedChunkMesh.object))).first;
+
+			//There was no mesh to regenerate when the chunk was edited
+			if (edited && !m_chunkMeshRegenerationQueue.contains(chunkStartingPosition))
+			{
+				m_chunkMeshRegenerationQueue.add({ chunkStartingPosition, chunkMesh->second.get() });
+			}
+		}
 
-		m_chunkMeshes.emplace(std::piecewise_construct,
-			std::forward_as_tuple(generatedChunkMesh.getPosition()),
-			std::forward_as_tuple(std::move(generatedChunkMesh.object)));
+		//Every edit so far is in the uploaded mesh
+		if (!edited && chunkEditGeneration != m_chunkEditGenerations.end())
+		{
+			m_chunkEditGenerations.erase(chunkEditGeneration);
+		}
+
+		if (chunkGenerationState != m_chunkGenerationStates.end())
+		{
+			chunkGenerationState->second.state = eChunkState::Uploaded;
+		}
 
 		m_generatedChunkMeshQueue.pop();
 	}
@@ -480,14 +1107,130 @@ void ChunkManager::handleGeneratedChunkMeshQueue()
 
 void ChunkManager::handleGeneratedChunkQueue()
 {
+	PROFILE_SCOPE("ChunkManager::handleGeneratedChunkQueue");
 	if (!m_generatedChunkQueue.isEmpty())
 	{
 		ObjectQueueObjectNode<ObjectFromPool<Chunk>>& generatedChunk = m_generatedChunkQueue.front();
 
+		glm::ivec3 chunkStartingPosition = generatedChunk.getPosition();
 		m_chunks.emplace(std::piecewise_construct,
-			std::forward_as_tuple(generatedChunk.getPosition()),
+			std::forward_as_tuple(chunkStartingPosition),
 			std::forward_as_tuple(std::move(generatedChunk.object)));
 
+		auto chunkGenerationState = m_chunkGenerationStates.find(chunkStartingPosition);
+		assert(chunkGenerationState != m_chunkGenerationStates.end() && chunkGenerationState->second.state == eChunkState::Queued);
+		chunkGenerationState->second.state = eChunkState::TerrainReady;
+
 		m_generatedChunkQueue.pop();
+		onChunkAvailable(chunkStartingPosition);
+		getMetrics().chunksAdded.add();
+	}
+}
+
+void ChunkManager::updateMetrics() const
+{
+	ChunkManagerMetrics& metrics = getMetrics();
+	metrics.chunksToDecorateQueue.set(static_cast<int64_t>(m_chunksToDecorateQueue.size()));
+	metrics.chunkMeshesToGenerateQueue.set(static_cast<int64_t>(m_chunkMeshesToGenerateQueue.size()));
+	metrics.deletionQueue.set(static_cast<int64_t>(m_deletionQueue.size()));
+	metrics.generatedChunkQueue.set(static_cast<int64_t>(m_generatedChunkQueue.size()));
+	metrics.generatedChunkMeshQueue.set(static_cast<int64_t>(m_generatedChunkMeshQueue.size()));
+	metrics.chunkMeshRegenerationQueue.set(static_cast<int64_t>(m_chunkMeshRegenerationQueue.size()));
+	metrics.chunks.set(static_cast<int64_t>(m_chunks.size()));
+	metrics.chunkMeshes.set(static_cast<int64_t>(m_chunkMeshes.size()));
+	publishObjectPoolStats(m_chunkPool.getStats(), metrics.chunkPoolCapacity, metrics.chunkPoolFree, metrics.chunkPoolHighWaterMark);
+	publishObjectPoolStats(m_chunkMeshPool.getStats(), metrics.chunkMeshPoolCapacity, metrics.chunkMeshPoolFree,
+		metrics.chunkMeshPoolHighWaterMark);
+}
+
+//VoxelAccessor
+VoxelAccessor::VoxelAccessor(const ChunkManager& chunkManager)
+	: m_chunkManager(chunkManager),
+	//No chunk starts below the ground so the first read always looks its chunk up
+	m_chunkStartingPosition(0, -1, 0),
+	m_chunk(nullptr)
+{}
+
+eCubeType VoxelAccessor::getCubeType(const glm::ivec3& position)
+{
+	if (position.y < 0 || position.y >= Globals::CHUNK_HEIGHT)
+	{
+		return eCubeType::Air;
+	}
+
+	glm::ivec3 chunkStartingPosition = getClosestChunkStartingPosition(position);
+	if (chunkStartingPosition != m_chunkStartingPosition)
+	{
+		m_chunkStartingPosition = chunkStartingPosition;
+		auto chunk = m_chunkManager.m_chunks.find(chunkStartingPosition);
+		m_chunk = chunk != m_chunkManager.m_chunks.cend() ? &chunk->second.get() : nullptr;
+	}
+
+	if (!m_chunk)
+	{
+		return eCubeType::Air;
+	}
+
+	return m_chunk->getCubeTypeByLocalPosition(getLocalPosition(position));
+}
+
+bool VoxelAccessor::isCubeAtPosition(const glm::ivec3& position, eCubeType& cubeType)
+{
+	eCubeType cubeTypeAtPosition = getCubeType(position);
+	if (cubeTypeAtPosition != eCubeType::Air)
+	{
+		cubeType = cubeTypeAtPosition;
+		return true;
+	}
+
+	return false;
+}
+
+//AutoVisibilityDistance
+AutoVisibilityDistance::AutoVisibilityDistance(float targetFrameTime)
+	: m_targetFrameTime(targetFrameTime),
+	m_enabled(false),
+	m_averageFrameTime(targetFrameTime),
+	m_elapsedTime(0.0f)
+{}
+
+bool AutoVisibilityDistance::isEnabled() const
+{
+	return m_enabled;
+}
+
+void AutoVisibilityDistance::setEnabled(bool enabled)
+{
+	m_enabled = enabled;
+	m_averageFrameTime = m_targetFrameTime;
+	m_elapsedTime = 0.0f;
+}
+
+void AutoVisibilityDistance::update(float deltaTime, float frameTime, ChunkManager& chunkManager)
+{
+	if (!m_enabled)
+	{
+		return;
+	}
+
+	m_averageFrameTime += (frameTime - m_averageFrameTime) * AUTO_VISIBILITY_DISTANCE_SMOOTHING;
+	m_elapsedTime += deltaTime;
+	if (m_elapsedTime < AUTO_VISIBILITY_DISTANCE_INTERVAL)
+	{
+		return;
+	}
+	m_elapsedTime = 0.0f;
+
+	int visibilityDistance = chunkManager.getVisibilityDistance();
+	size_t memoryBudget = chunkManager.getMemoryBudget();
+	if (m_averageFrameTime > m_targetFrameTime * AUTO_VISIBILITY_DISTANCE_DECREASE_THRESHOLD ||
+		getChunkMemoryUsage(visibilityDistance) > memoryBudget)
+	{
+		chunkManager.setVisibilityDistance(visibilityDistance - Globals::CHUNK_WIDTH);
+	}
+	else if (m_averageFrameTime < m_targetFrameTime * AUTO_VISIBILITY_DISTANCE_INCREASE_THRESHOLD &&
+		getChunkMemoryUsage(visibilityDistance + Globals::CHUNK_WIDTH) <= memoryBudget)
+	{
+		chunkManager.setVisibilityDistance(visibilityDistance + Globals::CHUNK_WIDTH);
 	}
 }
\ No newline at end of file
@@ -1,12 +1,17 @@
 #pragma once
 
 #include "ObjectPool.h"
+#include "Globals.h"
 #include "Chunk.h"
 #include "VertexArray.h"
 #include "ObjectQueue.h"
+#include "ChunkResidencyManager.h"
+#include "MemoryAccounting.h"
+#include "MeshGenerator.h"
+#include "InstrumentedMutex.h"
 #include <vector>
 #include <unordered_map>
-#include <mutex>
+#include "glm/gtx/hash.hpp"
 #include <SFML/Graphics.hpp>
 #include <atomic>
 #include <functional>
@@ -19,45 +24,157 @@ struct ChunkToAdd
 	glm::ivec3 startingPosition;
 };
 
+enum class eChunkState
+{
+	Queued = 0, //Terrain is generated but the chunk isn't in m_chunks yet
+	TerrainReady,
+	Decoratable,
+	Decorated,
+	Meshable,
+	Meshed,
+	Uploaded
+};
+
+//Decorating depends on the chunk itself plus its eight surrounding chunks being available in m_chunks
+//Meshing depends on the chunk itself plus its four neighbours being decorated
+struct ChunkGenerationState
+{
+	ChunkGenerationState(int terrainDependencies, int decoratedDependencies);
+
+	eChunkState state;
+	int terrainDependencies;
+	int decoratedDependencies;
+	eChunkMeshLOD meshLOD;
+	//Edit generation the last generated mesh was built from
+	int64_t meshEditGeneration;
+};
+
+struct VoxelRaycastHit
+{
+	glm::ivec3 position;
+	//Out of the face the ray entered through - zero when the ray starts inside the cube
+	glm::ivec3 normal;
+	eCubeType cubeType;
+	float distance;
+	//Cell the ray passed through before the first non air cube, accepted by the filter or not - so cubes can be placed on water
+	//Set whether or not anything is hit - not found when there is no such cube in range or the ray starts inside it
+	glm::ivec3 placementPosition;
+	bool placementFound;
+};
+
 struct Rectangle;
 class Player;
 class Frustum;
 class ChunkManager : private NonCopyable, private NonMovable
 {
+	friend class VoxelAccessor;
 public:
-	ChunkManager();
+	ChunkManager(int visibilityDistance = Globals::DEFAULT_VISIBILITY_DISTANCE, size_t memoryBudget = Globals::DEFAULT_MEMORY_BUDGET);
+
+	int getVisibilityDistance() const;
+	void setVisibilityDistance(int visibilityDistance);
+	size_t getMemoryBudget() const;
+	MemoryUsage getMemoryUsage() const;
 
 	bool getHighestCubeAtPosition(const glm::vec3& playerPosition, glm::vec3& position) const;
 	bool isCubeAtPosition(const glm::vec3& playerPosition) const;
 	bool isCubeAtPosition(const glm::vec3& playerPosition, eCubeType& cubeType) const;
 	bool isChunkAtPosition(const glm::vec3& position) const;
+	//Visits every cube the ray passes through in order (Amanatides & Woo) - stops at the first non air cube the filter accepts
+	bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+		const std::function<bool(eCubeType)>& filter, VoxelRaycastHit& hit) const;
+	//Every collidable cube between the two corners inclusive - looks each chunk up once rather than every cube
+	void getCollidableCubes(const glm::ivec3& minimumPosition, const glm::ivec3& maximumPosition, std::vector<glm::ivec3>& collidableCubes) const;
+	//Resolves every position under a single lock - cubes outside of the loaded chunks come back as Air
+	void getCubeTypes(const std::vector<glm::ivec3>& positions, std::vector<eCubeType>& cubeTypes, InstrumentedMutex& chunkInteractionMutex) const;
 
 	bool placeCubeAtPosition(const glm::ivec3& placementPosition, eCubeType cubeType);
 	bool destroyCubeAtPosition(const glm::ivec3& blockToDestroy, eCubeType& destroyedCubeType);
 	void update(const Player& player, const sf::Window& window, std::atomic<bool>& resetGame, 
-		std::mutex& chunkInteractionMutex, std::mutex& renderingMutex);
+		InstrumentedMutex& chunkInteractionMutex, InstrumentedMutex& renderingMutex);
 
 	void renderOpaque(const Frustum& frustum) const;
 	void renderTransparent(const Frustum& frustum) const;
+	void destroyRetiredChunkMeshes();
 
 private:
+	std::atomic<int> m_targetVisibilityDistance;
+	int m_visibilityDistance;
+	ChunkResidencyManager m_residencyManager;
+	float m_nearestMissingChunkDistance;
+	std::vector<glm::ivec3> m_chunksToEvict;
 	ObjectPool<Chunk> m_chunkPool;
 	ObjectPool<VertexArray> m_chunkMeshPool;
 	std::unordered_map<glm::ivec3, ObjectFromPool<Chunk>> m_chunks;
 	std::unordered_map<glm::ivec3, ObjectFromPool<VertexArray>> m_chunkMeshes;
+	std::unordered_map<glm::ivec3, ChunkGenerationState> m_chunkGenerationStates;
 	std::vector<ChunkToAdd> m_chunksToAdd;
+	ObjectQueue<ObjectQueuePositionNode> m_chunksToDecorateQueue;
 	ObjectQueue<ObjectQueuePositionNode> m_chunkMeshesToGenerateQueue;
 	ObjectQueue<ObjectQueuePositionNode> m_deletionQueue;
 	ObjectQueue<ObjectQueueObjectNode<ObjectFromPool<VertexArray>>> m_generatedChunkMeshQueue;
 	ObjectQueue<ObjectQueueObjectNode<ObjectFromPool<Chunk>>> m_generatedChunkQueue;
 	ObjectQueue<ObjectQueueObjectNode<std::reference_wrapper<VertexArray>>> m_chunkMeshRegenerationQueue;
+	//Only touched under chunkInteractionMutex - every edit bumps the generation of the chunks whose meshes it changes
+	int64_t m_chunkEditGeneration;
+	std::unordered_map<glm::ivec3, int64_t> m_chunkEditGenerations;
+	//Edit generation as of the last time the chunk thread held chunkInteractionMutex - meshes built since are at least this up to date
+	int64_t m_chunkMeshEditGeneration;
 	
-	void deleteChunks(const glm::ivec3& playerPosition, const Rectangle& visibilityRect);
+	void applyVisibilityDistance();
+	void applyMemoryBudget(const glm::vec3& playerPosition, const glm::vec3& cameraFront);
+	void deleteChunks(const glm::ivec3& playerPosition, const Rectangle& loadedRect);
+	void deleteChunkMeshes(const Rectangle& visibilityRect);
 	void addChunks(const glm::ivec3& playerPosition);
-	void clearQueues(const glm::ivec3& playerPosition, const Rectangle& visibilityRect);
+	void clearQueues(const glm::ivec3& playerPosition, const Rectangle& visibilityRect, const Rectangle& loadedRect);
+	void onCubeEdited(const glm::ivec3& position);
+
+	void onChunkAvailable(const glm::ivec3& chunkStartingPosition);
+	void onChunkDecorated(const glm::ivec3& chunkStartingPosition);
+	void onChunkUnavailable(const glm::ivec3& chunkStartingPosition);
+	void tryScheduleChunkDecoration(const glm::ivec3& chunkStartingPosition, ChunkGenerationState& chunkGenerationState);
+	void tryScheduleChunkMesh(const glm::ivec3& chunkStartingPosition, ChunkGenerationState& chunkGenerationState);
 	
-	void handleChunkMeshesToGenerateQueue();
+	void handleChunksToDecorateQueue();
+	void handleChunkMeshesToGenerateQueue(const glm::vec3& playerPosition);
+	void updateChunkMeshLODs(const glm::vec3& playerPosition);
 	void handleChunkMeshRegenerationQueue();
 	void handleGeneratedChunkMeshQueue();
 	void handleGeneratedChunkQueue();
+	void updateMetrics() const;
+};
+
+//Reads cubes through the chunk the previous read landed in - only looks a chunk up again once a read leaves it
+//Cubes outside of the loaded chunks, or above and below them, read as Air
+//Hold chunkInteractionMutex for as long as the accessor is in use
+class VoxelAccessor : private NonCopyable, private NonMovable
+{
+public:
+	VoxelAccessor(const ChunkManager& chunkManager);
+
+	eCubeType getCubeType(const glm::ivec3& position);
+	bool isCubeAtPosition(const glm::ivec3& position, eCubeType& cubeType);
+
+private:
+	const ChunkManager& m_chunkManager;
+	glm::ivec3 m_chunkStartingPosition;
+	const Chunk* m_chunk;
+};
+
+//Steps the visibility distance to hold a target frame time without the chunks outgrowing the chunk manager's memory budget
+class AutoVisibilityDistance : private NonCopyable, private NonMovable
+{
+public:
+	AutoVisibilityDistance(float targetFrameTime);
+
+	bool isEnabled() const;
+	void setEnabled(bool enabled);
+
+	void update(float deltaTime, float frameTime, ChunkManager& chunkManager);
+
+private:
+	const float m_targetFrameTime;
+	bool m_enabled;
+	float m_averageFrameTime;
+	float m_elapsedTime;
 };
\ No newline at end of file
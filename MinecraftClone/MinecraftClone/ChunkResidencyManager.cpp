@@ -0,0 +1,89 @@
+#include "ChunkResidencyManager.h"
+#include "Chunk.h"
+#include "Globals.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+
+namespace
+{
+	//Enough chunks to stand on regardless of the budget
+	constexpr size_t MIN_RESIDENT_CHUNKS = 25;
+	constexpr float VISIBLE_RADIUS = static_cast<float>(Globals::CHUNK_WIDTH * 2);
+}
+
+ChunkResidencyManager::ChunkResidencyManager(size_t memoryBudget)
+	: m_memoryBudget(memoryBudget),
+	m_viewPosition(),
+	m_viewDirection(),
+	m_evictionCandidates()
+{}
+
+size_t ChunkResidencyManager::getMemoryBudget() const
+{
+	return m_memoryBudget;
+}
+
+size_t ChunkResidencyManager::getResidentChunkLimit() const
+{
+	MemoryUsage memoryUsage = MemoryAccounting::getUsage();
+	size_t meshMemoryUsage = memoryUsage.CPUMeshes + memoryUsage.GPUMeshes;
+	if (meshMemoryUsage >= m_memoryBudget)
+	{
+		return MIN_RESIDENT_CHUNKS;
+	}
+
+	return std::max(MIN_RESIDENT_CHUNKS, (m_memoryBudget - meshMemoryUsage) / sizeof(Chunk));
+}
+
+void ChunkResidencyManager::setViewPoint(const glm::vec3& position, const glm::vec3& front)
+{
+	m_viewPosition = position;
+	m_viewDirection = glm::vec2(front.x, front.z);
+	if (glm::length(m_viewDirection) > 0.0f)
+	{
+		m_viewDirection = glm::normalize(m_viewDirection);
+	}
+}
+
+bool ChunkResidencyManager::isVisible(const glm::ivec3& chunkStartingPosition) const
+{
+	glm::vec2 chunkDirection(chunkStartingPosition.x + Globals::CHUNK_WIDTH / 2 - m_viewPosition.x,
+		chunkStartingPosition.z + Globals::CHUNK_DEPTH / 2 - m_viewPosition.z);
+
+	return glm::length(chunkDirection) <= VISIBLE_RADIUS || glm::dot(chunkDirection, m_viewDirection) >= 0.0f;
+}
+
+void ChunkResidencyManager::getChunksToEvict(const std::unordered_map<glm::ivec3, ObjectFromPool<Chunk>>& chunks,
+	const ObjectQueue<ObjectQueuePositionNode>& deletionQueue, size_t count, float minimumSqrDistance,
+	bool evictVisibleChunks, std::vector<glm::ivec3>& chunksToEvict)
+{
+	assert(m_evictionCandidates.empty());
+	for (const auto& chunk : chunks)
+	{
+		float sqrDistance = Globals::getSqrMagnitude(chunk.first, m_viewPosition);
+		if (sqrDistance <= minimumSqrDistance || deletionQueue.contains(chunk.first))
+		{
+			continue;
+		}
+
+		bool visible = isVisible(chunk.first);
+		if (!visible || evictVisibleChunks)
+		{
+			m_evictionCandidates.push_back({ chunk.first, sqrDistance, visible });
+		}
+	}
+
+	count = std::min(count, m_evictionCandidates.size());
+	std::partial_sort(m_evictionCandidates.begin(), m_evictionCandidates.begin() + count, m_evictionCandidates.end(),
+		[](const auto& a, const auto& b)
+	{
+		return a.visible != b.visible ? !a.visible : a.sqrDistance > b.sqrDistance;
+	});
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		chunksToEvict.push_back(m_evictionCandidates[i].chunkStartingPosition);
+	}
+
+	m_evictionCandidates.clear();
+}
\ No newline at end of file
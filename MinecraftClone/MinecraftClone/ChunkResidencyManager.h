@@ -0,0 +1,44 @@
+#pragma once
+
+#include "NonCopyable.h"
+#include "NonMovable.h"
+#include "ObjectPool.h"
+#include "ObjectQueue.h"
+#include "glm/glm.hpp"
+#include "glm/gtx/hash.hpp"
+#include <unordered_map>
+#include <vector>
+
+class Chunk;
+
+//Keeps voxel and mesh memory within a byte budget by limiting how many chunks are resident
+//and choosing which chunks to evict when the limit is hit
+class ChunkResidencyManager : private NonCopyable, private NonMovable
+{
+public:
+	ChunkResidencyManager(size_t memoryBudget);
+
+	size_t getMemoryBudget() const;
+	size_t getResidentChunkLimit() const;
+
+	void setViewPoint(const glm::vec3& position, const glm::vec3& front);
+	bool isVisible(const glm::ivec3& chunkStartingPosition) const;
+
+	//Farthest chunks out of view first - chunks within minimumSqrDistance are never chosen
+	void getChunksToEvict(const std::unordered_map<glm::ivec3, ObjectFromPool<Chunk>>& chunks,
+		const ObjectQueue<ObjectQueuePositionNode>& deletionQueue, size_t count, float minimumSqrDistance,
+		bool evictVisibleChunks, std::vector<glm::ivec3>& chunksToEvict);
+
+private:
+	struct EvictionCandidate
+	{
+		glm::ivec3 chunkStartingPosition;
+		float sqrDistance;
+		bool visible;
+	};
+
+	const size_t m_memoryBudget;
+	glm::vec3 m_viewPosition;
+	glm::vec2 m_viewDirection;
+	std::vector<EvictionCandidate> m_evictionCandidates;
+};
\ No newline at end of file
@@ -1,73 +1,139 @@
 #include "CollisionHandler.h"
 #include "ChunkManager.h"
 #include "Globals.h"
+#include <algorithm>
+#include <vector>
 
-bool CollisionHandler::handleXAxisCollision(float& velocity, float offset, const ChunkManager& chunkManager, const glm::vec3& position)
+namespace
 {
-	eCubeType cubeType = eCubeType::Air;
-	assert(velocity != 0);
-	glm::vec3 collisionPosition = position;
-	if (velocity > 0)
-	{
-		collisionPosition.x += offset;
-	}
-	else
+	constexpr float GROUND_DISTANCE = 0.05f;
+	//Cubes this close in front of the box still block it
+	constexpr float COLLISION_EPSILON = 0.001f;
+
+	thread_local std::vector<glm::ivec3> collidableCubes;
+
+	void getCollidableCubes(const glm::vec3& minimum, const glm::vec3& maximum, const ChunkManager& chunkManager)
 	{
-		collisionPosition.x -= offset;
+		collidableCubes.clear();
+		chunkManager.getCollidableCubes({ std::floor(minimum.x), std::floor(minimum.y), std::floor(minimum.z) },
+			{ std::floor(maximum.x), std::floor(maximum.y), std::floor(maximum.z) }, collidableCubes);
 	}
 
-	if (chunkManager.isCubeAtPosition({ std::floor(collisionPosition.x),
-		std::floor(collisionPosition.y),
-		std::floor(collisionPosition.z) }, cubeType) &&
-		!Globals::NON_COLLIDABLE_CUBE_TYPES.isMatch(cubeType))
+	//Boxes resting flush against each other aren't overlapping
+	bool isOverlapping(float minimumA, float maximumA, float minimumB, float maximumB)
 	{
-		velocity = 0.0f;
-		return true;
-		//Handle when getting stuck
+		return maximumA - COLLISION_EPSILON > minimumB && minimumA + COLLISION_EPSILON < maximumB;
 	}
-
-	return false;
 }
 
-bool CollisionHandler::handleZAxisCollision(float& velocity, float offset, const ChunkManager& chunkManager, const glm::vec3& position)
+glm::bvec3 CollisionHandler::move(glm::vec3& position, glm::vec3& velocity, float deltaTime,
+	const glm::vec3& boxMinimum, const glm::vec3& boxMaximum, const ChunkManager& chunkManager)
 {
-	eCubeType cubeType = eCubeType::Air;
-	assert(velocity != 0);
-	glm::vec3 collisionPosition = position;
-	if (velocity > 0)
-	{
-		collisionPosition.z += offset;
-	}
-	else
+	glm::vec3 displacement = velocity * deltaTime;
+	glm::vec3 minimum = position + boxMinimum;
+	glm::vec3 maximum = position + boxMaximum;
+	getCollidableCubes(glm::min(minimum, minimum + displacement) - COLLISION_EPSILON,
+		glm::max(maximum, maximum + displacement) + COLLISION_EPSILON, chunkManager);
+
+	glm::bvec3 blockedAxes(false);
+	for (int axis : { 1, 0, 2 })
 	{
-		collisionPosition.z -= offset;
+		if (displacement[axis] == 0.0f)
+		{
+			continue;
+		}
+
+		int otherAxisA = (axis + 1) % 3;
+		int otherAxisB = (axis + 2) % 3;
+		float allowedDisplacement = displacement[axis];
+		for (const auto& cube : collidableCubes)
+		{
+			glm::vec3 cubeMinimum(cube);
+			glm::vec3 cubeMaximum = cubeMinimum + glm::vec3(Globals::CUBE_FACE_SIZE);
+			if (!isOverlapping(minimum[otherAxisA], maximum[otherAxisA], cubeMinimum[otherAxisA], cubeMaximum[otherAxisA]) ||
+				!isOverlapping(minimum[otherAxisB], maximum[otherAxisB], cubeMinimum[otherAxisB], cubeMaximum[otherAxisB]))
+			{
+				continue;
+			}
+
+			//Cubes the box already overlaps are ignored so it can move back out of them
+			if (displacement[axis] > 0.0f && cubeMinimum[axis] >= maximum[axis] - COLLISION_EPSILON)
+			{
+				allowedDisplacement = std::min(allowedDisplacement, cubeMinimum[axis] - maximum[axis]);
+			}
+			else if (displacement[axis] < 0.0f && cubeMaximum[axis] <= minimum[axis] + COLLISION_EPSILON)
+			{
+				allowedDisplacement = std::max(allowedDisplacement, cubeMaximum[axis] - minimum[axis]);
+			}
+		}
+
+		if (allowedDisplacement != displacement[axis])
+		{
+			blockedAxes[axis] = true;
+			velocity[axis] = 0.0f;
+		}
+
+		position[axis] += allowedDisplacement;
+		minimum[axis] += allowedDisplacement;
+		maximum[axis] += allowedDisplacement;
 	}
 
-	if (chunkManager.isCubeAtPosition({ std::floor(collisionPosition.x),
-		std::floor(collisionPosition.y),
-		std::floor(collisionPosition.z) }, cubeType) &&
-		!Globals::NON_COLLIDABLE_CUBE_TYPES.isMatch(cubeType))
+	return blockedAxes;
+}
+
+bool CollisionHandler::isColliding(const glm::vec3& position, const glm::vec3& boxMinimum, const glm::vec3& boxMaximum, 
+	const ChunkManager& chunkManager)
+{
+	glm::vec3 minimum = position + boxMinimum;
+	glm::vec3 maximum = position + boxMaximum;
+	getCollidableCubes(minimum, maximum, chunkManager);
+	for (const auto& cube : collidableCubes)
 	{
-		velocity = 0.0f;
-		return true;
-		//Handle when getting stuck
+		glm::vec3 cubeMinimum(cube);
+		glm::vec3 cubeMaximum = cubeMinimum + glm::vec3(Globals::CUBE_FACE_SIZE);
+		if (isOverlapping(minimum.x, maximum.x, cubeMinimum.x, cubeMaximum.x) &&
+			isOverlapping(minimum.y, maximum.y, cubeMinimum.y, cubeMaximum.y) &&
+			isOverlapping(minimum.z, maximum.z, cubeMinimum.z, cubeMaximum.z))
+		{
+			return true;
+		}
 	}
 
 	return false;
 }
 
+bool CollisionHandler::isOnGround(const glm::vec3& position, const glm::vec3& boxMinimum, const glm::vec3& boxMaximum, 
+	const ChunkManager& chunkManager)
+{
+	return isColliding(position, { boxMinimum.x, boxMinimum.y - GROUND_DISTANCE, boxMinimum.z }, 
+		{ boxMaximum.x, boxMinimum.y, boxMaximum.z }, chunkManager);
+}
+
+
 bool CollisionHandler::isCollision(const glm::vec3& position, const ChunkManager& chunkManager)
+{
+	VoxelAccessor voxelAccessor(chunkManager);
+	return isCollision(position, voxelAccessor);
+}
+
+bool CollisionHandler::isCollision(const glm::vec3& position, const ChunkManager& chunkManager, eCubeType collidedCubeType)
+{
+	VoxelAccessor voxelAccessor(chunkManager);
+	return isCollision(position, voxelAccessor, collidedCubeType);
+}
+
+bool CollisionHandler::isCollision(const glm::vec3& position, VoxelAccessor& voxelAccessor)
 {
 	eCubeType cubeType = eCubeType::Air;
 
-	return chunkManager.isCubeAtPosition({ std::floor(position.x), std::floor(position.y), std::floor(position.z) }, cubeType) &&
-		!Globals::NON_COLLIDABLE_CUBE_TYPES.isMatch(cubeType);
+	return voxelAccessor.isCubeAtPosition({ std::floor(position.x), std::floor(position.y), std::floor(position.z) }, cubeType) &&
+		getCubeTypeProperties(cubeType).collidable;
 }
 
-bool CollisionHandler::isCollision(const glm::vec3& position, const ChunkManager& chunkManager, eCubeType collidedCubeType)
+bool CollisionHandler::isCollision(const glm::vec3& position, VoxelAccessor& voxelAccessor, eCubeType collidedCubeType)
 {
 	eCubeType cubeType;
-	if (chunkManager.isCubeAtPosition({ std::floor(position.x), std::floor(position.y), std::floor(position.z) }, cubeType))
+	if (voxelAccessor.isCubeAtPosition({ std::floor(position.x), std::floor(position.y), std::floor(position.z) }, cubeType))
 	{
 		return cubeType == collidedCubeType;
 	}
@@ -3,14 +3,23 @@
 #include "glm/glm.hpp"
 
 class ChunkManager;
+class VoxelAccessor;
 enum class eCubeType;
 namespace CollisionHandler
 {
-	bool handleXAxisCollision(float& velocity, float offset, const ChunkManager& chunkManager, const glm::vec3& position);
-	bool handleZAxisCollision(float& velocity, float offset, const ChunkManager& chunkManager, const glm::vec3& position);
+	//Moves a box - offsets from the position - by velocity * deltaTime against every collidable cube in its path
+	//Resolves y, then x, then z so the box stops flush against cubes however far it moves in a frame
+	//Velocity is zeroed on each blocked axis, which is returned
+	glm::bvec3 move(glm::vec3& position, glm::vec3& velocity, float deltaTime, 
+		const glm::vec3& boxMinimum, const glm::vec3& boxMaximum, const ChunkManager& chunkManager);
+	bool isColliding(const glm::vec3& position, const glm::vec3& boxMinimum, const glm::vec3& boxMaximum, const ChunkManager& chunkManager);
+	bool isOnGround(const glm::vec3& position, const glm::vec3& boxMinimum, const glm::vec3& boxMaximum, const ChunkManager& chunkManager);
 
 	bool isCollision(const glm::vec3& position, const ChunkManager& chunkManager);
 	bool isCollision(const glm::vec3& position, const ChunkManager& chunkManager, eCubeType collidedCubeType);
+	//For repeated probes around one spot - the accessor keeps the chunk between them
+	bool isCollision(const glm::vec3& position, VoxelAccessor& voxelAccessor);
+	bool isCollision(const glm::vec3& position, VoxelAccessor& voxelAccessor, eCubeType collidedCubeType);
 	void applyDrag(glm::vec3& velocity, float resistence);
 	void applyDrag(float& velocityX, float& velocityZ, float resistence);
 }
\ No newline at end of file
@@ -1,9 +1,6 @@
 #pragma once
 
-#include "NonCopyable.h"
-#include "NonMovable.h"
-#include <bitset>
-#include <vector>
+#include <array>
 
 enum class eCubeType
 {
@@ -23,35 +20,128 @@ enum class eCubeType
 	Max = TallGrass
 };
 
-class CubeTypeComparison : private NonCopyable, private NonMovable
+enum class eTerrainTextureLayer
 {
-public:
-	CubeTypeComparison(const std::vector<eCubeType>& cubeTypes)
-	{
-		for (auto cubeType : cubeTypes)
-		{
-			bitset.set(static_cast<int>(cubeType));
-		}
-	}
+	Grass = 0,
+	GrassSide,
+	Dirt,
+	Sand,
+	Stone,
+	Water,
+	Log,
+	LogTop,
+	Leaves,
+	Cactus,
+	CactusTop,
+	Shrub,
+	TallGrass,
+	Error,
+	Max = Error
+};
+
+enum class eCubeSide
+{
+	Front,
+	Back,
+	Left,
+	Right,
+	Top,
+	Bottom,
+	Total
+};
+
+enum class eCubeMeshType
+{
+	None = 0,
+	Cube,
+	Liquid,
+	Diagonal
+};
+
+struct CubeTypeProperties
+{
+	eCubeMeshType meshType;
+	bool opaque;
+	bool transparent;
+	bool collidable;
+	bool selectable;
+	bool destroyable;
+	bool collectable;
+	bool stackable; //Whether a cube can be placed on top
+	bool topFaceAlwaysVisible; //Top face is meshed even when covered by an opaque cube
+	float destroyTime; //Zero is destroyed instantly
+	eCubeType collectedCubeType;
+	eTerrainTextureLayer iconTextureLayer;
+	std::array<eTerrainTextureLayer, static_cast<int>(eCubeSide::Total)> textureLayers;
+};
+
+namespace CubeTypeRegistry
+{
+	constexpr float INSTANT_DESTROY_TIME = 0.0f;
+	constexpr float FAST_DESTROY_TIME = 0.35f;
+	constexpr float NORMAL_DESTROY_TIME = 0.75f;
+	constexpr float SLOW_DESTROY_TIME = 4.0f;
 
-	const std::bitset<static_cast<int>(eCubeType::Max) + 1>& getBitSet() const
+	constexpr std::array<eTerrainTextureLayer, static_cast<int>(eCubeSide::Total)> getTextureLayers(eTerrainTextureLayer textureLayer)
 	{
-		return bitset;
+		return { textureLayer, textureLayer, textureLayer, textureLayer, textureLayer, textureLayer };
 	}
 
-	bool isMatch(eCubeType cubeType) const
+	constexpr std::array<eTerrainTextureLayer, static_cast<int>(eCubeSide::Total)> getTextureLayers(eTerrainTextureLayer sideTextureLayer,
+		eTerrainTextureLayer topTextureLayer, eTerrainTextureLayer bottomTextureLayer)
 	{
-		std::bitset<static_cast<int>(eCubeType::Max) + 1> otherBitSet;
-		otherBitSet.set(static_cast<int>(cubeType));
-
-		return (bitset & otherBitSet).any();
+		return { sideTextureLayer, sideTextureLayer, sideTextureLayer, sideTextureLayer, topTextureLayer, bottomTextureLayer };
 	}
 
-	bool isMatch(const CubeTypeComparison& other) const
+	constexpr CubeTypeProperties getSolidCube(float destroyTime, eCubeType collectedCubeType, eTerrainTextureLayer iconTextureLayer,
+		const std::array<eTerrainTextureLayer, static_cast<int>(eCubeSide::Total)>& textureLayers, bool topFaceAlwaysVisible = false)
 	{
-		return (bitset & other.getBitSet()).any();
+		return { eCubeMeshType::Cube, true, false, true, true, true, true, true, topFaceAlwaysVisible, destroyTime, collectedCubeType,
+			iconTextureLayer, textureLayers };
 	}
+}
+
+//Every property of every cube type lives here - indexed by eCubeType
+inline const CubeTypeProperties& getCubeTypeProperties(eCubeType cubeType)
+{
+	using namespace CubeTypeRegistry;
+	static constexpr std::array<CubeTypeProperties, static_cast<int>(eCubeType::Max) + 1> CUBE_TYPE_PROPERTIES =
+	{{
+		//Air
+		{ eCubeMeshType::None, false, false, false, false, false, false, true, false, INSTANT_DESTROY_TIME,
+			eCubeType::Air, eTerrainTextureLayer::Error, getTextureLayers(eTerrainTextureLayer::Error) },
+		//Grass
+		getSolidCube(NORMAL_DESTROY_TIME, eCubeType::Grass, eTerrainTextureLayer::GrassSide,
+			getTextureLayers(eTerrainTextureLayer::GrassSide, eTerrainTextureLayer::Grass, eTerrainTextureLayer::Dirt)),
+		//Dirt
+		getSolidCube(NORMAL_DESTROY_TIME, eCubeType::Dirt, eTerrainTextureLayer::Dirt, getTextureLayers(eTerrainTextureLayer::Dirt)),
+		//Sand
+		getSolidCube(FAST_DESTROY_TIME, eCubeType::Sand, eTerrainTextureLayer::Sand, getTextureLayers(eTerrainTextureLayer::Sand)),
+		//Stone
+		getSolidCube(SLOW_DESTROY_TIME, eCubeType::Stone, eTerrainTextureLayer::Stone, getTextureLayers(eTerrainTextureLayer::Stone)),
+		//Water
+		{ eCubeMeshType::Liquid, false, true, false, false, false, false, false, false, INSTANT_DESTROY_TIME,
+			eCubeType::Air, eTerrainTextureLayer::Error, getTextureLayers(eTerrainTextureLayer::Water) },
+		//Log
+		getSolidCube(SLOW_DESTROY_TIME, eCubeType::Log, eTerrainTextureLayer::Log, getTextureLayers(eTerrainTextureLayer::Log)),
+		//LogTop
+		getSolidCube(SLOW_DESTROY_TIME, eCubeType::LogTop, eTerrainTextureLayer::LogTop,
+			getTextureLayers(eTerrainTextureLayer::Log, eTerrainTextureLayer::LogTop, eTerrainTextureLayer::Log), true),
+		//Leaves
+		{ eCubeMeshType::Cube, false, true, true, true, true, false, true, false, FAST_DESTROY_TIME,
+			eCubeType::Air, eTerrainTextureLayer::Error, getTextureLayers(eTerrainTextureLayer::Leaves) },
+		//Cactus
+		getSolidCube(FAST_DESTROY_TIME, eCubeType::Cactus, eTerrainTextureLayer::Cactus, getTextureLayers(eTerrainTextureLayer::Cactus)),
+		//CactusTop
+		getSolidCube(FAST_DESTROY_TIME, eCubeType::Cactus, eTerrainTextureLayer::Cactus,
+			getTextureLayers(eTerrainTextureLayer::Cactus, eTerrainTextureLayer::CactusTop, eTerrainTextureLayer::Cactus)),
+		//Shrub
+		{ eCubeMeshType::Diagonal, false, true, false, true, true, false, false, false, INSTANT_DESTROY_TIME,
+			eCubeType::Air, eTerrainTextureLayer::Error, getTextureLayers(eTerrainTextureLayer::Shrub) },
+		//TallGrass
+		{ eCubeMeshType::Diagonal, false, true, false, true, true, false, false, false, INSTANT_DESTROY_TIME,
+			eCubeType::Air, eTerrainTextureLayer::Error, getTextureLayers(eTerrainTextureLayer::TallGrass) }
+	}};
 
-private:
-	std::bitset<static_cast<int>(eCubeType::Max) + 1> bitset{ 0 };
-};
\ No newline at end of file
+	return CUBE_TYPE_PROPERTIES[static_cast<int>(cubeType)];
+}
\ No newline at end of file
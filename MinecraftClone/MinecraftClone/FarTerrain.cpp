@@ -0,0 +1,323 @@
+#include "FarTerrain.h"
+#include "Globals.h"
+#include "MemoryAccounting.h"
+#include "Rectangle.h"
+#include "ShaderHandler.h"
+#include "glad.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstddef>
+
+namespace
+{
+	constexpr int GRID_VERTEX_COUNT = FarTerrain::GRID_SIZE * FarTerrain::GRID_SIZE;
+	constexpr int MAX_GRID_INDEX_COUNT = FarTerrain::GRID_CELLS * FarTerrain::GRID_CELLS * 6;
+	//Leaves the heightmap under the outer ring of meshed chunks to cover the ones still being meshed as the player moves
+	constexpr int VISIBILITY_HOLE_MARGIN = Globals::CHUNK_WIDTH;
+
+	const glm::vec3 GRASS_COLOUR = { 0.38f, 0.58f, 0.24f };
+	const glm::vec3 SAND_COLOUR = { 0.86f, 0.81f, 0.6f };
+	const glm::vec3 WATER_COLOUR = { 0.22f, 0.36f, 0.78f };
+	constexpr float TOP_LIGHTING_INTENSITY = 1.0f;
+	constexpr float SIDE_LIGHTING_INTENSITY = 0.7f;
+
+	int getSpacing(int levelIndex)
+	{
+		return FarTerrain::BASE_SPACING << levelIndex;
+	}
+
+	int floorDivide(int value, int divisor)
+	{
+		return value >= 0 ? value / divisor : (value + 1) / divisor - 1;
+	}
+
+	int positiveModulo(int value, int divisor)
+	{
+		int remainder = value % divisor;
+		return remainder < 0 ? remainder + divisor : remainder;
+	}
+
+	int getSampleIndex(int gridX, int gridZ)
+	{
+		return positiveModulo(gridZ, FarTerrain::GRID_SIZE) * FarTerrain::GRID_SIZE + positiveModulo(gridX, FarTerrain::GRID_SIZE);
+	}
+
+	//Centred on an even cell so each level starts on a grid line of the level outside it
+	glm::ivec2 getLevelOrigin(int levelIndex, const glm::vec3& playerPosition)
+	{
+		int doubleSpacing = getSpacing(levelIndex) * 2;
+		glm::ivec2 centre(floorDivide(static_cast<int>(std::floor(playerPosition.x)), doubleSpacing) * 2,
+			floorDivide(static_cast<int>(std::floor(playerPosition.z)), doubleSpacing) * 2);
+
+		return centre - glm::ivec2(FarTerrain::GRID_CELLS / 2);
+	}
+
+	Rectangle getLevelRect(int levelIndex, const glm::ivec2& origin)
+	{
+		float spacing = static_cast<float>(getSpacing(levelIndex));
+		float halfExtent = spacing * FarTerrain::GRID_CELLS / 2.0f;
+		return { glm::vec2(origin) * spacing + glm::vec2(halfExtent), halfExtent };
+	}
+
+	bool isWater(int elevation)
+	{
+		return elevation < Globals::WATER_MAX_HEIGHT;
+	}
+
+	//Top of the highest cube in the column
+	float getSurfaceHeight(int elevation)
+	{
+		return static_cast<float>(std::max(elevation, Globals::WATER_MAX_HEIGHT) + 1);
+	}
+}
+
+FarTerrain::Level::Level()
+	: sampled(false),
+	origin(),
+	samples(GRID_VERTEX_COUNT),
+	vaoID(Globals::INVALID_OPENGL_ID),
+	vboID(Globals::INVALID_OPENGL_ID),
+	iboID(Globals::INVALID_OPENGL_ID),
+	indexCount(0)
+{}
+
+FarTerrain::FarTerrain()
+	: m_levels(),
+	m_vertices(),
+	m_indicies(),
+	m_CPUMemoryUsage(0),
+	m_GPUMemoryUsage(0)
+{
+	m_vertices.reserve(GRID_VERTEX_COUNT);
+	m_indicies.reserve(MAX_GRID_INDEX_COUNT);
+
+	for (auto& level : m_levels)
+	{
+		glGenVertexArrays(1, &level.vaoID);
+		glGenBuffers(1, &level.vboID);
+		glGenBuffers(1, &level.iboID);
+		glBindVertexArray(level.vaoID);
+
+		//Sized once up front - updates only overwrite
+		glBindBuffer(GL_ARRAY_BUFFER, level.vboID);
+		glBufferData(GL_ARRAY_BUFFER, GRID_VERTEX_COUNT * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, position));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, colour));
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, level.iboID);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, MAX_GRID_INDEX_COUNT * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW);
+
+		glBindVertexArray(0);
+	}
+
+	m_CPUMemoryUsage = LEVEL_COUNT * GRID_VERTEX_COUNT * sizeof(Sample) +
+		m_vertices.capacity() * sizeof(Vertex) + m_indicies.capacity() * sizeof(unsigned int);
+	m_GPUMemoryUsage = LEVEL_COUNT * (GRID_VERTEX_COUNT * sizeof(Vertex) + MAX_GRID_INDEX_COUNT * sizeof(unsigned int));
+	MemoryAccounting::onAllocate(eMemoryCategory::CPUMeshes, m_CPUMemoryUsage);
+	MemoryAccounting::onAllocate(eMemoryCategory::GPUMeshes, m_GPUMemoryUsage);
+	Metrics::getGauge("Far terrain CPU bytes").set(static_cast<int64_t>(m_CPUMemoryUsage));
+	Metrics::getGauge("Far terrain GPU bytes").set(static_cast<int64_t>(m_GPUMemoryUsage));
+}
+
+FarTerrain::~FarTerrain()
+{
+	for (auto& level : m_levels)
+	{
+		assert(level.vaoID != Globals::INVALID_OPENGL_ID);
+		glDeleteVertexArrays(1, &level.vaoID);
+
+		assert(level.vboID != Globals::INVALID_OPENGL_ID);
+		glDeleteBuffers(1, &level.vboID);
+
+		assert(level.iboID != Globals::INVALID_OPENGL_ID);
+		glDeleteBuffers(1, &level.iboID);
+	}
+
+	MemoryAccounting::onRelease(eMemoryCategory::CPUMeshes, m_CPUMemoryUsage);
+	MemoryAccounting::onRelease(eMemoryCategory::GPUMeshes, m_GPUMemoryUsage);
+	Metrics::getGauge("Far terrain CPU bytes").set(0);
+	Metrics::getGauge("Far terrain GPU bytes").set(0);
+}
+
+void FarTerrain::update(const glm::vec3& playerPosition)
+{
+	PROFILE_SCOPE("FarTerrain::update");
+	static MetricHistogram& levelUpdateTime = Metrics::getHistogram("Far terrain level update time (us)");
+	static MetricGauge& sampledPoints = Metrics::getGauge("Far terrain sampled points");
+	for (int levelIndex = 0; levelIndex < LEVEL_COUNT; ++levelIndex)
+	{
+		glm::ivec2 origin = getLevelOrigin(levelIndex, playerPosition);
+		if (m_levels[levelIndex].sampled && m_levels[levelIndex].origin == origin)
+		{
+			continue;
+		}
+
+		ScopedMetricTimer levelUpdateTimer(levelUpdateTime);
+		sampledPoints.set(sampleLevel(levelIndex, origin));
+		generateLevelVertices(levelIndex);
+		generateLevelIndicies(levelIndex);
+		//The level outside has a hole cut where this one sits
+		if (levelIndex + 1 < LEVEL_COUNT && m_levels[levelIndex + 1].sampled)
+		{
+			generateLevelIndicies(levelIndex + 1);
+		}
+		break;
+	}
+}
+
+void FarTerrain::render(ShaderHandler& shaderHandler, const glm::mat4& view, const glm::mat4& projection,
+	const glm::vec3& playerPosition, int visibilityDistance) const
+{
+	PROFILE_SCOPE("FarTerrain::render");
+	shaderHandler.switchToShader(eShaderType::FarTerrain);
+	shaderHandler.setUniformMat4f(eShaderType::FarTerrain, "uView", view);
+	shaderHandler.setUniformMat4f(eShaderType::FarTerrain, "uProjection", projection);
+
+	Rectangle visibilityHole = Globals::getVisibilityRect(playerPosition,
+		std::max(0, visibilityDistance - VISIBILITY_HOLE_MARGIN));
+	shaderHandler.setUniform4f(eShaderType::FarTerrain, "uVisibilityHole",
+		{ visibilityHole.m_left, visibilityHole.m_bottom, visibilityHole.m_right, visibilityHole.m_top });
+
+	int64_t drawCalls = 0;
+	int64_t indices = 0;
+	for (int levelIndex = 0; levelIndex < LEVEL_COUNT; ++levelIndex)
+	{
+		const Level& level = m_levels[levelIndex];
+		Rectangle levelRect = getLevelRect(levelIndex, level.origin);
+		bool insideVisibilityHole = levelRect.m_left >= visibilityHole.m_left && levelRect.m_right <= visibilityHole.m_right &&
+			levelRect.m_bottom >= visibilityHole.m_bottom && levelRect.m_top <= visibilityHole.m_top;
+
+		if (level.sampled && level.indexCount > 0 && !insideVisibilityHole)
+		{
+			glBindVertexArray(level.vaoID);
+			glDrawElements(GL_TRIANGLES, level.indexCount, GL_UNSIGNED_INT, nullptr);
+			++drawCalls;
+			indices += level.indexCount;
+		}
+	}
+
+	Metrics::addFrameDraws(drawCalls, indices);
+}
+
+int FarTerrain::sampleLevel(int levelIndex, const glm::ivec2& origin)
+{
+	Level& level = m_levels[levelIndex];
+	int spacing = getSpacing(levelIndex);
+	int sampledPoints = 0;
+	for (int z = origin.y; z < origin.y + GRID_SIZE; ++z)
+	{
+		bool sampledRow = level.sampled && z >= level.origin.y && z < level.origin.y + GRID_SIZE;
+		for (int x = origin.x; x < origin.x + GRID_SIZE; ++x)
+		{
+			if (sampledRow && x >= level.origin.x && x < level.origin.x + GRID_SIZE)
+			{
+				continue;
+			}
+
+			Sample& sample = level.samples[getSampleIndex(x, z)];
+			sample.elevation = TerrainNoise::getElevation(x * spacing, z * spacing);
+			sample.biomeType = TerrainNoise::getBiomeType(x * spacing, z * spacing);
+			++sampledPoints;
+		}
+	}
+
+	level.origin = origin;
+	level.sampled = true;
+
+	return sampledPoints;
+}
+
+void FarTerrain::generateLevelVertices(int levelIndex)
+{
+	const Level& level = m_levels[levelIndex];
+	float spacing = static_cast<float>(getSpacing(levelIndex));
+	auto getHeight = [&level](int x, int z)
+	{
+		x = glm::clamp(x, 0, GRID_CELLS);
+		z = glm::clamp(z, 0, GRID_CELLS);
+		return getSurfaceHeight(level.samples[getSampleIndex(level.origin.x + x, level.origin.y + z)].elevation);
+	};
+
+	m_vertices.clear();
+	for (int z = 0; z < GRID_SIZE; ++z)
+	{
+		for (int x = 0; x < GRID_SIZE; ++x)
+		{
+			const Sample& sample = level.samples[getSampleIndex(level.origin.x + x, level.origin.y + z)];
+			float height = getSurfaceHeight(sample.elevation);
+			//Odd vertices along the edge sit halfway along an edge of the level outside - match its straight line to avoid cracks
+			if ((z == 0 || z == GRID_CELLS) && x % 2 == 1)
+			{
+				height = (getHeight(x - 1, z) + getHeight(x + 1, z)) / 2.0f;
+			}
+			else if ((x == 0 || x == GRID_CELLS) && z % 2 == 1)
+			{
+				height = (getHeight(x, z - 1) + getHeight(x, z + 1)) / 2.0f;
+			}
+
+			glm::vec3 normal = glm::normalize(glm::vec3(getHeight(x - 1, z) - getHeight(x + 1, z), 2.0f * spacing,
+				getHeight(x, z - 1) - getHeight(x, z + 1)));
+			float lightIntensity = glm::mix(SIDE_LIGHTING_INTENSITY, TOP_LIGHTING_INTENSITY, normal.y);
+
+			glm::vec3 colour;
+			if (isWater(sample.elevation))
+			{
+				colour = WATER_COLOUR;
+			}
+			else
+			{
+				colour = (sample.biomeType == eBiomeType::Desert ? SAND_COLOUR : GRASS_COLOUR) * lightIntensity;
+			}
+
+			m_vertices.push_back({ glm::vec3((level.origin.x + x) * spacing, height, (level.origin.y + z) * spacing), colour });
+		}
+	}
+
+	assert(m_vertices.size() == GRID_VERTEX_COUNT);
+	glBindBuffer(GL_ARRAY_BUFFER, level.vboID);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, m_vertices.size() * sizeof(Vertex), m_vertices.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void FarTerrain::generateLevelIndicies(int levelIndex)
+{
+	Level& level = m_levels[levelIndex];
+
+	//Cells covered by the level inside this one - its edges lie on this level's grid lines
+	glm::ivec2 holeStart(GRID_CELLS);
+	glm::ivec2 holeEnd(GRID_CELLS);
+	if (levelIndex > 0 && m_levels[levelIndex - 1].sampled)
+	{
+		holeStart = m_levels[levelIndex - 1].origin / 2 - level.origin;
+		holeEnd = holeStart + glm::ivec2(GRID_CELLS / 2);
+	}
+
+	m_indicies.clear();
+	for (int z = 0; z < GRID_CELLS; ++z)
+	{
+		for (int x = 0; x < GRID_CELLS; ++x)
+		{
+			if (x >= holeStart.x && x < holeEnd.x && z >= holeStart.y && z < holeEnd.y)
+			{
+				continue;
+			}
+
+			unsigned int index = z * GRID_SIZE + x;
+			m_indicies.push_back(index);
+			m_indicies.push_back(index + GRID_SIZE);
+			m_indicies.push_back(index + 1);
+			m_indicies.push_back(index + 1);
+			m_indicies.push_back(index + GRID_SIZE);
+			m_indicies.push_back(index + GRID_SIZE + 1);
+		}
+	}
+
+	level.indexCount = static_cast<int>(m_indicies.size());
+	glBindVertexArray(level.vaoID);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, m_indicies.size() * sizeof(unsigned int), m_indicies.data());
+	glBindVertexArray(0);
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "NonCopyable.h"
+#include "NonMovable.h"
+#include "TerrainNoise.h"
+#include "glm/glm.hpp"
+#include <array>
+#include <vector>
+
+//Heightmap of the terrain out past the loaded chunks
+//Geometry clipmap - nested grids centred on the player, each level twice the spacing of the one inside it
+class ShaderHandler;
+class FarTerrain : private NonCopyable, private NonMovable
+{
+public:
+	static constexpr int LEVEL_COUNT = 5;
+	static constexpr int GRID_CELLS = 64;
+	static constexpr int GRID_SIZE = GRID_CELLS + 1;
+	static constexpr int BASE_SPACING = 16;
+
+	FarTerrain();
+	~FarTerrain();
+
+	//Resamples at most one level a frame - only the rows and columns the player has moved onto
+	void update(const glm::vec3& playerPosition);
+	//Only fills pixels the opaque chunks left in the stencil buffer
+	void render(ShaderHandler& shaderHandler, const glm::mat4& view, const glm::mat4& projection,
+		const glm::vec3& playerPosition, int visibilityDistance) const;
+
+private:
+	struct Sample
+	{
+		int elevation;
+		eBiomeType biomeType;
+	};
+
+	struct Vertex
+	{
+		glm::vec3 position;
+		glm::vec3 colour;
+	};
+
+	struct Level
+	{
+		Level();
+
+		bool sampled;
+		//In grid cells of the level's spacing
+		glm::ivec2 origin;
+		//Stored toroidally by world grid position so moving only overwrites the rows and columns left behind
+		std::vector<Sample> samples;
+		unsigned int vaoID;
+		unsigned int vboID;
+		unsigned int iboID;
+		int indexCount;
+	};
+
+	std::array<Level, LEVEL_COUNT> m_levels;
+	std::vector<Vertex> m_vertices;
+	std::vector<unsigned int> m_indicies;
+	size_t m_CPUMemoryUsage;
+	size_t m_GPUMemoryUsage;
+
+	int sampleLevel(int levelIndex, const glm::ivec2& origin);
+	void generateLevelVertices(int levelIndex);
+	void generateLevelIndicies(int levelIndex);
+};
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "GPUTimer.h"
+#include "glad.h"
+#include "Metrics.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <string>
+#include <assert.h>
+
+namespace
+{
+	constexpr std::array<const char*, GPUTimer::RENDER_PASS_COUNT> RENDER_PASS_NAMES =
+	{
+		"GPU opaque chunks",
+		"GPU pickups",
+		"GPU far terrain",
+		"GPU transparent chunks",
+		"GPU player visuals",
+		"GPU skybox",
+		"GPU GUI"
+	};
+}
+
+GPUTimer::GPUTimer()
+	: m_queries(),
+	m_frame(0),
+	m_queryActive(false),
+	m_renderPassTimes(),
+	m_frameTime(Metrics::getHistogram("GPU frame time (us)")),
+	m_droppedResults(Metrics::getCounter("GPU timer results dropped")),
+	m_profileTrack(Profiler::createTrack("GPU")),
+	m_profileTrackTime(0)
+{
+	for (auto& frameQueries : m_queries)
+	{
+		for (auto& query : frameQueries)
+		{
+			glGenQueries(1, &query.ID);
+		}
+	}
+
+	for (size_t i = 0; i < RENDER_PASS_COUNT; ++i)
+	{
+		m_renderPassTimes[i] = &Metrics::getHistogram(std::string(RENDER_PASS_NAMES[i]) + " (us)");
+	}
+}
+
+GPUTimer::~GPUTimer()
+{
+	for (auto& frameQueries : m_queries)
+	{
+		for (auto& query : frameQueries)
+		{
+			glDeleteQueries(1, &query.ID);
+		}
+	}
+}
+
+void GPUTimer::begin(eRenderPass renderPass)
+{
+	assert(!m_queryActive);
+	Query& query = m_queries[m_frame][static_cast<size_t>(renderPass)];
+	//Still waiting from FRAMES_IN_FLIGHT frames ago - the GPU is that far behind so the result is given up on
+	int64_t duration = 0;
+	if (query.pending && !readBack(renderPass, query, duration))
+	{
+		query.pending = false;
+		m_droppedResults.add();
+	}
+
+	query.submitTime = Profiler::getTime();
+	glBeginQuery(GL_TIME_ELAPSED, query.ID);
+	m_queryActive = true;
+}
+
+void GPUTimer::end(eRenderPass renderPass)
+{
+	assert(m_queryActive);
+	glEndQuery(GL_TIME_ELAPSED);
+	m_queries[m_frame][static_cast<size_t>(renderPass)].pending = true;
+	m_queryActive = false;
+}
+
+void GPUTimer::endFrame()
+{
+	assert(!m_queryActive);
+	m_frame = (m_frame + 1) % FRAMES_IN_FLIGHT;
+	readBackFrame(m_frame);
+}
+
+bool GPUTimer::readBack(eRenderPass renderPass, Query& query, int64_t& duration)
+{
+	assert(query.pending);
+	GLint available = GL_FALSE;
+	glGetQueryObjectiv(query.ID, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available == GL_FALSE)
+	{
+		return false;
+	}
+
+	GLuint64 elapsedTime = 0;
+	glGetQueryObjectui64v(query.ID, GL_QUERY_RESULT, &elapsedTime);
+	query.pending = false;
+
+	duration = static_cast<int64_t>(elapsedTime / 1000);
+	m_renderPassTimes[static_cast<size_t>(renderPass)]->record(duration);
+
+#if PROFILING_ENABLED
+	//Only durations are known - passes are laid out from when they were submitted without overlapping the previous pass
+	int64_t startTime = std::max(query.submitTime, m_profileTrackTime);
+	m_profileTrackTime = startTime + duration;
+	Profiler::recordScope(m_profileTrack, RENDER_PASS_NAMES[static_cast<size_t>(renderPass)], startTime, m_profileTrackTime);
+#endif // PROFILING_ENABLED
+
+	return true;
+}
+
+//Passes are read in render order so the profile track stays in order
+//The frame time is only known once every pass of the frame has been read
+void GPUTimer::readBackFrame(size_t frame)
+{
+	int64_t frameTime = 0;
+	bool frameComplete = true;
+	for (size_t i = 0; i < RENDER_PASS_COUNT; ++i)
+	{
+		Query& query = m_queries[frame][i];
+		if (!query.pending)
+		{
+			continue;
+		}
+
+		int64_t duration = 0;
+		if (readBack(static_cast<eRenderPass>(i), query, duration))
+		{
+			frameTime += duration;
+		}
+		else
+		{
+			frameComplete = false;
+		}
+	}
+
+	if (frameComplete && frameTime > 0)
+	{
+		m_frameTime.record(frameTime);
+	}
+}
\ No newline at end of file
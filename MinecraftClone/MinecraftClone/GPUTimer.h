@@ -0,0 +1,84 @@
+#pragma once
+
+#include "NonCopyable.h"
+#include "NonMovable.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+//In the order they're rendered
+enum class eRenderPass
+{
+	OpaqueChunks = 0,
+	Pickups,
+	FarTerrain,
+	TransparentChunks,
+	PlayerVisuals,
+	Skybox,
+	Gui,
+	Max = Gui
+};
+
+class MetricHistogram;
+class MetricCounter;
+namespace Profiler
+{
+	struct ProfileTrack;
+}
+//Times every render pass on the GPU with GL_TIME_ELAPSED queries
+//Each pass has a query per frame in flight - a query is only read once its result is available so the CPU never waits on the GPU
+//Time elapsed queries can't overlap so passes can't be nested
+class GPUTimer : private NonCopyable, private NonMovable
+{
+public:
+	static constexpr size_t FRAMES_IN_FLIGHT = 2;
+	static constexpr size_t RENDER_PASS_COUNT = static_cast<size_t>(eRenderPass::Max) + 1;
+
+	GPUTimer();
+	~GPUTimer();
+
+	void begin(eRenderPass renderPass);
+	void end(eRenderPass renderPass);
+	//Called once every pass of the frame has ended - reads back the previous frame
+	void endFrame();
+
+private:
+	struct Query
+	{
+		unsigned int ID = 0;
+		bool pending = false;
+		int64_t submitTime = 0;
+	};
+
+	std::array<std::array<Query, RENDER_PASS_COUNT>, FRAMES_IN_FLIGHT> m_queries;
+	size_t m_frame;
+	bool m_queryActive;
+	std::array<MetricHistogram*, RENDER_PASS_COUNT> m_renderPassTimes;
+	MetricHistogram& m_frameTime;
+	MetricCounter& m_droppedResults;
+	Profiler::ProfileTrack& m_profileTrack;
+	int64_t m_profileTrackTime;
+
+	bool readBack(eRenderPass renderPass, Query& query, int64_t& duration);
+	void readBackFrame(size_t frame);
+};
+
+class ScopedGPUTimer : private NonCopyable, private NonMovable
+{
+public:
+	ScopedGPUTimer(GPUTimer& timer, eRenderPass renderPass)
+		: m_timer(timer),
+		m_renderPass(renderPass)
+	{
+		m_timer.begin(m_renderPass);
+	}
+
+	~ScopedGPUTimer()
+	{
+		m_timer.end(m_renderPass);
+	}
+
+private:
+	GPUTimer& m_timer;
+	const eRenderPass m_renderPass;
+};
\ No newline at end of file
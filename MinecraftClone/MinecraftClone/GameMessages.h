@@ -18,7 +18,11 @@ namespace GameMessages
 		const glm::vec3 initialVelocity;
 	};
 
-	struct AddToInventory { const eCubeType type; };
+	struct AddToInventory
+	{
+		const eCubeType type;
+		const int quantity;
+	};
 
 	struct AddItemGUI
 	{
@@ -6,10 +6,141 @@
 #include <vector>
 #include <assert.h>
 #include <array>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <type_traits>
 
+//Counters for a message type's deferred queue - safe to read from any thread
+struct MessageQueueStats
+{
+	size_t depth = 0;
+	size_t capacity = 0;
+	uint64_t queued = 0;
+	uint64_t delivered = 0;
+	//Queued while the queue was full and thrown away
+	uint64_t dropped = 0;
+};
+
+//Every message type with a deferred queue, so the main loop can deliver them all in one place
+//Linked lock-free as messengers are first used from whichever thread gets there first - entries are never removed
+struct QueuedMessageDelivery
+{
+	void(*deliver)();
+	MessageQueueStats(*getStats)();
+	QueuedMessageDelivery* next;
+};
+
+inline std::atomic<QueuedMessageDelivery*>& getQueuedMessageDeliveries()
+{
+	static std::atomic<QueuedMessageDelivery*> queuedMessageDeliveries(nullptr);
+	return queuedMessageDeliveries;
+}
+
+//Bounded multiple producer, single consumer ring - each slot's sequence says whose turn it is to use it
+//Producers claim slots with a compare exchange and never wait on each other or the consumer
+template <typename Message, size_t Capacity>
+class MessageRing : private NonCopyable, private NonMovable
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		typename std::aligned_storage<sizeof(Message), alignof(Message)>::type message;
+	};
+
+public:
+	MessageRing()
+		: m_slots(),
+		m_writePosition(0),
+		m_readPosition(0)
+	{
+		for (size_t i = 0; i < Capacity; ++i)
+		{
+			m_slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	~MessageRing()
+	{
+		while (pop([](const Message&) {}))
+		{}
+	}
+
+	size_t getDepth() const
+	{
+		size_t writePosition = m_writePosition.load(std::memory_order_relaxed);
+		size_t readPosition = m_readPosition.load(std::memory_order_relaxed);
+		return writePosition > readPosition ? std::min(writePosition - readPosition, Capacity) : 0;
+	}
+
+	//Any thread
+	bool push(const Message& message)
+	{
+		size_t writePosition = m_writePosition.load(std::memory_order_relaxed);
+		Slot* slot = nullptr;
+		for (;;)
+		{
+			slot = &m_slots[writePosition & (Capacity - 1)];
+			size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(writePosition);
+			if (difference == 0)
+			{
+				if (m_writePosition.compare_exchange_weak(writePosition, writePosition + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				writePosition = m_writePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		new (&slot->message) Message(message);
+		slot->sequence.store(writePosition + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Consumer thread only
+	template <typename Consumer>
+	bool pop(Consumer&& consumer)
+	{
+		size_t readPosition = m_readPosition.load(std::memory_order_relaxed);
+		Slot& slot = m_slots[readPosition & (Capacity - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != readPosition + 1)
+		{
+			return false;
+		}
+
+		Message* message = reinterpret_cast<Message*>(&slot.message);
+		consumer(*message);
+		message->~Message();
+		slot.sequence.store(readPosition + Capacity, std::memory_order_release);
+		m_readPosition.store(readPosition + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+private:
+	std::array<Slot, Capacity> m_slots;
+	alignas(64) std::atomic<size_t> m_writePosition;
+	alignas(64) std::atomic<size_t> m_readPosition;
+};
+
+//Immediate - broadcast calls every listener there and then, on the calling thread
+//Deferred - queue can be called from any thread and the messages reach the listeners when the main loop calls deliverQueuedMessages
+//Listeners are only ever called, subscribed and unsubscribed on the main thread
 template <typename Message>
 class GameMessenger : private NonCopyable, private NonMovable
 {
+	static constexpr size_t QUEUE_CAPACITY = 256;
+
 	struct Listener
 	{ 
 		Listener(const std::function<void(const Message&)>& callback, const void* ownerAddress)
@@ -54,10 +185,63 @@ public:
 		}
 	}
 
+	void queue(const Message& message)
+	{
+		if (m_queuedMessages.push(message))
+		{
+			m_queuedCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	//Messages queued by the listeners themselves wait for the next delivery
+	void deliverQueued()
+	{
+		for (size_t i = m_queuedMessages.getDepth(); i > 0 && m_queuedMessages.pop([this](const Message& message) { broadcast(message); }); --i)
+		{
+			m_deliveredCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	MessageQueueStats getQueueStats() const
+	{
+		MessageQueueStats stats;
+		stats.depth = m_queuedMessages.getDepth();
+		stats.capacity = QUEUE_CAPACITY;
+		stats.queued = m_queuedCount.load(std::memory_order_relaxed);
+		stats.delivered = m_deliveredCount.load(std::memory_order_relaxed);
+		stats.dropped = m_droppedCount.load(std::memory_order_relaxed);
+
+		return stats;
+	}
+
 private:
-	GameMessenger() {}
+	GameMessenger()
+		: m_listeners(),
+		m_queuedMessages(),
+		m_queuedCount(0),
+		m_deliveredCount(0),
+		m_droppedCount(0),
+		m_queuedMessageDelivery()
+	{
+		m_queuedMessageDelivery.deliver = []() { getInstance().deliverQueued(); };
+		m_queuedMessageDelivery.getStats = []() { return getInstance().getQueueStats(); };
+		std::atomic<QueuedMessageDelivery*>& queuedMessageDeliveries = getQueuedMessageDeliveries();
+		m_queuedMessageDelivery.next = queuedMessageDeliveries.load(std::memory_order_relaxed);
+		while (!queuedMessageDeliveries.compare_exchange_weak(m_queuedMessageDelivery.next, &m_queuedMessageDelivery,
+			std::memory_order_release, std::memory_order_relaxed))
+		{}
+	}
 
 	std::vector<Listener> m_listeners;
+	MessageRing<Message, QUEUE_CAPACITY> m_queuedMessages;
+	std::atomic<uint64_t> m_queuedCount;
+	std::atomic<uint64_t> m_deliveredCount;
+	std::atomic<uint64_t> m_droppedCount;
+	QueuedMessageDelivery m_queuedMessageDelivery;
 
 	bool isRegistered(const void* ownerAddress) const
 	{
@@ -86,4 +270,37 @@ template <typename Message>
 void broadcastToMessenger(const Message& message)
 {
 	GameMessenger<Message>::getInstance().broadcast(message);
+}
+
+template <typename Message>
+void queueToMessenger(const Message& message)
+{
+	GameMessenger<Message>::getInstance().queue(message);
+}
+
+//Main thread - hands every queued message of every type to its listeners
+inline void deliverQueuedMessages()
+{
+	for (QueuedMessageDelivery* queuedMessageDelivery = getQueuedMessageDeliveries().load(std::memory_order_acquire); 
+		queuedMessageDelivery; queuedMessageDelivery = queuedMessageDelivery->next)
+	{
+		queuedMessageDelivery->deliver();
+	}
+}
+
+inline MessageQueueStats getQueuedMessageStats()
+{
+	MessageQueueStats totalStats;
+	for (QueuedMessageDelivery* queuedMessageDelivery = getQueuedMessageDeliveries().load(std::memory_order_acquire);
+		queuedMessageDelivery; queuedMessageDelivery = queuedMessageDelivery->next)
+	{
+		MessageQueueStats stats = queuedMessageDelivery->getStats();
+		totalStats.depth += stats.depth;
+		totalStats.capacity += stats.capacity;
+		totalStats.queued += stats.queued;
+		totalStats.delivered += stats.delivered;
+		totalStats.dropped += stats.dropped;
+	}
+
+	return totalStats;
 }
\ No newline at end of file
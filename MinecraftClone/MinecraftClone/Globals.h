@@ -36,42 +36,12 @@ enum class eInventoryIndex
 	Max = Nine
 };
 
-enum class eTerrainTextureLayer
-{
-	Grass = 0,
-	GrassSide,
-	Dirt,
-	Sand,
-	Stone,
-	Water,
-	Log,
-	LogTop,
-	Leaves,
-	Cactus,
-	CactusTop,
-	Shrub,
-	TallGrass,
-	Error,
-	Max = Error
-};
-
 enum class eGuiTextureLayer
 {
 	InventoryBar,
 	Selected
 };
 
-enum class eCubeSide
-{
-	Front,
-	Back,
-	Left,
-	Right,
-	Top,
-	Bottom,
-	Total
-};
-
 enum class eDirection
 {
 	Left,
@@ -102,7 +72,6 @@ namespace Globals
 	constexpr int MAX_TREE_HEIGHT = 12;
 	constexpr int CACTUS_MIN_HEIGHT = 1;
 	constexpr int CACTUS_MAX_HEIGHT = 4;
-	constexpr int MAX_TREE_PER_CHUNK = 3;
 	constexpr int MAX_CACTUS_PER_CHUNK = 1;
 	
 	constexpr int MAX_SHRUB_PER_CHUNK = 3;
@@ -110,7 +79,7 @@ namespace Globals
 	constexpr int MAX_PLANT_SPAWN_ATTEMPTS = 20;
 	constexpr int MAX_CACTUS_SPAWN_ATTEMPTS = 20;
 	constexpr int MAX_TREE_SPAWN_ATTEMPTS = 5;
-	constexpr int CHANCE_TREE_SPAWN_IN_CHUNK = 50;
+	constexpr int CHANCE_TREE_SPAWN = 50;
 
 	constexpr unsigned int INVALID_OPENGL_ID = 0;
 
@@ -126,33 +95,6 @@ namespace Globals
 	constexpr float PICKUP_CUBE_FACE_SIZE = 0.25f;
 	constexpr float CUBE_FACE_SIZE = 1.0f;
 
-	const CubeTypeComparison TRANSPARENT_CUBE_TYPES =
-	{
-		{eCubeType::Water,
-		eCubeType::Leaves,
-		eCubeType::Shrub,
-		eCubeType::TallGrass}
-	};
-
-	const CubeTypeComparison OPAQUE_CUBE_TYPES =
-	{
-		{eCubeType::Grass,
-		eCubeType::Dirt,
-		eCubeType::Sand,
-		eCubeType::Stone,
-		eCubeType::Log,
-		eCubeType::LogTop,
-		eCubeType::Cactus,
-		eCubeType::CactusTop}
-	};
-
-	const CubeTypeComparison NON_COLLIDABLE_CUBE_TYPES =
-	{
-		{eCubeType::Water,
-		eCubeType::TallGrass,
-		eCubeType::Shrub}
-	};
-
 	inline int getRandomNumber(int min, int max)
 	{
 		static std::random_device rd;  //Will be used to obtain a seed for the random number engine
@@ -209,15 +151,26 @@ namespace Globals
 	//384 Dev Distance
 	//Normal Distance = 864
 	//Far Distance = 1024
-	constexpr int VISIBILITY_DISTANCE = 1024;
+	constexpr int MIN_VISIBILITY_DISTANCE = 256;
+	constexpr int MAX_VISIBILITY_DISTANCE = 1024;
+	constexpr int DEFAULT_VISIBILITY_DISTANCE = 1024;
+	//Chunk meshes drop to the next level of detail every this many blocks away from the player
+	constexpr int CHUNK_MESH_LOD_DISTANCE = 256;
+	constexpr float AUTO_VISIBILITY_TARGET_FRAME_TIME = 1.0f / 60.0f;
+	constexpr float METRICS_DUMP_INTERVAL = 1.0f;
+	constexpr float METRICS_OVERLAY_INTERVAL = 0.25f;
+	//Lock call sites with the longest total wait shown on the metrics overlay
+	constexpr size_t MOST_CONTENDED_LOCK_SITES = 5;
+	//Voxel and mesh bytes chunks are evicted to stay within - auto visibility distance stops growing short of it too
+	constexpr size_t DEFAULT_MEMORY_BUDGET = 2048ull * 1024u * 1024u;
 	constexpr int MAP_SIZE = 8000;
 	const std::string TEXTURE_DIRECTORY = "Textures/";
 	const std::string FONTS_DIRECTORY = "Fonts/";
 	constexpr glm::ivec3 PLAYER_STARTING_POSITION = { 0.0f, 0.0f, 0.0f };
 
-	inline Rectangle getVisibilityRect(const glm::vec3& position)
+	inline Rectangle getVisibilityRect(const glm::vec3& position, int visibilityDistance)
 	{
 		glm::ivec3 startingPosition = Globals::getClosestMiddlePosition(position);
-		return { glm::vec2(startingPosition.x, startingPosition.z), Globals::VISIBILITY_DISTANCE };
+		return { glm::vec2(startingPosition.x, startingPosition.z), static_cast<float>(visibilityDistance) };
 	}
 }
\ No newline at end of file
@@ -22,6 +22,13 @@ namespace
 	constexpr glm::ivec2 FONT_TEXTURE_TILESIZE = { 32, 32 };
 	constexpr glm::ivec2 FONT_TEXTURE_SIZE = { 256, 256 };
 	constexpr glm::ivec2 ITEM_SIZE = { 36, 36 };
+	//The font texture holds ASCII from the space up to the underscore
+	constexpr char FIRST_FONT_CHARACTER = ' ';
+	constexpr char LAST_FONT_CHARACTER = '_';
+
+	constexpr int METRICS_OVERLAY_TEXT_SIZE = 36;
+	constexpr int METRICS_OVERLAY_LINE_SPACING = METRICS_OVERLAY_TEXT_SIZE * 4 / 9;
+	constexpr glm::ivec2 METRICS_OVERLAY_POSITION = { 8, 12 };
 
 	constexpr glm::ivec2 TOOLBAR_SIZE = { 580, 60 };
 	constexpr glm::ivec2 SELECTION_BOX_SIZE = { 66, 60 };
@@ -108,40 +115,6 @@ namespace
 		glm::vec2(0.0f, .823f)
 	};
 
-	eTerrainTextureLayer getTextureLayer(eCubeType cubeType)
-	{
-		eTerrainTextureLayer textureLayer = eTerrainTextureLayer::Error;
-		switch (cubeType)
-		{
-		case eCubeType::Grass:
-			textureLayer = eTerrainTextureLayer::GrassSide;
-			break;
-		case eCubeType::Cactus:
-		case eCubeType::CactusTop:
-			textureLayer = eTerrainTextureLayer::Cactus;
-			break;
-		case eCubeType::Dirt:
-			textureLayer = eTerrainTextureLayer::Dirt;
-			break;
-		case eCubeType::Sand:
-			textureLayer = eTerrainTextureLayer::Sand;
-			break;
-		case eCubeType::Log:
-			textureLayer = eTerrainTextureLayer::Log;
-			break;
-		case eCubeType::LogTop:
-			textureLayer = eTerrainTextureLayer::LogTop;
-			break;
-		case eCubeType::Stone:
-			textureLayer = eTerrainTextureLayer::Stone;
-			break;
-		default:
-			assert(false);
-		}
-
-		return textureLayer;
-	}
-
 	glm::vec2 getPositionOnHotbar(eInventoryIndex hotbarIndex, glm::ivec2 basePosition, float offsetX)
 	{
 		glm::vec2 position = basePosition;
@@ -352,6 +325,38 @@ void Text::setText(int number, const std::unordered_map<char, int>& characterIDM
 	setText(positions, textCoords);
 }
 
+void Text::setText(const std::string& text, const std::unordered_map<char, int>& characterIDMap, int textSize)
+{
+	assert(!text.empty());
+
+	std::vector<glm::vec2> positions;
+	std::vector<glm::vec2> textCoords;
+	positions.reserve(text.size() * 6);
+	textCoords.reserve(text.size() * 6);
+
+	glm::vec2 position(m_position.x + textSize / 2, m_position.y);
+	for (char character : text)
+	{
+		auto characterID = characterIDMap.find(character);
+		if (characterID == characterIDMap.cend())
+		{
+			characterID = characterIDMap.find('?');
+			assert(characterID != characterIDMap.cend());
+		}
+
+		std::array<glm::vec2, 6> quadCoords = getQuadCoords(position, textSize, textSize);
+		positions.insert(positions.end(), quadCoords.cbegin(), quadCoords.cend());
+
+		std::array<glm::vec2, 6> characterTextCoords =
+			getCharacterTextCoords(convertTo2DTextCoord(characterID->second, FONT_TEXTURE_TILESIZE, FONT_TEXTURE_COLUMNS, FONT_TEXTURE_SIZE), FONT_TEXTURE_COLUMNS);
+		textCoords.insert(textCoords.end(), characterTextCoords.cbegin(), characterTextCoords.cend());
+
+		position.x += textSize / 3;
+	}
+
+	setText(positions, textCoords);
+}
+
 void Text::render() const
 {
 	if (m_active)
@@ -423,6 +428,8 @@ Gui::Gui(const glm::uvec2& windowSize)
 	: m_items(),
 	m_itemQuantityText(),
 	m_characterIDMap(),
+	m_metricsOverlayText(),
+	m_metricsOverlayActive(false),
 	m_toolbar(),
 	m_selectionBox()
 {
@@ -449,16 +456,15 @@ Gui::Gui(const glm::uvec2& windowSize)
 	m_selectionBox.setTextureRect(selectionBoxTextCoords);
 	m_selectionBox.setActive(true);
 
-	m_characterIDMap.insert({ '0', 16 });
-	m_characterIDMap.insert({ '1', 17 });
-	m_characterIDMap.insert({ '2', 18 });
-	m_characterIDMap.insert({ '3', 19 });
-	m_characterIDMap.insert({ '4', 20 });
-	m_characterIDMap.insert({ '5', 21 });
-	m_characterIDMap.insert({ '6', 22 });
-	m_characterIDMap.insert({ '7', 23 });
-	m_characterIDMap.insert({ '8', 24 });
-	m_characterIDMap.insert({ '9', 25 });
+	for (char character = FIRST_FONT_CHARACTER; character <= LAST_FONT_CHARACTER; ++character)
+	{
+		m_characterIDMap.insert({ character, static_cast<int>(character - FIRST_FONT_CHARACTER) });
+	}
+	//No lower case in the font
+	for (char character = 'a'; character <= 'z'; ++character)
+	{
+		m_characterIDMap.insert({ character, static_cast<int>(character - 'a' + 'A' - FIRST_FONT_CHARACTER) });
+	}
 
 	subscribeToMessenger<GameMessages::AddItemGUI>([this](const GameMessages::AddItemGUI& gameMessage) { return onAddItem(gameMessage); }, this);
 	subscribeToMessenger<GameMessages::RemoveItemGUI>([this](const GameMessages::RemoveItemGUI& gameMessage) { return onRemoveItem(gameMessage); }, this);
@@ -499,14 +505,56 @@ void Gui::render(ShaderHandler& shaderHandler, const Texture& widgetTexture, con
 	{
 		text.render();
 	}
+
+	if (m_metricsOverlayActive)
+	{
+		for (const auto& text : m_metricsOverlayText)
+		{
+			text.render();
+		}
+	}
 	
 	glEnable(GL_DEPTH_TEST);
 }
 
+bool Gui::isMetricsOverlayActive() const
+{
+	return m_metricsOverlayActive;
+}
+
+void Gui::setMetricsOverlayActive(bool active)
+{
+	m_metricsOverlayActive = active;
+}
+
+void Gui::setMetricsOverlayText(const std::vector<std::string>& lines)
+{
+	while (m_metricsOverlayText.size() < lines.size())
+	{
+		m_metricsOverlayText.emplace_back();
+		m_metricsOverlayText.back().setPosition({ METRICS_OVERLAY_POSITION.x,
+			METRICS_OVERLAY_POSITION.y + METRICS_OVERLAY_LINE_SPACING * static_cast<int>(m_metricsOverlayText.size() - 1) });
+	}
+
+	for (size_t i = 0; i < m_metricsOverlayText.size(); ++i)
+	{
+		if (i < lines.size() && !lines[i].empty())
+		{
+			m_metricsOverlayText[i].setText(lines[i], m_characterIDMap, METRICS_OVERLAY_TEXT_SIZE);
+			m_metricsOverlayText[i].setActive(true);
+		}
+		else
+		{
+			m_metricsOverlayText[i].setActive(false);
+		}
+	}
+}
+
 void Gui::onAddItem(const GameMessages::AddItemGUI& gameMessage)
 {
-	assert(!m_items[static_cast<int>(gameMessage.index)].isActive());
-	m_items[static_cast<int>(gameMessage.index)].setTextureRect(getTextCoords(getTextureLayer(gameMessage.type)));
+	assert(!m_items[static_cast<int>(gameMessage.index)].isActive() &&
+		getCubeTypeProperties(gameMessage.type).iconTextureLayer != eTerrainTextureLayer::Error);
+	m_items[static_cast<int>(gameMessage.index)].setTextureRect(getTextCoords(getCubeTypeProperties(gameMessage.type).iconTextureLayer));
 	m_items[static_cast<int>(gameMessage.index)].setActive(true);
 }
 
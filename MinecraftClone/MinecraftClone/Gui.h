@@ -4,6 +4,7 @@
 #include "NonMovable.h"
 #include "Globals.h"
 #include "glm/glm.hpp"
+#include <string>
 #include <vector>
 #include <unordered_map>
 
@@ -38,6 +39,8 @@ public:
 
 	void setPosition(const glm::vec2& position);
 	void setText(int number, const std::unordered_map<char, int>& characterIDMap);
+	//Position is the middle of the left edge of the first character
+	void setText(const std::string& text, const std::unordered_map<char, int>& characterIDMap, int textSize);
 	void render() const override;
 
 private:
@@ -76,10 +79,16 @@ public:
 
 	void render(ShaderHandler& shaderHandler, const Texture& widgetTexture, const Texture& fontTexture) const;
 
+	bool isMetricsOverlayActive() const;
+	void setMetricsOverlayActive(bool active);
+	void setMetricsOverlayText(const std::vector<std::string>& lines);
+
 private:
 	std::array<Image, static_cast<size_t>(eInventoryIndex::Max) + 1> m_items;
 	std::array<Text, static_cast<size_t>(eInventoryIndex::Max) + 1> m_itemQuantityText;
 	std::unordered_map<char, int> m_characterIDMap;
+	std::vector<Text> m_metricsOverlayText;
+	bool m_metricsOverlayActive;
 
 	Image m_toolbar;
 	Image m_selectionBox;
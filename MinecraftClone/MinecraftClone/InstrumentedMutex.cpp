@@ -0,0 +1,172 @@
+#include "InstrumentedMutex.h"
+#include "Metrics.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace
+{
+	//Uncontended locks are taken every frame - waits shorter than this are left out of the profile trace
+	constexpr int64_t MIN_PROFILED_WAIT_TIME = 10;
+
+	struct LockSiteRegistry
+	{
+		std::mutex mutex;
+		std::vector<const LockSite*> lockSites;
+	};
+
+	LockSiteRegistry& getLockSiteRegistry()
+	{
+		static LockSiteRegistry lockSiteRegistry;
+		return lockSiteRegistry;
+	}
+}
+
+//LockSite
+LockSite::LockSite(const std::string& name)
+	: m_name(name),
+	m_waitProfileName("Wait " + name),
+	m_holdProfileName("Hold " + name),
+	m_waitTime(Metrics::getHistogram("Lock wait " + name + " (us)")),
+	m_holdTime(Metrics::getHistogram("Lock hold " + name + " (us)"))
+{
+	LockSiteRegistry& lockSiteRegistry = getLockSiteRegistry();
+	std::lock_guard<std::mutex> lockSiteRegistryLock(lockSiteRegistry.mutex);
+	lockSiteRegistry.lockSites.push_back(this);
+}
+
+LockSite::~LockSite()
+{
+	LockSiteRegistry& lockSiteRegistry = getLockSiteRegistry();
+	std::lock_guard<std::mutex> lockSiteRegistryLock(lockSiteRegistry.mutex);
+	auto lockSite = std::find(lockSiteRegistry.lockSites.begin(), lockSiteRegistry.lockSites.end(), this);
+	assert(lockSite != lockSiteRegistry.lockSites.end());
+	lockSiteRegistry.lockSites.erase(lockSite);
+}
+
+void LockSite::recordWait(int64_t startTime, int64_t acquiredTime)
+{
+	m_waitTime.record(acquiredTime - startTime);
+#if PROFILING_ENABLED
+	if (acquiredTime - startTime >= MIN_PROFILED_WAIT_TIME)
+	{
+		Profiler::recordScope(m_waitProfileName.c_str(), startTime, acquiredTime);
+	}
+#endif // PROFILING_ENABLED
+}
+
+void LockSite::recordHold(int64_t acquiredTime, int64_t releasedTime)
+{
+	m_holdTime.record(releasedTime - acquiredTime);
+#if PROFILING_ENABLED
+	Profiler::recordScope(m_holdProfileName.c_str(), acquiredTime, releasedTime);
+#endif // PROFILING_ENABLED
+}
+
+LockSiteStats LockSite::getStats() const
+{
+	HistogramSnapshot waitTime = m_waitTime.getSnapshot();
+	HistogramSnapshot holdTime = m_holdTime.getSnapshot();
+
+	LockSiteStats stats;
+	stats.name = m_name;
+	stats.acquisitions = waitTime.count;
+	stats.totalWaitTime = waitTime.sum;
+	stats.maxWaitTime = waitTime.max;
+	stats.totalHoldTime = holdTime.sum;
+	stats.maxHoldTime = holdTime.max;
+	return stats;
+}
+
+//InstrumentedMutex
+InstrumentedMutex::InstrumentedMutex(const std::string& name)
+	: m_mutex(),
+	m_unnamedLockSite(name + " unnamed"),
+	m_waitTime(Metrics::getHistogram("Lock wait " + name + " (us)")),
+	m_holdTime(Metrics::getHistogram("Lock hold " + name + " (us)")),
+	m_holder(nullptr),
+	m_acquiredTime(0)
+{}
+
+void InstrumentedMutex::lock()
+{
+	lock(m_unnamedLockSite);
+}
+
+bool InstrumentedMutex::try_lock()
+{
+	if (!m_mutex.try_lock())
+	{
+		return false;
+	}
+
+	m_holder = &m_unnamedLockSite;
+	m_acquiredTime = Profiler::getTime();
+	m_holder->recordWait(m_acquiredTime, m_acquiredTime);
+	m_waitTime.record(0);
+	return true;
+}
+
+void InstrumentedMutex::unlock()
+{
+	assert(m_holder);
+	LockSite* holder = m_holder;
+	int64_t acquiredTime = m_acquiredTime;
+	m_holder = nullptr;
+	m_mutex.unlock();
+
+	int64_t releasedTime = Profiler::getTime();
+	holder->recordHold(acquiredTime, releasedTime);
+	m_holdTime.record(releasedTime - acquiredTime);
+}
+
+void InstrumentedMutex::lock(LockSite& lockSite)
+{
+	int64_t startTime = Profiler::getTime();
+	m_mutex.lock();
+	m_holder = &lockSite;
+	m_acquiredTime = Profiler::getTime();
+
+	lockSite.recordWait(startTime, m_acquiredTime);
+	m_waitTime.record(m_acquiredTime - startTime);
+}
+
+void getMostContendedLockSites(std::vector<LockSiteStats>& lockSiteStats, size_t count)
+{
+	lockSiteStats.clear();
+	{
+		LockSiteRegistry& lockSiteRegistry = getLockSiteRegistry();
+		std::lock_guard<std::mutex> lockSiteRegistryLock(lockSiteRegistry.mutex);
+		for (const auto& lockSite : lockSiteRegistry.lockSites)
+		{
+			LockSiteStats stats = lockSite->getStats();
+			if (stats.acquisitions > 0)
+			{
+				lockSiteStats.push_back(std::move(stats));
+			}
+		}
+	}
+
+	std::sort(lockSiteStats.begin(), lockSiteStats.end(), [](const auto& a, const auto& b)
+	{
+		return a.totalWaitTime > b.totalWaitTime;
+	});
+
+	if (lockSiteStats.size() > count)
+	{
+		lockSiteStats.resize(count);
+	}
+}
+
+void getLockContentionSummary(std::vector<std::string>& lines, size_t count)
+{
+	std::vector<LockSiteStats> lockSiteStats;
+	getMostContendedLockSites(lockSiteStats, count);
+
+	lines.clear();
+	for (const auto& stats : lockSiteStats)
+	{
+		lines.push_back("Lock " + stats.name + ": WAIT " + std::to_string(stats.totalWaitTime) +
+			" MAX " + std::to_string(stats.maxWaitTime) + " HOLD " + std::to_string(stats.totalHoldTime) +
+			" MAX " + std::to_string(stats.maxHoldTime) + " COUNT " + std::to_string(stats.acquisitions));
+	}
+}
\ No newline at end of file
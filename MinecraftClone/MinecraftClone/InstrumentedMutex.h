@@ -0,0 +1,112 @@
+#pragma once
+
+#include "NonCopyable.h"
+#include "NonMovable.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <assert.h>
+
+class MetricHistogram;
+
+struct LockSiteStats
+{
+	std::string name;
+	int64_t acquisitions = 0;
+	int64_t totalWaitTime = 0;
+	int64_t maxWaitTime = 0;
+	int64_t totalHoldTime = 0;
+	int64_t maxHoldTime = 0;
+};
+
+//Somewhere a lock is taken - LOCK_SITE makes one per call site that lives until the program exits
+//Times are in microseconds
+class LockSite : private NonCopyable, private NonMovable
+{
+public:
+	LockSite(const std::string& name);
+	~LockSite();
+
+	void recordWait(int64_t startTime, int64_t acquiredTime);
+	void recordHold(int64_t acquiredTime, int64_t releasedTime);
+	LockSiteStats getStats() const;
+
+private:
+	const std::string m_name;
+	const std::string m_waitProfileName;
+	const std::string m_holdProfileName;
+	MetricHistogram& m_waitTime;
+	MetricHistogram& m_holdTime;
+};
+
+//Drop in for std::mutex that records how long each lock was waited on and held for, per call site and for the mutex as a whole
+//Waits and holds show up in the metrics as histograms and in the profile trace on the thread that took the lock
+class InstrumentedMutex : private NonCopyable, private NonMovable
+{
+public:
+	InstrumentedMutex(const std::string& name);
+
+	//Lockable so std::lock_guard and std::unique_lock still work - their locks are put down to the mutex's unnamed site
+	void lock();
+	bool try_lock();
+	void unlock();
+	void lock(LockSite& lockSite);
+
+private:
+	std::mutex m_mutex;
+	LockSite m_unnamedLockSite;
+	MetricHistogram& m_waitTime;
+	MetricHistogram& m_holdTime;
+	//Only touched by the thread holding the lock
+	LockSite* m_holder;
+	int64_t m_acquiredTime;
+};
+
+//std::unique_lock that knows where it was taken
+class InstrumentedLock : private NonCopyable, private NonMovable
+{
+public:
+	InstrumentedLock(InstrumentedMutex& mutex, LockSite& lockSite)
+		: m_mutex(mutex),
+		m_lockSite(lockSite),
+		m_ownsLock(false)
+	{
+		lock();
+	}
+
+	~InstrumentedLock()
+	{
+		if (m_ownsLock)
+		{
+			unlock();
+		}
+	}
+
+	void lock()
+	{
+		assert(!m_ownsLock);
+		m_mutex.lock(m_lockSite);
+		m_ownsLock = true;
+	}
+
+	void unlock()
+	{
+		assert(m_ownsLock);
+		m_mutex.unlock();
+		m_ownsLock = false;
+	}
+
+private:
+	InstrumentedMutex& m_mutex;
+	LockSite& m_lockSite;
+	bool m_ownsLock;
+};
+
+//The call sites that have spent the longest waiting, longest first
+void getMostContendedLockSites(std::vector<LockSiteStats>& lockSiteStats, size_t count);
+//One line per call site for the overlay and console
+void getLockContentionSummary(std::vector<std::string>& lines, size_t count);
+
+#define LOCK_SITE(name) ([]() -> LockSite& { static LockSite lockSite(name); return lockSite; }())
\ No newline at end of file
@@ -3,34 +3,11 @@
 #include <iostream>
 #include "GameMessenger.h"
 #include "GameMessages.h"
+#include <algorithm>
 
 namespace
 {
 	constexpr int MAX_ITEM_CAPACITY = 64;
-
-	eCubeType convertCubeType(eCubeType cubeType)
-	{
-		switch (cubeType)
-		{
-		case eCubeType::Grass:
-			return eCubeType::Grass;
-		case eCubeType::Dirt:
-			return eCubeType::Dirt;
-		case eCubeType::Cactus:
-		case eCubeType::CactusTop:
-		 	return eCubeType::Cactus;
-		case eCubeType::Sand:
-			return eCubeType::Sand;
-		case eCubeType::Log:
-			return eCubeType::Log;
-		case eCubeType::LogTop:
-			return eCubeType::LogTop;
-		case eCubeType::Stone:
-			return eCubeType::Stone;
-		default:
-			assert(false);
-		}
-	};
 };
 
 //Item
@@ -66,10 +43,13 @@ void Item::reduce()
 	--m_currentAmount;
 }
 
-void Item::incrementQuantity()
+int Item::increaseQuantity(int quantity)
 {
-	assert(m_currentAmount < MAX_ITEM_CAPACITY);
-	++m_currentAmount;
+	assert(quantity > 0 && m_currentAmount < MAX_ITEM_CAPACITY);
+	int addedQuantity = std::min(quantity, MAX_ITEM_CAPACITY - m_currentAmount);
+	m_currentAmount += addedQuantity;
+
+	return addedQuantity;
 }
 
 void Item::reset(eCubeType cubeType)
@@ -113,6 +93,25 @@ bool Inventory::isItemAddable(eCubeType cubeType) const
 	return false;
 }
 
+int Inventory::getAddableQuantity(eCubeType cubeType) const
+{
+	eCubeType convertedCubeType = getCubeTypeProperties(cubeType).collectedCubeType;
+	int addableQuantity = 0;
+	for (const auto& item : m_items)
+	{
+		if (item.isEmpty())
+		{
+			addableQuantity += MAX_ITEM_CAPACITY;
+		}
+		else if (item.getCubeType() == convertedCubeType)
+		{
+			addableQuantity += MAX_ITEM_CAPACITY - item.getSize();
+		}
+	}
+
+	return addableQuantity;
+}
+
 void Inventory::reduceSelectedItem()
 {
 	assert(!isSelectedItemEmpty());
@@ -126,37 +125,33 @@ void Inventory::reduceSelectedItem()
 	}
 }
 
-void Inventory::add(eCubeType cubeTypeToAdd)
+void Inventory::add(eCubeType cubeTypeToAdd, int quantity)
 {
-	eCubeType convertedCubeType = convertCubeType(cubeTypeToAdd);
-	//Add to existing item in Inventory
-	bool itemAdded = false;
-	for (int i = 0; i < static_cast<int>(eInventoryIndex::Max) + 1; ++i)
+	eCubeType convertedCubeType = getCubeTypeProperties(cubeTypeToAdd).collectedCubeType;
+	assert(convertedCubeType != eCubeType::Air && quantity > 0);
+	//Add to existing items in Inventory
+	for (int i = 0; quantity > 0 && i < static_cast<int>(eInventoryIndex::Max) + 1; ++i)
 	{
 		if (!m_items[i].isEmpty() && 
 			!m_items[i].isFull() && 
 			m_items[i].getCubeType() == convertedCubeType)
 		{
-			m_items[i].incrementQuantity();
-			itemAdded = true;
+			quantity -= m_items[i].increaseQuantity(quantity);
 			
 			broadcastToMessenger<GameMessages::UpdateItemQuantityGUI>({ static_cast<eInventoryIndex>(i), m_items[i].getSize() });
-
-			break;
 		}
 	}
 
-	//Add to next available free space in Inventory
-	for (int i = 0; !itemAdded && i < static_cast<int>(eInventoryIndex::Max) + 1; ++i)
+	//Spill the rest into the next available free spaces in Inventory
+	for (int i = 0; quantity > 0 && i < static_cast<int>(eInventoryIndex::Max) + 1; ++i)
 	{
 		if (m_items[i].isEmpty())
 		{
 			m_items[i].reset(convertedCubeType);
-			m_items[i].incrementQuantity();
+			quantity -= m_items[i].increaseQuantity(quantity);
 
 			broadcastToMessenger<GameMessages::AddItemGUI>({ convertedCubeType, static_cast<eInventoryIndex>(i) });
 			broadcastToMessenger<GameMessages::UpdateItemQuantityGUI>({ static_cast<eInventoryIndex>(i), m_items[i].getSize() });
-			break;
 		}
 	}
 }
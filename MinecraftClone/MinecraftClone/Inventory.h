@@ -16,7 +16,8 @@ public:
 	eCubeType getCubeType() const;
 
 	void reduce();
-	void incrementQuantity();
+	//Returns how much of the quantity fit
+	int increaseQuantity(int quantity);
 	void reset(eCubeType cubeType);
 
 private:
@@ -33,9 +34,10 @@ public:
 	eCubeType getSelectedItemType() const;
 	bool isSelectedItemEmpty() const;
 	bool isItemAddable(eCubeType cubeType) const;
+	int getAddableQuantity(eCubeType cubeType) const;
 	
 	void reduceSelectedItem();
-	void add(eCubeType cubeTypeToAdd);
+	void add(eCubeType cubeTypeToAdd, int quantity);
 	void handleInputEvents(const sf::Event& currentSFMLEvent);
 
 private:
@@ -0,0 +1,52 @@
+#include "MemoryAccounting.h"
+#include <array>
+#include <atomic>
+#include <assert.h>
+
+namespace
+{
+	std::array<std::atomic<size_t>, static_cast<size_t>(eMemoryCategory::Max) + 1> memoryUsage = {};
+}
+
+size_t MemoryUsage::getTotal() const
+{
+	return voxels + CPUMeshes + GPUMeshes;
+}
+
+void MemoryAccounting::onAllocate(eMemoryCategory memoryCategory, size_t bytes)
+{
+	memoryUsage[static_cast<size_t>(memoryCategory)].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void MemoryAccounting::onRelease(eMemoryCategory memoryCategory, size_t bytes)
+{
+	size_t previousUsage = memoryUsage[static_cast<size_t>(memoryCategory)].fetch_sub(bytes, std::memory_order_relaxed);
+	assert(previousUsage >= bytes);
+}
+
+void MemoryAccounting::onResize(eMemoryCategory memoryCategory, size_t previousBytes, size_t bytes)
+{
+	if (bytes > previousBytes)
+	{
+		onAllocate(memoryCategory, bytes - previousBytes);
+	}
+	else if (bytes < previousBytes)
+	{
+		onRelease(memoryCategory, previousBytes - bytes);
+	}
+}
+
+size_t MemoryAccounting::getUsage(eMemoryCategory memoryCategory)
+{
+	return memoryUsage[static_cast<size_t>(memoryCategory)].load(std::memory_order_relaxed);
+}
+
+MemoryUsage MemoryAccounting::getUsage()
+{
+	MemoryUsage usage;
+	usage.voxels = getUsage(eMemoryCategory::Voxels);
+	usage.CPUMeshes = getUsage(eMemoryCategory::CPUMeshes);
+	usage.GPUMeshes = getUsage(eMemoryCategory::GPUMeshes);
+
+	return usage;
+}
\ No newline at end of file
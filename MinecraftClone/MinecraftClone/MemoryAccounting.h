@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+enum class eMemoryCategory
+{
+	Voxels = 0,
+	CPUMeshes,
+	GPUMeshes,
+	Max = GPUMeshes
+};
+
+struct MemoryUsage
+{
+	size_t getTotal() const;
+
+	size_t voxels = 0;
+	size_t CPUMeshes = 0;
+	size_t GPUMeshes = 0;
+};
+
+//Live byte counts - safe to update from any thread
+namespace MemoryAccounting
+{
+	void onAllocate(eMemoryCategory memoryCategory, size_t bytes);
+	void onRelease(eMemoryCategory memoryCategory, size_t bytes);
+	void onResize(eMemoryCategory memoryCategory, size_t previousBytes, size_t bytes);
+
+	size_t getUsage(eMemoryCategory memoryCategory);
+	MemoryUsage getUsage();
+}
\ No newline at end of file
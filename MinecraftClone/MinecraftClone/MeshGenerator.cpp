@@ -1,6 +1,14 @@
 #include "MeshGenerator.h"
 #include "ChunkManager.h"
 #include "NeighbouringChunks.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace
 {
@@ -225,88 +233,7 @@ namespace
 
 	void getTextCoords(std::vector<glm::vec3>& textCoords, eCubeSide cubeSide, eCubeType cubeType)
 	{
-		eTerrainTextureLayer textureLayer;
-		switch (cubeType)
-		{
-		case eCubeType::Dirt:
-			textureLayer = eTerrainTextureLayer::Dirt;
-			break;
-		case eCubeType::Stone:
-			textureLayer = eTerrainTextureLayer::Stone;
-			break;
-		case eCubeType::Sand:
-			textureLayer = eTerrainTextureLayer::Sand;
-			break;
-		case eCubeType::Grass:
-			switch (cubeSide)
-			{
-			case eCubeSide::Back:
-			case eCubeSide::Front:
-			case eCubeSide::Left:
-			case eCubeSide::Right:
-				textureLayer = eTerrainTextureLayer::GrassSide;
-				break;
-			case eCubeSide::Top:
-				textureLayer = eTerrainTextureLayer::Grass;
-				break;
-			case eCubeSide::Bottom:
-				textureLayer = eTerrainTextureLayer::Dirt;
-				break;
-			}
-			break;
-		case eCubeType::Log:
-			textureLayer = eTerrainTextureLayer::Log;
-			break;
-		case eCubeType::LogTop:
-			switch (cubeSide)
-			{
-			case eCubeSide::Back:
-			case eCubeSide::Front:
-			case eCubeSide::Left:
-			case eCubeSide::Right:
-			case eCubeSide::Bottom:
-				textureLayer = eTerrainTextureLayer::Log;
-				break;
-			case eCubeSide::Top:
-				textureLayer = eTerrainTextureLayer::LogTop;
-				break;
-			}
-			break;
-		case eCubeType::Leaves:
-			textureLayer = eTerrainTextureLayer::Leaves;
-			break;
-		case eCubeType::Cactus:
-			textureLayer = eTerrainTextureLayer::Cactus;
-			break;
-		case eCubeType::CactusTop:
-			switch (cubeSide)
-			{
-			case eCubeSide::Back:
-			case eCubeSide::Front:
-			case eCubeSide::Left:
-			case eCubeSide::Right:
-			case eCubeSide::Bottom:
-				textureLayer = eTerrainTextureLayer::Cactus;
-				break;
-			case eCubeSide::Top:
-				textureLayer = eTerrainTextureLayer::CactusTop;
-				break;
-			}
-			break;
-		case eCubeType::Water:
-			textureLayer = eTerrainTextureLayer::Water;
-			break;
-		case eCubeType::Shrub:
-			textureLayer = eTerrainTextureLayer::Shrub;
-			break;
-		case eCubeType::TallGrass:
-			textureLayer = eTerrainTextureLayer::TallGrass;
-			break;
-
-		default:
-			textureLayer = eTerrainTextureLayer::Error;
-		}
-
+		eTerrainTextureLayer textureLayer = getCubeTypeProperties(cubeType).textureLayers[static_cast<int>(cubeSide)];
 		assert(textureLayer != eTerrainTextureLayer::Error);
 		for (const auto& i : TEXT_COORDS)
 		{
@@ -490,436 +417,774 @@ namespace
 
 		vertexBuffer.elementBufferIndex += CUBE_FACE_INDICIE_COUNT;
 	}
-}
 
-void generateOuterChunkMesh(VertexArray& chunkMesh, const Chunk& chunk, const NeighbouringChunks& neighbouringChunks);
-void generateInnerChunkMesh(VertexArray& chunkMesh, const Chunk& chunk);
-void generateChunkInnerCubeMesh(const glm::ivec3& position, const Chunk& chunk, eCubeType cubeType, VertexArray& chunkMesh);
-void generateChunkOuterCubeMesh(const glm::ivec3& position, const Chunk& chunk, const NeighbouringChunks& neighbouringChunks,
-	eCubeType cubeType, VertexArray& chunkMesh);
-void addCubeFace(VertexBuffer& vertexBuffer, eCubeType cubeType, eCubeSide cubeSide, const glm::vec3& cubePosition,
-	bool transparent, bool shadow = false);
-void addDiagonalCubeFace(VertexBuffer& vertexBuffer, eCubeType cubeType, const glm::ivec3& cubePosition,
-	const std::array<glm::vec3, 4>& diagonalFace, bool shadow = false);
-
-bool isFacingTransparentCube(const glm::ivec3& cubePosition, const Chunk& chunk);
-bool isFacingOpaqueCube(const glm::ivec3& cubePosition, const Chunk& chunk);
-
-void MeshGenerator::generateVoxelSelectionMesh(VertexBuffer& mesh, const glm::vec3& position)
-{
-	addVoxelSelectionCubeFace(mesh, eCubeSide::Left, position);
-	addVoxelSelectionCubeFace(mesh, eCubeSide::Right, position);
-	addVoxelSelectionCubeFace(mesh, eCubeSide::Top, position);
-	addVoxelSelectionCubeFace(mesh, eCubeSide::Bottom, position);
-	addVoxelSelectionCubeFace(mesh, eCubeSide::Front, position);
-	addVoxelSelectionCubeFace(mesh, eCubeSide::Back, position);
-
-	mesh.bindToVAO = true;
-}
-
-void MeshGenerator::generateDestroyBlockMesh(VertexBuffer& destroyBlockMesh, eDestroyCubeIndex destroyCubeIndex, const glm::vec3& position)
-{
-	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Left, destroyCubeIndex, position);
-	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Right, destroyCubeIndex, position);
-	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Top, destroyCubeIndex, position);
-	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Bottom, destroyCubeIndex, position);
-	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Front, destroyCubeIndex, position);
-	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Back, destroyCubeIndex, position);
+	//Chunk plus a one cube apron copied from the four neighbouring chunks so meshing never leaves this volume
+	constexpr int PADDED_CHUNK_WIDTH = Globals::CHUNK_WIDTH + 2;
+	constexpr int PADDED_CHUNK_DEPTH = Globals::CHUNK_DEPTH + 2;
+	constexpr int PADDED_CHUNK_VOLUME = PADDED_CHUNK_WIDTH * Globals::CHUNK_HEIGHT * PADDED_CHUNK_DEPTH;
+	thread_local std::array<char, PADDED_CHUNK_VOLUME> paddedChunk;
 
-	destroyBlockMesh.bindToVAO = true;
-}
-
-void MeshGenerator::generateChunkMesh(VertexArray& chunkMesh, const Chunk& chunk, const NeighbouringChunks& neighbouringChunks)
-{
-	generateInnerChunkMesh(chunkMesh, chunk);
-	generateOuterChunkMesh(chunkMesh, chunk, neighbouringChunks);
-
-	if (!chunkMesh.m_opaqueVertexBuffer.indicies.empty())
+	int convertToPaddedIndex(int paddedX, int y, int paddedZ)
 	{
-		chunkMesh.m_opaqueVertexBuffer.bindToVAO = true;
+		return (paddedZ * PADDED_CHUNK_WIDTH * Globals::CHUNK_HEIGHT) + (y * PADDED_CHUNK_WIDTH) + paddedX;
 	}
 
-	if (!chunkMesh.m_transparentVertexBuffer.indicies.empty())
+	//Occupancy of a single padded row of cubes along the x axis - bit x is set when the cube at padded x matches
+	struct CubeRowMasks
 	{
-		chunkMesh.m_transparentVertexBuffer.bindToVAO = true;
-	}
-}
-
-void MeshGenerator::generatePickUpMesh(VertexBuffer& pickUpMesh, eCubeType cubeType)
-{
-	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Left);
-	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Right);
-	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Top);
-	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Bottom);
-	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Front);
-	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Back);
+		uint64_t opaque = 0;
+		uint64_t transparent = 0;
+		uint64_t leaves = 0;
+		uint64_t water = 0;
+		uint64_t plant = 0;
+		uint64_t topFaceAlwaysVisible = 0;
+	};
 
-	pickUpMesh.bindToVAO = true;
-}
+	//Bits 1 to CHUNK_WIDTH belong to the chunk being meshed, bits 0 and CHUNK_WIDTH + 1 to the apron
+	constexpr uint64_t CHUNK_ROW_MASK = ((uint64_t(1) << Globals::CHUNK_WIDTH) - 1) << 1;
+	constexpr uint64_t FULL_CUBE_ROW_MASK = ~uint64_t(0);
 
-void generateOuterChunkMesh(VertexArray& chunkMesh, const Chunk& chunk, const NeighbouringChunks& neighbouringChunks)
-{
-	const glm::ivec3& chunkStartingPosition = chunk.getStartingPosition();
-	const glm::ivec3& chunkEndingPosition = chunk.getEndingPosition();
+	using ChunkRowMasks = std::array<std::array<CubeRowMasks, Globals::CHUNK_HEIGHT>, PADDED_CHUNK_DEPTH>;
+	thread_local ChunkRowMasks chunkRowMasks;
 
-	//Vertical
-	for (int z = chunkStartingPosition.z; z < chunkEndingPosition.z; ++z)
+	//Grows to the largest chunk mesh seen by this thread and is reused - only the exact sized copy handed to the VertexBuffer allocates
+	struct ChunkMeshScratchBuffer
 	{
-		for (int y = chunkStartingPosition.y; y < chunkEndingPosition.y; ++y)
+		void clear()
 		{
-			eCubeType cubeType = static_cast<eCubeType>(chunk.getCubeDetailsWithoutBoundsCheck({ chunkStartingPosition.x, y, z }));
-			if (cubeType != eCubeType::Air)
-			{
-				generateChunkOuterCubeMesh({ chunkStartingPosition.x, y, z }, chunk, neighbouringChunks, cubeType, chunkMesh);
-			}
+			elementBufferIndex = 0;
+			positions.clear();
+			lightIntensityVertices.clear();
+			textCoords.clear();
+			indicies.clear();
 		}
-	}
 
-	for (int z = chunkStartingPosition.z; z < chunkEndingPosition.z; ++z)
-	{
-		for (int y = chunkStartingPosition.y; y < chunkEndingPosition.y; ++y)
+		size_t getCapacityInBytes() const
 		{
-			eCubeType cubeType = static_cast<eCubeType>(chunk.getCubeDetailsWithoutBoundsCheck({ chunkEndingPosition.x - 1, y, z }));
-
-			if (cubeType != eCubeType::Air)
-			{
-				generateChunkOuterCubeMesh({ chunkEndingPosition.x - 1, y, z }, chunk, neighbouringChunks, cubeType, chunkMesh);
-			}
+			return positions.capacity() * sizeof(glm::vec3) + lightIntensityVertices.capacity() * sizeof(float) +
+				textCoords.capacity() * sizeof(glm::vec3) + indicies.capacity() * sizeof(unsigned int);
 		}
-	}
 
-	//Horizontal
-	for (int y = chunkStartingPosition.y; y < chunkEndingPosition.y; ++y)
-	{
-		for (int x = chunkStartingPosition.x; x < chunkEndingPosition.x; ++x)
+		size_t getSizeInBytes() const
 		{
-			eCubeType cubeType = static_cast<eCubeType>(chunk.getCubeDetailsWithoutBoundsCheck({ x, y, chunkStartingPosition.z }));
-
-			if (cubeType != eCubeType::Air)
-			{
-				generateChunkOuterCubeMesh({ x, y, chunkStartingPosition.z }, chunk, neighbouringChunks, cubeType, chunkMesh);
-			}
+			return positions.size() * sizeof(glm::vec3) + lightIntensityVertices.size() * sizeof(float) +
+				textCoords.size() * sizeof(glm::vec3) + indicies.size() * sizeof(unsigned int);
 		}
-	}
 
-	for (int y = chunkStartingPosition.y; y < chunkEndingPosition.y; ++y)
-	{
-		for (int x = chunkStartingPosition.x; x < chunkEndingPosition.x; ++x)
+		void handOff(VertexBuffer& vertexBuffer) const
 		{
-			eCubeType cubeType = static_cast<eCubeType>(chunk.getCubeDetailsWithoutBoundsCheck({ x, y, chunkEndingPosition.z - 1 }));
-
-			if (cubeType != eCubeType::Air)
-			{
-				generateChunkOuterCubeMesh({ x, y, chunkEndingPosition.z - 1 }, chunk, neighbouringChunks, cubeType, chunkMesh);
-			}
+			vertexBuffer.elementBufferIndex = elementBufferIndex;
+			vertexBuffer.positions.assign(positions.cbegin(), positions.cend());
+			vertexBuffer.lightIntensityVertices.assign(lightIntensityVertices.cbegin(), lightIntensityVertices.cend());
+			vertexBuffer.textCoords.assign(textCoords.cbegin(), textCoords.cend());
+			vertexBuffer.indicies.assign(indicies.cbegin(), indicies.cend());
+			vertexBuffer.updateCPUMemoryUsage();
 		}
-	}
-}
 
-void generateInnerChunkMesh(VertexArray& chunkMesh, const Chunk& chunk)
-{
-	const glm::ivec3& chunkStartingPosition = chunk.getStartingPosition();
-	const glm::ivec3& chunkEndingPosition = chunk.getEndingPosition();
+		int elementBufferIndex = 0;
+		std::vector<glm::vec3> positions;
+		std::vector<float> lightIntensityVertices;
+		std::vector<glm::vec3> textCoords;
+		std::vector<unsigned int> indicies;
+	};
+
+	thread_local ChunkMeshScratchBuffer opaqueScratchBuffer;
+	thread_local ChunkMeshScratchBuffer transparentScratchBuffer;
+
+	std::atomic<size_t> chunkMeshesGenerated(0);
+	std::atomic<size_t> scratchBytesAllocated(0);
+	std::atomic<size_t> handOffBytes(0);
+	std::atomic<size_t> lastMeshScratchBytesAllocated(0);
+	std::atomic<size_t> lastMeshHandOffBytes(0);
 
-	for (int z = chunkStartingPosition.z + 1; z < chunkEndingPosition.z - 1; ++z)
+	void addCubeToRowMasks(CubeRowMasks& rowMasks, eCubeType cubeType, uint64_t bit)
 	{
-		for (int y = chunkStartingPosition.y + 1; y < chunkEndingPosition.y - 1; ++y)
+		const CubeTypeProperties& properties = getCubeTypeProperties(cubeType);
+		if (properties.opaque)
 		{
-			for (int x = chunkStartingPosition.x + 1; x < chunkEndingPosition.x - 1; ++x)
+			rowMasks.opaque |= bit;
+		}
+		else if (properties.transparent)
+		{
+			rowMasks.transparent |= bit;
+		}
+
+		switch (properties.meshType)
+		{
+		case eCubeMeshType::None:
+			break;
+		case eCubeMeshType::Cube:
+			if (properties.transparent)
 			{
-				glm::ivec3 position(x, y, z);
-				eCubeType cubeType = static_cast<eCubeType>(chunk.getCubeDetailsWithoutBoundsCheck(position));
-				if (cubeType != eCubeType::Air)
-				{
-					generateChunkInnerCubeMesh(position, chunk, cubeType, chunkMesh);
-				}
+				rowMasks.leaves |= bit;
+			}
+			else if (properties.topFaceAlwaysVisible)
+			{
+				rowMasks.topFaceAlwaysVisible |= bit;
 			}
+			break;
+		case eCubeMeshType::Liquid:
+			rowMasks.water |= bit;
+			break;
+		case eCubeMeshType::Diagonal:
+			rowMasks.plant |= bit;
+			break;
+		default:
+			assert(false);
 		}
 	}
-}
-
-void generateChunkInnerCubeMesh(const glm::ivec3& position, const Chunk& chunk, eCubeType cubeType, VertexArray& chunkMesh)
-{
-	assert(chunk.isPositionInBounds(position));
 
-	switch (cubeType)
+	CubeRowMasks getCubeRowMasks(const char* paddedCubeRow)
 	{
-	case eCubeType::Water:
+		CubeRowMasks rowMasks;
 
-		if(isFacingOpaqueCube({ position.x, position.y + 1, position.z }, chunk))
+		//Air is zero - skip the per cube work for empty rows
+		std::array<uint64_t, Globals::CHUNK_WIDTH / sizeof(uint64_t)> words;
+		std::memcpy(words.data(), paddedCubeRow + 1, Globals::CHUNK_WIDTH);
+		if ((words[0] | words[1] | words[2] | words[3]) == 0 &&
+			paddedCubeRow[0] == 0 && paddedCubeRow[PADDED_CHUNK_WIDTH - 1] == 0)
 		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Top, { position.x, position.y - WATER_OFFSET_Y, position.z }, true);
+			return rowMasks;
 		}
 
-		break;
-	case eCubeType::Leaves:
-		if (isFacingOpaqueCube({ position.x - 1, position.y, position.z }, chunk))
+		for (int x = 0; x < PADDED_CHUNK_WIDTH; ++x)
 		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Left, position, true);
+			addCubeToRowMasks(rowMasks, static_cast<eCubeType>(paddedCubeRow[x]), uint64_t(1) << x);
 		}
 
-		if (isFacingOpaqueCube({ position.x + 1, position.y, position.z }, chunk))
-		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Right, position, true);
-		}
+		return rowMasks;
+	}
 
-		if (isFacingOpaqueCube({ position.x, position.y, position.z + 1 }, chunk))
-		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Front, position, true);
-		}
+	int popLowestSetBit(uint64_t& mask)
+	{
+		assert(mask != 0);
+#ifdef _MSC_VER
+		unsigned long index = 0;
+		_BitScanForward64(&index, mask);
+#else
+		int index = __builtin_ctzll(mask);
+#endif
+		mask &= mask - 1;
+
+		return static_cast<int>(index);
+	}
 
-		if (isFacingOpaqueCube({ position.x, position.y, position.z - 1 }, chunk))
+	const std::array<glm::vec3, 4>& getCubeFace(eCubeSide cubeSide)
+	{
+		switch (cubeSide)
 		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Back, position, true);
+		case eCubeSide::Front:
+			return CUBE_FACE_FRONT;
+		case eCubeSide::Back:
+			return CUBE_FACE_BACK;
+		case eCubeSide::Left:
+			return CUBE_FACE_LEFT;
+		case eCubeSide::Right:
+			return CUBE_FACE_RIGHT;
+		case eCubeSide::Top:
+			return CUBE_FACE_TOP;
+		case eCubeSide::Bottom:
+			return CUBE_FACE_BOTTOM;
+		default:
+			assert(false);
+			return CUBE_FACE_FRONT;
 		}
+	}
 
-		//Top Face
-		if (position.y == Globals::CHUNK_HEIGHT - 1 ||
-			isFacingOpaqueCube({ position.x, position.y + 1, position.z }, chunk))
+	float getCubeFaceLightingIntensity(eCubeSide cubeSide)
+	{
+		switch (cubeSide)
 		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Top, position, true);
+		case eCubeSide::Front:
+			return FRONT_FACE_LIGHTING_INTENSITY;
+		case eCubeSide::Back:
+			return BACK_FACE_LIGHTING_INTENSITY;
+		case eCubeSide::Left:
+			return LEFT_FACE_LIGHTING_INTENSITY;
+		case eCubeSide::Right:
+			return RIGHT_FACE_LIGHTING_INTENSITY;
+		case eCubeSide::Top:
+			return TOP_LIGHTING_INTENSITY;
+		case eCubeSide::Bottom:
+			return BOTTOM_FACE_LIGHTING_INTENSITY;
+		default:
+			assert(false);
+			return DEFAULT_LIGHTING_INTENSITY;
 		}
+	}
 
-		//Bottom Face
-		if (isFacingOpaqueCube({ position.x, position.y - 1, position.z }, chunk))
-		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Bottom, position, true);
-		}
-		break;
-	case eCubeType::TallGrass:
-	case eCubeType::Shrub:
+	int getChunkMeshLODScale(eChunkMeshLOD chunkMeshLOD)
 	{
-		bool shadow = chunk.isCubeBelowCovering(position);
+		return 1 << static_cast<int>(chunkMeshLOD);
+	}
 
-		addDiagonalCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, position, FIRST_DIAGONAL_FACE, shadow);
-		addDiagonalCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, position, SECOND_DIAGONAL_FACE, shadow);
+	bool isLeaves(const CubeTypeProperties& properties)
+	{
+		return properties.meshType == eCubeMeshType::Cube && properties.transparent;
 	}
 
-		break;
-	default:
+	//Half detail - cells of HALF_LOD_SCALE cubes plus a one cell apron from the four neighbouring chunks
+	constexpr int HALF_LOD_SCALE = 2;
+	constexpr int DOWNSAMPLED_CHUNK_WIDTH = Globals::CHUNK_WIDTH / HALF_LOD_SCALE + 2;
+	constexpr int DOWNSAMPLED_CHUNK_HEIGHT = Globals::CHUNK_HEIGHT / HALF_LOD_SCALE;
+	constexpr int DOWNSAMPLED_CHUNK_DEPTH = Globals::CHUNK_DEPTH / HALF_LOD_SCALE + 2;
+	thread_local std::array<char, DOWNSAMPLED_CHUNK_WIDTH * DOWNSAMPLED_CHUNK_HEIGHT * DOWNSAMPLED_CHUNK_DEPTH> downsampledChunk;
+
+	int convertToDownsampledIndex(int cellX, int cellY, int cellZ)
 	{
-		bool shadow = chunk.isCubeBelowCovering(position);
+		return (cellZ * DOWNSAMPLED_CHUNK_WIDTH * DOWNSAMPLED_CHUNK_HEIGHT) + (cellY * DOWNSAMPLED_CHUNK_WIDTH) + cellX;
+	}
 
-		if (isFacingTransparentCube({ position.x - 1, position.y, position.z }, chunk))
+	//The highest opaque cube in the cell so grass stays on top, otherwise leaves before water
+	eCubeType getDownsampledCubeType(const Chunk& chunk, int localX, int localY, int localZ)
+	{
+		eCubeType transparentCubeType = eCubeType::Air;
+		for (int y = localY + HALF_LOD_SCALE - 1; y >= localY; --y)
 		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Left, position, false, shadow);
+			for (int z = localZ; z < localZ + HALF_LOD_SCALE; ++z)
+			{
+				const char* cubeRow = chunk.getCubeRowWithoutBoundsCheck(y, z);
+				for (int x = localX; x < localX + HALF_LOD_SCALE; ++x)
+				{
+					eCubeType cubeType = static_cast<eCubeType>(cubeRow[x]);
+					const CubeTypeProperties& properties = getCubeTypeProperties(cubeType);
+					if (properties.opaque)
+					{
+						return cubeType;
+					}
+					else if (isLeaves(properties))
+					{
+						transparentCubeType = cubeType;
+					}
+					else if (properties.meshType == eCubeMeshType::Liquid && transparentCubeType == eCubeType::Air)
+					{
+						transparentCubeType = cubeType;
+					}
+				}
+			}
 		}
 
-		if (isFacingTransparentCube({ position.x + 1, position.y, position.z }, chunk))
-		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Right, position, false, shadow);
-		}
+		return transparentCubeType;
+	}
 
-		if (isFacingTransparentCube({ position.x, position.y, position.z + 1 }, chunk))
+	//Apron cells only hide faces when the neighbouring chunk is opaque throughout them at any level of detail
+	eCubeType getDownsampledApronCubeType(const Chunk& chunk, int localX, int localY, int localZ)
+	{
+		if (localY > chunk.getMaxHeight())
 		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Front, position, false, shadow);
+			return eCubeType::Air;
 		}
 
-		if (isFacingTransparentCube({ position.x, position.y, position.z - 1 }, chunk))
+		for (int y = localY; y < localY + HALF_LOD_SCALE; ++y)
 		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Back, position, false, shadow);
+			for (int z = localZ; z < localZ + HALF_LOD_SCALE; ++z)
+			{
+				const char* cubeRow = chunk.getCubeRowWithoutBoundsCheck(y, z);
+				for (int x = localX; x < localX + HALF_LOD_SCALE; ++x)
+				{
+					if (!getCubeTypeProperties(static_cast<eCubeType>(cubeRow[x])).opaque)
+					{
+						return eCubeType::Air;
+					}
+				}
+			}
 		}
 
-		if (isFacingTransparentCube({ position.x, position.y - 1, position.z}, chunk))
-		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Bottom, position, false, shadow);
-		}
+		return eCubeType::Stone;
+	}
 
-		if (cubeType == eCubeType::LogTop)
-		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Top, position, false, shadow);
-		}
-		else
+	//Height of the highest opaque cube or leaves in the column - minus one when there are none
+	int getGroundHeight(const Chunk& chunk, int localX, int localZ, eCubeType& cubeType)
+	{
+		for (int y = chunk.getMaxHeight(); y >= 0; --y)
 		{
-			if (position.y == Globals::CHUNK_HEIGHT - 1 ||
-				isFacingTransparentCube({ position.x, position.y + 1, position.z }, chunk))
+			cubeType = static_cast<eCubeType>(chunk.getCubeRowWithoutBoundsCheck(y, localZ)[localX]);
+			const CubeTypeProperties& properties = getCubeTypeProperties(cubeType);
+			if (properties.opaque || isLeaves(properties))
 			{
-				addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Top, position, false, shadow);
+				return y;
 			}
 		}
-	}
+
+		cubeType = eCubeType::Air;
+		return -1;
 	}
 }
 
-void generateChunkOuterCubeMesh(const glm::ivec3& position, const Chunk& chunk, const NeighbouringChunks& neighbouringChunks, eCubeType cubeType, VertexArray& chunkMesh)
+void copyToPaddedChunk(const Chunk& chunk, const NeighbouringChunks& neighbouringChunks);
+void buildChunkRowMasks();
+void generateDownsampledChunkMesh(const Chunk& chunk, const NeighbouringChunks& neighbouringChunks);
+void generateHeightmapChunkMesh(const Chunk& chunk, const NeighbouringChunks& neighbouringChunks, int scale);
+void addScaledCubeFace(ChunkMeshScratchBuffer& vertexBuffer, eCubeType cubeType, eCubeSide cubeSide, const glm::vec3& position,
+	const glm::vec3& size, bool transparent);
+void generateChunkRowMeshes(const glm::ivec3& chunkStartingPosition);
+void generateDownsampledChunkMesh(const Chunk& chunk, const NeighbouringChunks& neighbouringChunks)
 {
-	assert(chunk.isPositionInBounds(position));
-
-	switch (cubeType)
+	const Chunk& leftChunk = neighbouringChunks.chunks[static_cast<int>(eDirection::Left)];
+	const Chunk& rightChunk = neighbouringChunks.chunks[static_cast<int>(eDirection::Right)];
+	const Chunk& forwardChunk = neighbouringChunks.chunks[static_cast<int>(eDirection::Forward)];
+	const Chunk& backChunk = neighbouringChunks.chunks[static_cast<int>(eDirection::Back)];
+	constexpr int CELLS_WIDTH = DOWNSAMPLED_CHUNK_WIDTH - 2;
+	constexpr int CELLS_DEPTH = DOWNSAMPLED_CHUNK_DEPTH - 2;
+
+	//Cells above the chunk's highest cube are never read other than the row directly above it
+	int maxCellY = chunk.getMaxHeight() / HALF_LOD_SCALE;
+	for (int cellZ = 0; cellZ < DOWNSAMPLED_CHUNK_DEPTH; ++cellZ)
 	{
-	case eCubeType::Water:
-		if (isFacingOpaqueCube({ position.x, position.y + 1, position.z }, chunk))
+		for (int cellY = 0; cellY <= maxCellY; ++cellY)
 		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Top, { position.x, position.y - WATER_OFFSET_Y, position.z }, true);
-		}
-		break;
-	case eCubeType::Leaves:
-	{
-		//Left Face
-		glm::ivec3 leftPosition(position.x - 1, position.y, position.z);
-		if (chunk.isPositionInBounds(leftPosition))
-		{
-			if (isFacingOpaqueCube(leftPosition, chunk))
+			int localY = cellY * HALF_LOD_SCALE;
+			char* cellRow = &downsampledChunk[convertToDownsampledIndex(0, cellY, cellZ)];
+			if (cellZ == 0 || cellZ == DOWNSAMPLED_CHUNK_DEPTH - 1)
 			{
-				addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Left, position, true);
+				const Chunk& neighbouringChunk = cellZ == 0 ? backChunk : forwardChunk;
+				int localZ = cellZ == 0 ? Globals::CHUNK_DEPTH - HALF_LOD_SCALE : 0;
+				for (int cellX = 1; cellX <= CELLS_WIDTH; ++cellX)
+				{
+					cellRow[cellX] = static_cast<char>(getDownsampledApronCubeType(neighbouringChunk, (cellX - 1) * HALF_LOD_SCALE, localY, localZ));
+				}
+
+				continue;
 			}
-		}
-		else if (isFacingOpaqueCube(leftPosition, neighbouringChunks.chunks[static_cast<int>(eDirection::Left)]))
-		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Left, position, true);
-		}
 
-		//Right Face
-		glm::ivec3 rightPosition(position.x + 1, position.y, position.z);
-		if (chunk.isPositionInBounds(rightPosition))
-		{
-			if (isFacingOpaqueCube(rightPosition, chunk))
+			int localZ = (cellZ - 1) * HALF_LOD_SCALE;
+			cellRow[0] = static_cast<char>(getDownsampledApronCubeType(leftChunk, Globals::CHUNK_WIDTH - HALF_LOD_SCALE, localY, localZ));
+			for (int cellX = 1; cellX <= CELLS_WIDTH; ++cellX)
 			{
-				addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Right, position, true);
+				cellRow[cellX] = static_cast<char>(getDownsampledCubeType(chunk, (cellX - 1) * HALF_LOD_SCALE, localY, localZ));
 			}
+			cellRow[DOWNSAMPLED_CHUNK_WIDTH - 1] = static_cast<char>(getDownsampledApronCubeType(rightChunk, 0, localY, localZ));
 		}
-		else if (isFacingOpaqueCube(rightPosition, neighbouringChunks.chunks[static_cast<int>(eDirection::Right)]))
+
+		if (maxCellY + 1 < DOWNSAMPLED_CHUNK_HEIGHT)
 		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Right, position, true);
+			std::memset(&downsampledChunk[convertToDownsampledIndex(0, maxCellY + 1, cellZ)], static_cast<char>(eCubeType::Air), DOWNSAMPLED_CHUNK_WIDTH);
 		}
+	}
 
-		//Forward Face
-		glm::ivec3 forwardPosition(position.x, position.y, position.z + 1);
-		if (chunk.isPositionInBounds(forwardPosition))
+	const glm::vec3 cellSize(static_cast<float>(HALF_LOD_SCALE));
+	for (int cellZ = 1; cellZ <= CELLS_DEPTH; ++cellZ)
+	{
+		for (int cellY = 0; cellY <= maxCellY; ++cellY)
 		{
-			if (isFacingOpaqueCube(forwardPosition, chunk))
+			for (int cellX = 1; cellX <= CELLS_WIDTH; ++cellX)
 			{
-				addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Front, position, true);
+				eCubeType cubeType = static_cast<eCubeType>(downsampledChunk[convertToDownsampledIndex(cellX, cellY, cellZ)]);
+				if (cubeType == eCubeType::Air)
+				{
+					continue;
+				}
+
+				const CubeTypeProperties& properties = getCubeTypeProperties(cubeType);
+				glm::vec3 position(chunk.getStartingPosition().x + (cellX - 1) * HALF_LOD_SCALE, cellY * HALF_LOD_SCALE,
+					chunk.getStartingPosition().z + (cellZ - 1) * HALF_LOD_SCALE);
+				eCubeType aboveCubeType = eCubeType::Air;
+				if (cellY + 1 < DOWNSAMPLED_CHUNK_HEIGHT)
+				{
+					aboveCubeType = static_cast<eCubeType>(downsampledChunk[convertToDownsampledIndex(cellX, cellY + 1, cellZ)]);
+				}
+
+				if (properties.meshType == eCubeMeshType::Liquid)
+				{
+					const CubeTypeProperties& aboveProperties = getCubeTypeProperties(aboveCubeType);
+					if (!aboveProperties.opaque && !aboveProperties.transparent)
+					{
+						addScaledCubeFace(transparentScratchBuffer, cubeType, eCubeSide::Top,
+							{ position.x, position.y - WATER_OFFSET_Y, position.z }, cellSize, true);
+					}
+
+					continue;
+				}
+
+				const std::array<std::pair<eCubeSide, eCubeType>, 6> adjacentCubeTypes =
+				{{
+					{ eCubeSide::Left, static_cast<eCubeType>(downsampledChunk[convertToDownsampledIndex(cellX - 1, cellY, cellZ)]) },
+					{ eCubeSide::Right, static_cast<eCubeType>(downsampledChunk[convertToDownsampledIndex(cellX + 1, cellY, cellZ)]) },
+					{ eCubeSide::Back, static_cast<eCubeType>(downsampledChunk[convertToDownsampledIndex(cellX, cellY, cellZ - 1)]) },
+					{ eCubeSide::Front, static_cast<eCubeType>(downsampledChunk[convertToDownsampledIndex(cellX, cellY, cellZ + 1)]) },
+					{ eCubeSide::Top, aboveCubeType },
+					{ eCubeSide::Bottom, cellY > 0 ? static_cast<eCubeType>(downsampledChunk[convertToDownsampledIndex(cellX, cellY - 1, cellZ)]) :
+						eCubeType::Stone }
+				}};
+
+				ChunkMeshScratchBuffer& vertexBuffer = properties.opaque ? opaqueScratchBuffer : transparentScratchBuffer;
+				for (const auto& adjacentCubeType : adjacentCubeTypes)
+				{
+					const CubeTypeProperties& adjacentProperties = getCubeTypeProperties(adjacentCubeType.second);
+					if (!adjacentProperties.opaque && (properties.opaque || !adjacentProperties.transparent))
+					{
+						addScaledCubeFace(vertexBuffer, cubeType, adjacentCubeType.first, position, cellSize, !properties.opaque);
+					}
+				}
 			}
 		}
-		else if (isFacingOpaqueCube(forwardPosition, neighbouringChunks.chunks[static_cast<int>(eDirection::Forward)]))
+	}
+}
+
+//Each cell is a column as high as its highest ground with walls down to the cells around it
+//Walls facing a neighbouring chunk go down to its lowest column along that edge so no level of detail can show a gap
+void generateHeightmapChunkMesh(const Chunk& chunk, const NeighbouringChunks& neighbouringChunks, int scale)
+{
+	constexpr int MAX_CELLS = Globals::CHUNK_WIDTH * Globals::CHUNK_DEPTH;
+	assert(scale > 1 && Globals::CHUNK_WIDTH % scale == 0 && Globals::CHUNK_DEPTH % scale == 0);
+	const int cellsWidth = Globals::CHUNK_WIDTH / scale;
+	const int cellsDepth = Globals::CHUNK_DEPTH / scale;
+
+	std::array<int, MAX_CELLS> cellHeights;
+	std::array<eCubeType, MAX_CELLS> cellCubeTypes;
+	for (int cellZ = 0; cellZ < cellsDepth; ++cellZ)
+	{
+		for (int cellX = 0; cellX < cellsWidth; ++cellX)
 		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Front, position, true);
+			int& cellHeight = cellHeights[cellZ * cellsWidth + cellX];
+			eCubeType& cellCubeType = cellCubeTypes[cellZ * cellsWidth + cellX];
+			cellHeight = -1;
+			cellCubeType = eCubeType::Air;
+			for (int z = cellZ * scale; z < (cellZ + 1) * scale; ++z)
+			{
+				for (int x = cellX * scale; x < (cellX + 1) * scale; ++x)
+				{
+					eCubeType cubeType;
+					int groundHeight = getGroundHeight(chunk, x, z, cubeType);
+					if (groundHeight > cellHeight)
+					{
+						cellHeight = groundHeight;
+						cellCubeType = cubeType;
+					}
+				}
+			}
 		}
+	}
 
-		//Back Face
-		glm::ivec3 backPosition(position.x, position.y, position.z - 1);
-		if (chunk.isPositionInBounds(backPosition))
+	//Lowest column of each neighbouring chunk along every cell edge facing it
+	std::array<std::array<int, Globals::CHUNK_WIDTH>, static_cast<size_t>(eDirection::Max) + 1> edgeHeights;
+	for (int direction = 0; direction <= static_cast<int>(eDirection::Max); ++direction)
+	{
+		const Chunk& neighbouringChunk = neighbouringChunks.chunks[direction];
+		int cells = direction == static_cast<int>(eDirection::Left) || direction == static_cast<int>(eDirection::Right) ? cellsDepth : cellsWidth;
+		for (int cell = 0; cell < cells; ++cell)
 		{
-			if (isFacingOpaqueCube(backPosition, chunk))
+			int edgeHeight = Globals::CHUNK_HEIGHT;
+			for (int i = cell * scale; i < (cell + 1) * scale; ++i)
 			{
-				addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Back, position, true);
+				eCubeType cubeType;
+				switch (static_cast<eDirection>(direction))
+				{
+				case eDirection::Left:
+					edgeHeight = std::min(edgeHeight, getGroundHeight(neighbouringChunk, Globals::CHUNK_WIDTH - 1, i, cubeType));
+					break;
+				case eDirection::Right:
+					edgeHeight = std::min(edgeHeight, getGroundHeight(neighbouringChunk, 0, i, cubeType));
+					break;
+				case eDirection::Forward:
+					edgeHeight = std::min(edgeHeight, getGroundHeight(neighbouringChunk, i, 0, cubeType));
+					break;
+				case eDirection::Back:
+					edgeHeight = std::min(edgeHeight, getGroundHeight(neighbouringChunk, i, Globals::CHUNK_DEPTH - 1, cubeType));
+					break;
+				default:
+					assert(false);
+				}
 			}
+
+			edgeHeights[direction][cell] = edgeHeight;
 		}
-		else if (isFacingOpaqueCube(backPosition, neighbouringChunks.chunks[static_cast<int>(eDirection::Back)]))
+	}
+
+	for (int cellZ = 0; cellZ < cellsDepth; ++cellZ)
+	{
+		for (int cellX = 0; cellX < cellsWidth; ++cellX)
 		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Back, position, true);
-		}
+			int cellHeight = cellHeights[cellZ * cellsWidth + cellX];
+			eCubeType cubeType = cellCubeTypes[cellZ * cellsWidth + cellX];
+			glm::vec3 position(chunk.getStartingPosition().x + cellX * scale, 0.0f, chunk.getStartingPosition().z + cellZ * scale);
+			if (cellHeight < Globals::WATER_MAX_HEIGHT)
+			{
+				addScaledCubeFace(transparentScratchBuffer, eCubeType::Water, eCubeSide::Top,
+					{ position.x, Globals::WATER_MAX_HEIGHT - WATER_OFFSET_Y, position.z }, { scale, 1.0f, scale }, true);
+			}
 
+			if (cubeType == eCubeType::Air)
+			{
+				continue;
+			}
 
-		//Top Face
-		if (position.y == Globals::CHUNK_HEIGHT - 1 ||
-			isFacingOpaqueCube({ position.x, position.y + 1, position.z }, chunk))
-		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Top, position, true);
-		}
+			bool transparent = !getCubeTypeProperties(cubeType).opaque;
+			ChunkMeshScratchBuffer& vertexBuffer = transparent ? transparentScratchBuffer : opaqueScratchBuffer;
+			addScaledCubeFace(vertexBuffer, cubeType, eCubeSide::Top, { position.x, cellHeight, position.z }, { scale, 1.0f, scale }, transparent);
 
-		//Bottom Face
-		if (position.y > 0 && isFacingOpaqueCube({ position.x, position.y - 1, position.z }, chunk))
-		{
-			addCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, eCubeSide::Bottom, position, true);
+			const std::array<std::pair<eCubeSide, int>, 4> adjacentHeights =
+			{{
+				{ eCubeSide::Left, cellX > 0 ? cellHeights[cellZ * cellsWidth + cellX - 1] : edgeHeights[static_cast<int>(eDirection::Left)][cellZ] },
+				{ eCubeSide::Right, cellX < cellsWidth - 1 ? cellHeights[cellZ * cellsWidth + cellX + 1] : edgeHeights[static_cast<int>(eDirection::Right)][cellZ] },
+				{ eCubeSide::Back, cellZ > 0 ? cellHeights[(cellZ - 1) * cellsWidth + cellX] : edgeHeights[static_cast<int>(eDirection::Back)][cellX] },
+				{ eCubeSide::Front, cellZ < cellsDepth - 1 ? cellHeights[(cellZ + 1) * cellsWidth + cellX] : edgeHeights[static_cast<int>(eDirection::Forward)][cellX] }
+			}};
+
+			for (const auto& adjacentHeight : adjacentHeights)
+			{
+				if (adjacentHeight.second < cellHeight)
+				{
+					addScaledCubeFace(vertexBuffer, cubeType, adjacentHeight.first, { position.x, adjacentHeight.second + 1, position.z },
+						{ scale, cellHeight - adjacentHeight.second, scale }, transparent);
+				}
+			}
 		}
 	}
+}
+
+void addCubeFaces(ChunkMeshScratchBuffer& vertexBuffer, uint64_t faceMask, eCubeSide cubeSide, const char* cubeRow,
+	const glm::ivec3& rowPosition, bool transparent, uint64_t shadowMask = 0);
+void addCubeFace(ChunkMeshScratchBuffer& vertexBuffer, eCubeType cubeType, eCubeSide cubeSide, const glm::vec3& cubePosition,
+	bool transparent, bool shadow = false);
+void addDiagonalCubeFace(ChunkMeshScratchBuffer& vertexBuffer, eCubeType cubeType, const glm::ivec3& cubePosition,
+	const std::array<glm::vec3, 4>& diagonalFace, bool shadow = false);
+
+void MeshGenerator::generateVoxelSelectionMesh(VertexBuffer& mesh, const glm::vec3& position)
+{
+	addVoxelSelectionCubeFace(mesh, eCubeSide::Left, position);
+	addVoxelSelectionCubeFace(mesh, eCubeSide::Right, position);
+	addVoxelSelectionCubeFace(mesh, eCubeSide::Top, position);
+	addVoxelSelectionCubeFace(mesh, eCubeSide::Bottom, position);
+	addVoxelSelectionCubeFace(mesh, eCubeSide::Front, position);
+	addVoxelSelectionCubeFace(mesh, eCubeSide::Back, position);
+
+	mesh.bindToVAO = true;
+}
+
+void MeshGenerator::generateDestroyBlockMesh(VertexBuffer& destroyBlockMesh, eDestroyCubeIndex destroyCubeIndex, const glm::vec3& position)
+{
+	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Left, destroyCubeIndex, position);
+	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Right, destroyCubeIndex, position);
+	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Top, destroyCubeIndex, position);
+	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Bottom, destroyCubeIndex, position);
+	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Front, destroyCubeIndex, position);
+	addDestroyBlockCubeFace(destroyBlockMesh, eCubeSide::Back, destroyCubeIndex, position);
+
+	destroyBlockMesh.bindToVAO = true;
+}
+
+void MeshGenerator::generateChunkMesh(VertexArray& chunkMesh, const Chunk& chunk, const NeighbouringChunks& neighbouringChunks,
+	eChunkMeshLOD chunkMeshLOD)
+{
+	PROFILE_SCOPE("MeshGenerator::generateChunkMesh");
+	static MetricHistogram& chunkMeshGenerationTime = Metrics::getHistogram("Chunk mesh generation time (us)");
+	static MetricCounter& generatedChunkMeshes = Metrics::getCounter("Chunk meshes generated");
+	ScopedMetricTimer chunkMeshGenerationTimer(chunkMeshGenerationTime);
+	generatedChunkMeshes.add();
+	size_t scratchCapacity = opaqueScratchBuffer.getCapacityInBytes() + transparentScratchBuffer.getCapacityInBytes();
+	opaqueScratchBuffer.clear();
+	transparentScratchBuffer.clear();
+
+	switch (chunkMeshLOD)
+	{
+	case eChunkMeshLOD::Full:
+		copyToPaddedChunk(chunk, neighbouringChunks);
+		buildChunkRowMasks();
+		generateChunkRowMeshes(chunk.getStartingPosition());
+		break;
+	case eChunkMeshLOD::Half:
+		generateDownsampledChunkMesh(chunk, neighbouringChunks);
+		break;
+	case eChunkMeshLOD::Quarter:
+	case eChunkMeshLOD::Eighth:
+		generateHeightmapChunkMesh(chunk, neighbouringChunks, getChunkMeshLODScale(chunkMeshLOD));
 		break;
-	case eCubeType::TallGrass:
-	case eCubeType::Shrub:
+	default:
+		assert(false);
+	}
+
+	opaqueScratchBuffer.handOff(chunkMesh.m_opaqueVertexBuffer);
+	transparentScratchBuffer.handOff(chunkMesh.m_transparentVertexBuffer);
+
+	if (!chunkMesh.m_opaqueVertexBuffer.indicies.empty())
 	{
-		bool shadow = chunk.isCubeBelowCovering(position);
+		chunkMesh.m_opaqueVertexBuffer.bindToVAO = true;
+	}
 
-		addDiagonalCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, position, FIRST_DIAGONAL_FACE, shadow);
-		addDiagonalCubeFace(chunkMesh.m_transparentVertexBuffer, cubeType, position, SECOND_DIAGONAL_FACE, shadow);
+	if (!chunkMesh.m_transparentVertexBuffer.indicies.empty())
+	{
+		chunkMesh.m_transparentVertexBuffer.bindToVAO = true;
 	}
 
-		break;
-	default:
+	size_t scratchGrowth = opaqueScratchBuffer.getCapacityInBytes() + transparentScratchBuffer.getCapacityInBytes() - scratchCapacity;
+	size_t handOffSize = opaqueScratchBuffer.getSizeInBytes() + transparentScratchBuffer.getSizeInBytes();
+	++chunkMeshesGenerated;
+	scratchBytesAllocated += scratchGrowth;
+	handOffBytes += handOffSize;
+	lastMeshScratchBytesAllocated = scratchGrowth;
+	lastMeshHandOffBytes = handOffSize;
+}
+
+MeshGenerator::MeshAllocationStats MeshGenerator::getMeshAllocationStats()
+{
+	MeshAllocationStats meshAllocationStats;
+	meshAllocationStats.chunkMeshesGenerated = chunkMeshesGenerated;
+	meshAllocationStats.scratchBytesAllocated = scratchBytesAllocated;
+	meshAllocationStats.handOffBytes = handOffBytes;
+	meshAllocationStats.lastMeshScratchBytesAllocated = lastMeshScratchBytesAllocated;
+	meshAllocationStats.lastMeshHandOffBytes = lastMeshHandOffBytes;
+
+	return meshAllocationStats;
+}
+
+void MeshGenerator::generatePickUpMesh(VertexBuffer& pickUpMesh, eCubeType cubeType)
+{
+	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Left);
+	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Right);
+	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Top);
+	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Bottom);
+	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Front);
+	addPickupCubeFace(pickUpMesh, cubeType, eCubeSide::Back);
+
+	pickUpMesh.bindToVAO = true;
+}
+
+void copyToPaddedChunk(const Chunk& chunk, const NeighbouringChunks& neighbouringChunks)
+{
+	const Chunk& leftChunk = neighbouringChunks.chunks[static_cast<int>(eDirection::Left)];
+	const Chunk& rightChunk = neighbouringChunks.chunks[static_cast<int>(eDirection::Right)];
+	const Chunk& forwardChunk = neighbouringChunks.chunks[static_cast<int>(eDirection::Forward)];
+	const Chunk& backChunk = neighbouringChunks.chunks[static_cast<int>(eDirection::Back)];
+
+	for (int y = 0; y < Globals::CHUNK_HEIGHT; ++y)
 	{
-		bool shadow = chunk.isCubeBelowCovering(position);
+		char* backRow = &paddedChunk[convertToPaddedIndex(0, y, 0)];
+		backRow[0] = static_cast<char>(eCubeType::Air);
+		std::memcpy(backRow + 1, backChunk.getCubeRowWithoutBoundsCheck(y, Globals::CHUNK_DEPTH - 1), Globals::CHUNK_WIDTH);
+		backRow[PADDED_CHUNK_WIDTH - 1] = static_cast<char>(eCubeType::Air);
+
+		char* forwardRow = &paddedChunk[convertToPaddedIndex(0, y, PADDED_CHUNK_DEPTH - 1)];
+		forwardRow[0] = static_cast<char>(eCubeType::Air);
+		std::memcpy(forwardRow + 1, forwardChunk.getCubeRowWithoutBoundsCheck(y, 0), Globals::CHUNK_WIDTH);
+		forwardRow[PADDED_CHUNK_WIDTH - 1] = static_cast<char>(eCubeType::Air);
+	}
 
-		//Left Face
-		glm::ivec3 leftPosition(position.x - 1, position.y, position.z);
-		if (chunk.isPositionInBounds(leftPosition))
+	for (int z = 0; z < Globals::CHUNK_DEPTH; ++z)
+	{
+		for (int y = 0; y < Globals::CHUNK_HEIGHT; ++y)
 		{
-			if (isFacingTransparentCube(leftPosition, chunk))
-			{
-				addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Left, position, false, shadow);
-			}
+			char* paddedRow = &paddedChunk[convertToPaddedIndex(0, y, z + 1)];
+			paddedRow[0] = leftChunk.getCubeRowWithoutBoundsCheck(y, z)[Globals::CHUNK_WIDTH - 1];
+			std::memcpy(paddedRow + 1, chunk.getCubeRowWithoutBoundsCheck(y, z), Globals::CHUNK_WIDTH);
+			paddedRow[PADDED_CHUNK_WIDTH - 1] = rightChunk.getCubeRowWithoutBoundsCheck(y, z)[0];
 		}
-		else if (isFacingTransparentCube(leftPosition, neighbouringChunks.chunks[static_cast<int>(eDirection::Left)]))
+	}
+}
+
+void buildChunkRowMasks()
+{
+	for (int z = 0; z < PADDED_CHUNK_DEPTH; ++z)
+	{
+		for (int y = 0; y < Globals::CHUNK_HEIGHT; ++y)
 		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Left, position, false, shadow);
+			chunkRowMasks[z][y] = getCubeRowMasks(&paddedChunk[convertToPaddedIndex(0, y, z)]);
 		}
+	}
+}
 
-		//Right Face
-		glm::ivec3 rightPosition(position.x + 1, position.y, position.z);
-		if (chunk.isPositionInBounds(rightPosition))
+void generateChunkRowMeshes(const glm::ivec3& chunkStartingPosition)
+{
+	for (int z = 1; z < PADDED_CHUNK_DEPTH - 1; ++z)
+	{
+		for (int y = 0; y < Globals::CHUNK_HEIGHT; ++y)
 		{
-			if (isFacingTransparentCube(rightPosition, chunk))
+			const CubeRowMasks& row = chunkRowMasks[z][y];
+			uint64_t opaque = row.opaque & CHUNK_ROW_MASK;
+			uint64_t leaves = row.leaves & CHUNK_ROW_MASK;
+			uint64_t water = row.water & CHUNK_ROW_MASK;
+			uint64_t plant = row.plant & CHUNK_ROW_MASK;
+			if ((opaque | leaves | water | plant) == 0)
 			{
-				addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Right, position, false, shadow);
+				continue;
 			}
-		}
-		else if (isFacingTransparentCube(rightPosition, neighbouringChunks.chunks[static_cast<int>(eDirection::Right)]))
-		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Right, position, false, shadow);
-		}
 
-		//Forward Face
-		glm::ivec3 forwardPosition(position.x, position.y, position.z + 1);
-		if (chunk.isPositionInBounds(forwardPosition))
-		{
-			if (isFacingTransparentCube(forwardPosition, chunk))
+			//Bit x of each neighbour mask describes the cube adjacent to x on that side
+			const CubeRowMasks& forwardRow = chunkRowMasks[z + 1][y];
+			const CubeRowMasks& backRow = chunkRowMasks[z - 1][y];
+
+			//Nothing is meshed against the top of the world and the bottom of the world is never visible
+			uint64_t aboveOpaque = 0;
+			uint64_t aboveTransparent = 0;
+			if (y < Globals::CHUNK_HEIGHT - 1)
 			{
-				addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Front, position, false, shadow);
+				aboveOpaque = chunkRowMasks[z][y + 1].opaque;
+				aboveTransparent = chunkRowMasks[z][y + 1].transparent;
 			}
-		}
-		else if (isFacingTransparentCube(forwardPosition, neighbouringChunks.chunks[static_cast<int>(eDirection::Forward)]))
-		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Front, position, false, shadow);
-		}
 
-		//Back Face
-		glm::ivec3 backPosition(position.x, position.y, position.z - 1);
-		if (chunk.isPositionInBounds(backPosition))
-		{
-			if (isFacingTransparentCube(backPosition, chunk))
+			uint64_t belowOpaque = FULL_CUBE_ROW_MASK;
+			uint64_t belowTransparent = FULL_CUBE_ROW_MASK;
+			if (y > 0)
 			{
-				addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Back, position, false, shadow);
+				belowOpaque = chunkRowMasks[z][y - 1].opaque;
+				belowTransparent = chunkRowMasks[z][y - 1].transparent;
 			}
-		}
-		else if (isFacingTransparentCube(backPosition, neighbouringChunks.chunks[static_cast<int>(eDirection::Back)]))
-		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Back, position, false, shadow);
-		}
 
-		//Bottom Face
-		if (position.y > 0 && isFacingTransparentCube({ position.x, position.y - 1, position.z }, chunk))
-		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Bottom, position, false, shadow);
-		}
+			uint64_t shadowMask = 0;
+			for (int shadowY = y + 1; shadowY <= y + Globals::MAX_SHADOW_HEIGHT && shadowY < Globals::CHUNK_HEIGHT - 1; ++shadowY)
+			{
+				shadowMask |= chunkRowMasks[z][shadowY].leaves;
+			}
 
-		if (cubeType == eCubeType::LogTop)
-		{
-			addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Top, position, false, shadow);
-		}
-		else
-		{
-			//Top Face
-			if (position.y == Globals::CHUNK_HEIGHT - 1 ||
-				isFacingTransparentCube({ position.x, position.y + 1, position.z }, chunk))
+			const char* cubeRow = &paddedChunk[convertToPaddedIndex(0, y, z)];
+			glm::ivec3 rowPosition(chunkStartingPosition.x - 1, chunkStartingPosition.y + y, chunkStartingPosition.z + z - 1);
+
+			if (opaque)
+			{
+				ChunkMeshScratchBuffer& vertexBuffer = opaqueScratchBuffer;
+				addCubeFaces(vertexBuffer, opaque & ~(row.opaque << 1), eCubeSide::Left, cubeRow, rowPosition, false, shadowMask);
+				addCubeFaces(vertexBuffer, opaque & ~(row.opaque >> 1), eCubeSide::Right, cubeRow, rowPosition, false, shadowMask);
+				addCubeFaces(vertexBuffer, opaque & ~forwardRow.opaque, eCubeSide::Front, cubeRow, rowPosition, false, shadowMask);
+				addCubeFaces(vertexBuffer, opaque & ~backRow.opaque, eCubeSide::Back, cubeRow, rowPosition, false, shadowMask);
+				addCubeFaces(vertexBuffer, opaque & ~belowOpaque, eCubeSide::Bottom, cubeRow, rowPosition, false, shadowMask);
+				addCubeFaces(vertexBuffer, (opaque & ~aboveOpaque) | (row.topFaceAlwaysVisible & CHUNK_ROW_MASK), eCubeSide::Top, cubeRow, rowPosition, false, shadowMask);
+			}
+
+			if (leaves)
+			{
+				ChunkMeshScratchBuffer& vertexBuffer = transparentScratchBuffer;
+				addCubeFaces(vertexBuffer, leaves & ~(row.transparent << 1), eCubeSide::Left, cubeRow, rowPosition, true);
+				addCubeFaces(vertexBuffer, leaves & ~(row.transparent >> 1), eCubeSide::Right, cubeRow, rowPosition, true);
+				addCubeFaces(vertexBuffer, leaves & ~forwardRow.transparent, eCubeSide::Front, cubeRow, rowPosition, true);
+				addCubeFaces(vertexBuffer, leaves & ~backRow.transparent, eCubeSide::Back, cubeRow, rowPosition, true);
+				addCubeFaces(vertexBuffer, leaves & ~belowTransparent, eCubeSide::Bottom, cubeRow, rowPosition, true);
+				addCubeFaces(vertexBuffer, leaves & ~aboveTransparent, eCubeSide::Top, cubeRow, rowPosition, true);
+			}
+
+			uint64_t waterMask = water & ~aboveTransparent;
+			while (waterMask)
+			{
+				int x = popLowestSetBit(waterMask);
+				addCubeFace(transparentScratchBuffer, eCubeType::Water, eCubeSide::Top,
+					{ rowPosition.x + x, rowPosition.y - WATER_OFFSET_Y, rowPosition.z }, true);
+			}
+
+			while (plant)
 			{
-				addCubeFace(chunkMesh.m_opaqueVertexBuffer, cubeType, eCubeSide::Top, position, false, shadow);
+				int x = popLowestSetBit(plant);
+				eCubeType cubeType = static_cast<eCubeType>(cubeRow[x]);
+				glm::ivec3 position(rowPosition.x + x, rowPosition.y, rowPosition.z);
+				bool shadow = (shadowMask >> x) & 1u;
+
+				addDiagonalCubeFace(transparentScratchBuffer, cubeType, position, FIRST_DIAGONAL_FACE, shadow);
+				addDiagonalCubeFace(transparentScratchBuffer, cubeType, position, SECOND_DIAGONAL_FACE, shadow);
 			}
 		}
 	}
+}
+
+void addCubeFaces(ChunkMeshScratchBuffer& vertexBuffer, uint64_t faceMask, eCubeSide cubeSide, const char* cubeRow,
+	const glm::ivec3& rowPosition, bool transparent, uint64_t shadowMask)
+{
+	while (faceMask)
+	{
+		int x = popLowestSetBit(faceMask);
+		addCubeFace(vertexBuffer, static_cast<eCubeType>(cubeRow[x]), cubeSide, { rowPosition.x + x, rowPosition.y, rowPosition.z },
+			transparent, (shadowMask >> x) & 1u);
 	}
 }
 
-void addCubeFace(VertexBuffer& vertexBuffer, eCubeType cubeType, eCubeSide cubeSide, const glm::vec3& cubePosition, bool transparent, bool shadow)
+void addCubeFace(ChunkMeshScratchBuffer& vertexBuffer, eCubeType cubeType, eCubeSide cubeSide, const glm::vec3& cubePosition, bool transparent, bool shadow)
 {
 	glm::vec3 position = cubePosition;
 	switch (cubeSide)
@@ -1069,7 +1334,42 @@ void addCubeFace(VertexBuffer& vertexBuffer, eCubeType cubeType, eCubeSide cubeS
 	vertexBuffer.elementBufferIndex += CUBE_FACE_INDICIE_COUNT;
 }
 
-void addDiagonalCubeFace(VertexBuffer& vertexBuffer, eCubeType cubeType, const glm::ivec3& cubePosition, const std::array<glm::vec3, 4>& diagonalFace, bool shadow)
+//Textures repeat across the face once per cube
+void addScaledCubeFace(ChunkMeshScratchBuffer& vertexBuffer, eCubeType cubeType, eCubeSide cubeSide, const glm::vec3& position,
+	const glm::vec3& size, bool transparent)
+{
+	for (const glm::vec3& i : getCubeFace(cubeSide))
+	{
+		vertexBuffer.positions.emplace_back(position + i * size);
+		vertexBuffer.lightIntensityVertices.push_back(transparent ? DEFAULT_LIGHTING_INTENSITY : getCubeFaceLightingIntensity(cubeSide));
+	}
+
+	glm::vec2 textureSize(size.x, size.y);
+	if (cubeSide == eCubeSide::Left || cubeSide == eCubeSide::Right)
+	{
+		textureSize.x = size.z;
+	}
+	else if (cubeSide == eCubeSide::Top || cubeSide == eCubeSide::Bottom)
+	{
+		textureSize.y = size.z;
+	}
+
+	eTerrainTextureLayer textureLayer = getCubeTypeProperties(cubeType).textureLayers[static_cast<int>(cubeSide)];
+	assert(textureLayer != eTerrainTextureLayer::Error);
+	for (const auto& i : TEXT_COORDS)
+	{
+		vertexBuffer.textCoords.emplace_back(i.x * textureSize.x, i.y * textureSize.y, static_cast<int>(textureLayer));
+	}
+
+	for (unsigned int i : CUBE_FACE_INDICIES)
+	{
+		vertexBuffer.indicies.emplace_back(i + vertexBuffer.elementBufferIndex);
+	}
+
+	vertexBuffer.elementBufferIndex += CUBE_FACE_INDICIE_COUNT;
+}
+
+void addDiagonalCubeFace(ChunkMeshScratchBuffer& vertexBuffer, eCubeType cubeType, const glm::ivec3& cubePosition, const std::array<glm::vec3, 4>& diagonalFace, bool shadow)
 {
 	//Positions
 	glm::ivec3 position = cubePosition;
@@ -1101,30 +1401,4 @@ void addDiagonalCubeFace(VertexBuffer& vertexBuffer, eCubeType cubeType, const g
 	}
 
 	vertexBuffer.elementBufferIndex += CUBE_FACE_INDICIE_COUNT;
-}
-
-bool isFacingTransparentCube(const glm::ivec3& cubePosition, const Chunk& chunk)
-{
-	eCubeType cubeType = static_cast<eCubeType>(chunk.getCubeDetailsWithoutBoundsCheck(cubePosition));
-	if (cubeType != eCubeType::Air)
-	{
-		return Globals::TRANSPARENT_CUBE_TYPES.isMatch(cubeType);
-	}
-	else
-	{
-		return true;
-	}
-}
-
-bool isFacingOpaqueCube(const glm::ivec3& cubePosition, const Chunk& chunk)
-{
-	eCubeType cubeType = static_cast<eCubeType>(chunk.getCubeDetailsWithoutBoundsCheck(cubePosition));
-	if (cubeType != eCubeType::Air)
-	{
-		return Globals::OPAQUE_CUBE_TYPES.isMatch(cubeType);
-	}
-	else
-	{
-		return true;
-	}
-}
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "glm/glm.hpp"
+#include <cstddef>
 
 class Chunk;
 struct VertexArray;
@@ -8,10 +9,36 @@ struct VertexBuffer;
 struct NeighbouringChunks;
 enum class eCubeType;
 enum class eDestroyCubeIndex;
+
+//Each level meshes the chunk at half the resolution of the one before
+enum class eChunkMeshLOD
+{
+	Full = 0,
+	Half,
+	Quarter,
+	Eighth,
+	Max = Eighth
+};
+
 namespace MeshGenerator
 {
+	//Scratch bytes are growth of the reused per thread buffers - zero once every thread has seen its largest chunk mesh
+	//Hand off bytes are copied out of the scratch buffers into the chunk mesh - whether or not the mesh had to grow to take them
+	struct MeshAllocationStats
+	{
+		size_t chunkMeshesGenerated = 0;
+		size_t scratchBytesAllocated = 0;
+		size_t handOffBytes = 0;
+		size_t lastMeshScratchBytesAllocated = 0;
+		size_t lastMeshHandOffBytes = 0;
+	};
+
 	void generateVoxelSelectionMesh(VertexBuffer& mesh, const glm::vec3& position);
 	void generateDestroyBlockMesh(VertexBuffer& destroyBlockMesh, eDestroyCubeIndex destroyCubeIndex, const glm::vec3& position);
-	void generateChunkMesh(VertexArray& chunkMesh, const Chunk& chunk, const NeighbouringChunks& neighbouringChunks);
+	//Half is downsampled from the voxels - Quarter and Eighth only from the height of each column
+	//Edges facing other chunks are never left open for a neighbour at any level of detail to show through
+	void generateChunkMesh(VertexArray& chunkMesh, const Chunk& chunk, const NeighbouringChunks& neighbouringChunks,
+		eChunkMeshLOD chunkMeshLOD = eChunkMeshLOD::Full);
 	void generatePickUpMesh(VertexBuffer& pickUpMesh, eCubeType cubeType);
+	MeshAllocationStats getMeshAllocationStats();
 }
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <assert.h>
+
+namespace
+{
+	struct RegisteredMetric
+	{
+		RegisteredMetric(const std::string& name, eMetricType type)
+			: name(name),
+			type(type),
+			counter(type == eMetricType::Counter ? std::make_unique<MetricCounter>() : nullptr),
+			gauge(type == eMetricType::Gauge ? std::make_unique<MetricGauge>() : nullptr),
+			histogram(type == eMetricType::Histogram ? std::make_unique<MetricHistogram>() : nullptr)
+		{}
+
+		const std::string name;
+		const eMetricType type;
+		const std::unique_ptr<MetricCounter> counter;
+		const std::unique_ptr<MetricGauge> gauge;
+		const std::unique_ptr<MetricHistogram> histogram;
+	};
+
+	std::mutex registeredMetricsMutex;
+	std::vector<std::unique_ptr<RegisteredMetric>> registeredMetrics;
+	std::unordered_map<std::string, size_t> registeredMetricIndicies;
+
+	RegisteredMetric& getRegisteredMetric(const std::string& name, eMetricType type)
+	{
+		std::lock_guard<std::mutex> registeredMetricsLock(registeredMetricsMutex);
+		auto registeredMetricIndex = registeredMetricIndicies.find(name);
+		if (registeredMetricIndex != registeredMetricIndicies.cend())
+		{
+			RegisteredMetric& registeredMetric = *registeredMetrics[registeredMetricIndex->second];
+			assert(registeredMetric.type == type);
+			return registeredMetric;
+		}
+
+		registeredMetricIndicies.emplace(name, registeredMetrics.size());
+		registeredMetrics.emplace_back(std::make_unique<RegisteredMetric>(name, type));
+		return *registeredMetrics.back();
+	}
+
+	size_t getBucket(int64_t value)
+	{
+		size_t bucket = 0;
+		for (; value > 0 && bucket < HistogramSnapshot::BUCKET_COUNT - 1; value >>= 1)
+		{
+			++bucket;
+		}
+
+		return bucket;
+	}
+
+	int64_t getBucketUpperBound(size_t bucket)
+	{
+		if (bucket == 0)
+		{
+			return 0;
+		}
+		else if (bucket == HistogramSnapshot::BUCKET_COUNT - 1)
+		{
+			return std::numeric_limits<int64_t>::max();
+		}
+
+		return (int64_t(1) << bucket) - 1;
+	}
+
+	MetricGauge& getFrameDrawCallsGauge()
+	{
+		static MetricGauge& frameDrawCalls = Metrics::getGauge("Frame draw calls");
+		return frameDrawCalls;
+	}
+
+	MetricGauge& getFrameIndicesGauge()
+	{
+		static MetricGauge& frameIndices = Metrics::getGauge("Frame indices");
+		return frameIndices;
+	}
+
+	const char* getMetricTypeName(eMetricType type)
+	{
+		switch (type)
+		{
+		case eMetricType::Counter:
+			return "counter";
+		case eMetricType::Gauge:
+			return "gauge";
+		case eMetricType::Histogram:
+			return "histogram";
+		default:
+			assert(false);
+			return "";
+		}
+	}
+}
+
+//MetricCounter
+MetricCounter::MetricCounter()
+	: m_value(0)
+{}
+
+void MetricCounter::add(int64_t value)
+{
+	assert(value >= 0);
+	m_value.fetch_add(value, std::memory_order_relaxed);
+}
+
+int64_t MetricCounter::get() const
+{
+	return m_value.load(std::memory_order_relaxed);
+}
+
+//MetricGauge
+MetricGauge::MetricGauge()
+	: m_value(0)
+{}
+
+void MetricGauge::set(int64_t value)
+{
+	m_value.store(value, std::memory_order_relaxed);
+}
+
+void MetricGauge::add(int64_t value)
+{
+	m_value.fetch_add(value, std::memory_order_relaxed);
+}
+
+int64_t MetricGauge::get() const
+{
+	return m_value.load(std::memory_order_relaxed);
+}
+
+//HistogramSnapshot
+int64_t HistogramSnapshot::getMean() const
+{
+	return count > 0 ? sum / count : 0;
+}
+
+int64_t HistogramSnapshot::getPercentile(float percentile) const
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	int64_t target = std::max(static_cast<int64_t>(percentile * count + 0.5f), int64_t(1));
+	int64_t total = 0;
+	for (size_t i = 0; i < BUCKET_COUNT; ++i)
+	{
+		total += buckets[i];
+		if (total >= target)
+		{
+			return std::min(std::max(getBucketUpperBound(i), min), max);
+		}
+	}
+
+	return max;
+}
+
+//MetricHistogram
+MetricHistogram::MetricHistogram()
+	: m_sum(0),
+	m_min(std::numeric_limits<int64_t>::max()),
+	m_max(std::numeric_limits<int64_t>::min()),
+	m_buckets()
+{
+	for (auto& bucket : m_buckets)
+	{
+		bucket.store(0, std::memory_order_relaxed);
+	}
+}
+
+void MetricHistogram::record(int64_t value)
+{
+	m_buckets[getBucket(value)].fetch_add(1, std::memory_order_relaxed);
+	m_sum.fetch_add(value, std::memory_order_relaxed);
+
+	int64_t min = m_min.load(std::memory_order_relaxed);
+	while (value < min && !m_min.compare_exchange_weak(min, value, std::memory_order_relaxed))
+	{}
+
+	int64_t max = m_max.load(std::memory_order_relaxed);
+	while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+	{}
+}
+
+//Values recorded while the snapshot is taken may only be partly in it
+HistogramSnapshot MetricHistogram::getSnapshot() const
+{
+	HistogramSnapshot snapshot;
+	snapshot.count = 0;
+	for (size_t i = 0; i < m_buckets.size(); ++i)
+	{
+		snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+		snapshot.count += snapshot.buckets[i];
+	}
+
+	if (snapshot.count > 0)
+	{
+		snapshot.sum = m_sum.load(std::memory_order_relaxed);
+		snapshot.min = m_min.load(std::memory_order_relaxed);
+		snapshot.max = std::max(m_max.load(std::memory_order_relaxed), snapshot.min);
+	}
+
+	return snapshot;
+}
+
+//Metrics
+MetricCounter& Metrics::getCounter(const std::string& name)
+{
+	return *getRegisteredMetric(name, eMetricType::Counter).counter;
+}
+
+MetricGauge& Metrics::getGauge(const std::string& name)
+{
+	return *getRegisteredMetric(name, eMetricType::Gauge).gauge;
+}
+
+MetricHistogram& Metrics::getHistogram(const std::string& name)
+{
+	return *getRegisteredMetric(name, eMetricType::Histogram).histogram;
+}
+
+void Metrics::resetFrameDraws()
+{
+	getFrameDrawCallsGauge().set(0);
+	getFrameIndicesGauge().set(0);
+}
+
+void Metrics::addFrameDraws(int64_t drawCalls, int64_t indices)
+{
+	getFrameDrawCallsGauge().add(drawCalls);
+	getFrameIndicesGauge().add(indices);
+}
+
+void Metrics::getSnapshots(std::vector<MetricSnapshot>& snapshots)
+{
+	std::lock_guard<std::mutex> registeredMetricsLock(registeredMetricsMutex);
+	snapshots.resize(registeredMetrics.size());
+	for (size_t i = 0; i < registeredMetrics.size(); ++i)
+	{
+		const RegisteredMetric& registeredMetric = *registeredMetrics[i];
+		MetricSnapshot& snapshot = snapshots[i];
+		snapshot.name = registeredMetric.name;
+		snapshot.type = registeredMetric.type;
+		switch (registeredMetric.type)
+		{
+		case eMetricType::Counter:
+			snapshot.value = registeredMetric.counter->get();
+			break;
+		case eMetricType::Gauge:
+			snapshot.value = registeredMetric.gauge->get();
+			break;
+		case eMetricType::Histogram:
+			snapshot.histogram = registeredMetric.histogram->getSnapshot();
+			snapshot.value = snapshot.histogram.count;
+			break;
+		}
+	}
+}
+
+void Metrics::getSummary(std::vector<std::string>& lines)
+{
+	std::vector<MetricSnapshot> snapshots;
+	getSnapshots(snapshots);
+
+	lines.clear();
+	for (const auto& snapshot : snapshots)
+	{
+		if (snapshot.type == eMetricType::Histogram)
+		{
+			lines.push_back(snapshot.name + ": MEAN " + std::to_string(snapshot.histogram.getMean()) +
+				" P95 " + std::to_string(snapshot.histogram.getPercentile(0.95f)) +
+				" MAX " + std::to_string(snapshot.histogram.max));
+		}
+		else
+		{
+			lines.push_back(snapshot.name + ": " + std::to_string(snapshot.value));
+		}
+	}
+}
+
+//MetricsDump
+MetricsDump::MetricsDump(const std::string& filePath, eMetricsDumpFormat format, float interval)
+	: m_file(filePath),
+	m_format(format),
+	m_interval(interval),
+	m_elapsedTime(0.0f),
+	m_timeSinceDump(0.0f),
+	m_snapshots()
+{
+	assert(interval > 0.0f);
+	if (m_file.is_open() && m_format == eMetricsDumpFormat::CSV)
+	{
+		m_file << "time,name,type,value,count,mean,p50,p95,p99,min,max\n";
+	}
+}
+
+void MetricsDump::update(float deltaTime)
+{
+	m_elapsedTime += deltaTime;
+	m_timeSinceDump += deltaTime;
+	if (m_timeSinceDump >= m_interval)
+	{
+		m_timeSinceDump = 0.0f;
+		dump();
+	}
+}
+
+void MetricsDump::dump()
+{
+	if (!m_file.is_open())
+	{
+		return;
+	}
+
+	Metrics::getSnapshots(m_snapshots);
+	switch (m_format)
+	{
+	case eMetricsDumpFormat::CSV:
+		for (const auto& snapshot : m_snapshots)
+		{
+			m_file << m_elapsedTime << "," << snapshot.name << "," << getMetricTypeName(snapshot.type) << "," << snapshot.value;
+			if (snapshot.type == eMetricType::Histogram)
+			{
+				const HistogramSnapshot& histogram = snapshot.histogram;
+				m_file << "," << histogram.count << "," << histogram.getMean() << "," << histogram.getPercentile(0.5f) << "," <<
+					histogram.getPercentile(0.95f) << "," << histogram.getPercentile(0.99f) << "," << histogram.min << "," << histogram.max;
+			}
+			else
+			{
+				m_file << ",,,,,,,";
+			}
+			m_file << "\n";
+		}
+		break;
+	case eMetricsDumpFormat::JSONLines:
+		m_file << "{\"time\":" << m_elapsedTime << ",\"metrics\":{";
+		for (size_t i = 0; i < m_snapshots.size(); ++i)
+		{
+			const MetricSnapshot& snapshot = m_snapshots[i];
+			m_file << (i > 0 ? "," : "") << "\"" << snapshot.name << "\":";
+			if (snapshot.type == eMetricType::Histogram)
+			{
+				const HistogramSnapshot& histogram = snapshot.histogram;
+				m_file << "{\"count\":" << histogram.count << ",\"mean\":" << histogram.getMean() << ",\"p50\":" << histogram.getPercentile(0.5f) <<
+					",\"p95\":" << histogram.getPercentile(0.95f) << ",\"p99\":" << histogram.getPercentile(0.99f) <<
+					",\"min\":" << histogram.min << ",\"max\":" << histogram.max << "}";
+			}
+			else
+			{
+				m_file << snapshot.value;
+			}
+		}
+		m_file << "}}\n";
+		break;
+	}
+
+	m_file.flush();
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "NonCopyable.h"
+#include "NonMovable.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+enum class eMetricType
+{
+	Counter = 0,
+	Gauge,
+	Histogram
+};
+
+enum class eMetricsDumpFormat
+{
+	CSV = 0,
+	JSONLines
+};
+
+//Only ever goes up
+class MetricCounter : private NonCopyable, private NonMovable
+{
+public:
+	MetricCounter();
+
+	void add(int64_t value = 1);
+	int64_t get() const;
+
+private:
+	std::atomic<int64_t> m_value;
+};
+
+//The latest value of something that goes up and down
+class MetricGauge : private NonCopyable, private NonMovable
+{
+public:
+	MetricGauge();
+
+	void set(int64_t value);
+	void add(int64_t value);
+	int64_t get() const;
+
+private:
+	std::atomic<int64_t> m_value;
+};
+
+struct HistogramSnapshot
+{
+	//Bucket 0 holds values below 1, bucket i holds values from 2^(i - 1) up to 2^i
+	static constexpr size_t BUCKET_COUNT = 64;
+
+	int64_t getMean() const;
+	//Upper bound of the bucket the percentile falls in - never more than the max
+	int64_t getPercentile(float percentile) const;
+
+	int64_t count = 0;
+	int64_t sum = 0;
+	int64_t min = 0;
+	int64_t max = 0;
+	std::array<int64_t, BUCKET_COUNT> buckets = {};
+};
+
+//Power of two buckets - recording is a handful of relaxed atomic operations
+class MetricHistogram : private NonCopyable, private NonMovable
+{
+public:
+	MetricHistogram();
+
+	void record(int64_t value);
+	HistogramSnapshot getSnapshot() const;
+
+private:
+	std::atomic<int64_t> m_sum;
+	std::atomic<int64_t> m_min;
+	std::atomic<int64_t> m_max;
+	std::array<std::atomic<int64_t>, HistogramSnapshot::BUCKET_COUNT> m_buckets;
+};
+
+//Records how long it was alive in microseconds
+class ScopedMetricTimer : private NonCopyable, private NonMovable
+{
+public:
+	ScopedMetricTimer(MetricHistogram& histogram)
+		: m_histogram(histogram),
+		m_startTime(std::chrono::steady_clock::now())
+	{}
+
+	~ScopedMetricTimer()
+	{
+		m_histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_startTime).count());
+	}
+
+private:
+	MetricHistogram& m_histogram;
+	const std::chrono::steady_clock::time_point m_startTime;
+};
+
+struct MetricSnapshot
+{
+	std::string name;
+	eMetricType type;
+	int64_t value = 0;
+	HistogramSnapshot histogram;
+};
+
+//Metrics are created on first use and live until the program exits so references to them can be kept
+//Look a metric up once and keep the reference - updating it never locks
+namespace Metrics
+{
+	MetricCounter& getCounter(const std::string& name);
+	MetricGauge& getGauge(const std::string& name);
+	MetricHistogram& getHistogram(const std::string& name);
+
+	//Draw calls and indices issued this frame - reset by the main loop before it renders
+	void resetFrameDraws();
+	void addFrameDraws(int64_t drawCalls, int64_t indices);
+
+	//In the order the metrics were created
+	void getSnapshots(std::vector<MetricSnapshot>& snapshots);
+	//One line per metric for the overlay
+	void getSummary(std::vector<std::string>& lines);
+}
+
+//Appends every metric to the file each interval
+//CSV is one row per metric, JSON lines one object per dump
+class MetricsDump : private NonCopyable, private NonMovable
+{
+public:
+	MetricsDump(const std::string& filePath, eMetricsDumpFormat format, float interval);
+
+	void update(float deltaTime);
+
+private:
+	std::ofstream m_file;
+	const eMetricsDumpFormat m_format;
+	const float m_interval;
+	float m_elapsedTime;
+	float m_timeSinceDump;
+	std::vector<MetricSnapshot> m_snapshots;
+
+	void dump();
+};
\ No newline at end of file
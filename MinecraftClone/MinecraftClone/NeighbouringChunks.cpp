@@ -22,17 +22,37 @@ glm::ivec3 getNeighbouringChunkPosition(const glm::ivec3& chunkStartingPosition,
 	}
 }
 
-bool isAllNeighbouringChunksAvailable(const std::unordered_map<glm::ivec3, ObjectFromPool<Chunk>>& chunks, const glm::ivec3& middleChunkStartingPosition)
+std::array<glm::ivec3, SURROUNDING_CHUNK_COUNT> getSurroundingChunkPositions(const glm::ivec3& chunkStartingPosition)
 {
-	auto leftChunk = chunks.find(getNeighbouringChunkPosition(middleChunkStartingPosition, eDirection::Left));
-	auto rightChunk = chunks.find(getNeighbouringChunkPosition(middleChunkStartingPosition, eDirection::Right));
-	auto forwardChunk = chunks.find(getNeighbouringChunkPosition(middleChunkStartingPosition, eDirection::Forward));
-	auto backChunk = chunks.find(getNeighbouringChunkPosition(middleChunkStartingPosition, eDirection::Back));
+	std::array<glm::ivec3, SURROUNDING_CHUNK_COUNT> surroundingChunkPositions;
+	size_t i = 0;
+	for (int z = -1; z <= 1; ++z)
+	{
+		for (int x = -1; x <= 1; ++x)
+		{
+			if (x != 0 || z != 0)
+			{
+				surroundingChunkPositions[i++] = glm::ivec3(chunkStartingPosition.x + x * Globals::CHUNK_WIDTH, 0,
+					chunkStartingPosition.z + z * Globals::CHUNK_DEPTH);
+			}
+		}
+	}
 
-	return (leftChunk != chunks.cend() &&
-		rightChunk != chunks.cend() &&
-		forwardChunk != chunks.cend() &&
-		backChunk != chunks.cend());
+	return surroundingChunkPositions;
+}
+
+SurroundingChunks getAllSurroundingChunks(const std::unordered_map<glm::ivec3, ObjectFromPool<Chunk>>& chunks, const glm::ivec3& middleChunkStartingPosition)
+{
+	SurroundingChunks surroundingChunks;
+	std::array<glm::ivec3, SURROUNDING_CHUNK_COUNT> surroundingChunkPositions = getSurroundingChunkPositions(middleChunkStartingPosition);
+	for (size_t i = 0; i < surroundingChunkPositions.size(); ++i)
+	{
+		auto surroundingChunk = chunks.find(surroundingChunkPositions[i]);
+		assert(surroundingChunk != chunks.cend());
+		surroundingChunks[i] = &surroundingChunk->second.get();
+	}
+
+	return surroundingChunks;
 }
 
 NeighbouringChunks getAllNeighbouringChunks(const std::unordered_map<glm::ivec3, ObjectFromPool<Chunk>>& chunks, const glm::ivec3& middleChunkStartingPosition)
@@ -47,8 +67,8 @@ NeighbouringChunks getAllNeighbouringChunks(const std::unordered_map<glm::ivec3,
 		forwardChunk != chunks.cend() &&
 		backChunk != chunks.cend());
 
-	return NeighbouringChunks(leftChunk->second.object, rightChunk->second.object,
-		forwardChunk->second.object, backChunk->second.object);
+	return NeighbouringChunks(leftChunk->second.get(), rightChunk->second.get(),
+		forwardChunk->second.get(), backChunk->second.get());
 }
 
 //NeighbouringChunks
@@ -7,7 +7,11 @@
 #include "ObjectPool.h"
 #include "glm/gtx/hash.hpp"
 
-bool isAllNeighbouringChunksAvailable(const std::unordered_map<glm::ivec3, ObjectFromPool<Chunk>>& chunks,
+glm::ivec3 getNeighbouringChunkPosition(const glm::ivec3& chunkStartingPosition, eDirection direction);
+
+std::array<glm::ivec3, SURROUNDING_CHUNK_COUNT> getSurroundingChunkPositions(const glm::ivec3& chunkStartingPosition);
+
+SurroundingChunks getAllSurroundingChunks(const std::unordered_map<glm::ivec3, ObjectFromPool<Chunk>>& chunks,
 	const glm::ivec3& middleChunkStartingPosition);
 
 NeighbouringChunks getAllNeighbouringChunks(const std::unordered_map<glm::ivec3, ObjectFromPool<Chunk>>& chunks,
@@ -2,93 +2,401 @@
 
 #include "NonMovable.h"
 #include "NonCopyable.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
-#include <stack>
-#include <functional>
+#include <algorithm>
 #include <assert.h>
 
 template <class Object>
-struct ObjectFromPool : private NonCopyable
+class ObjectPool;
+
+template <class Object>
+class ObjectAllocator
+{
+public:
+	virtual ~ObjectAllocator() {}
+
+	virtual Object* allocate() = 0;
+	virtual void deallocate(Object* object) = 0;
+};
+
+template <class Object>
+class HeapObjectAllocator : public ObjectAllocator<Object>
+{
+public:
+	Object* allocate() override
+	{
+		return new Object();
+	}
+
+	void deallocate(Object* object) override
+	{
+		delete object;
+	}
+};
+
+//Stays valid until the object it refers to is released back to the pool - the generation no longer matches after that
+template <class Object>
+struct ObjectPoolHandle
+{
+	uint32_t index;
+	uint32_t generation;
+};
+
+struct ObjectPoolStats
 {
-	ObjectFromPool(Object& object, std::function<void(Object&)> onDestroyFunction)
-		: object(object),
-		onDestroyFunction(onDestroyFunction)
+	size_t maxSize = 0;
+	size_t capacity = 0;
+	size_t allocated = 0;
+	size_t occupancy = 0;
+	size_t highWaterMark = 0;
+};
+
+template <class Object>
+class ObjectFromPool : private NonCopyable
+{
+public:
+	ObjectFromPool(ObjectPool<Object>& objectPool, ObjectPoolHandle<Object> handle)
+		: m_objectPool(&objectPool),
+		m_handle(handle)
 	{}
 	~ObjectFromPool()
 	{
-		if (onDestroyFunction)
-		{
-			object.get().reset();
-			onDestroyFunction(object);
-		}
+		release();
 	}
 	ObjectFromPool(ObjectFromPool&& orig) noexcept
-		: object(orig.object),
-		onDestroyFunction(orig.onDestroyFunction)
+		: m_objectPool(orig.m_objectPool),
+		m_handle(orig.m_handle)
 	{
-		orig.onDestroyFunction = nullptr;
+		orig.m_objectPool = nullptr;
 	}
 	ObjectFromPool& operator=(ObjectFromPool&& orig) noexcept
 	{
-		object = orig.object;
-		onDestroyFunction = orig.onDestroyFunction;
+		if (this != &orig)
+		{
+			release();
+
+			m_objectPool = orig.m_objectPool;
+			m_handle = orig.m_handle;
 
-		orig.onDestroyFunction = nullptr;
+			orig.m_objectPool = nullptr;
+		}
 
 		return *this;
 	}
 
-	std::reference_wrapper<Object> object;
+	ObjectPoolHandle<Object> getHandle() const
+	{
+		assert(m_objectPool);
+		return m_handle;
+	}
+
+	Object& get() const
+	{
+		assert(m_objectPool);
+		return m_objectPool->get(m_handle);
+	}
 
 private:
-	std::function<void(Object&)> onDestroyFunction;
+	ObjectPool<Object>* m_objectPool;
+	ObjectPoolHandle<Object> m_handle;
+
+	void release()
+	{
+		if (m_objectPool)
+		{
+			m_objectPool->releaseObject(m_handle);
+			m_objectPool = nullptr;
+		}
+	}
 };
 
 //Object Pool
+//Available objects are kept on a lock free stack so objects can be taken and released from any thread
+//Objects are constructed on first use - the capacity can be changed at runtime up to the max size
 template <class Object>
 class ObjectPool : private NonCopyable, private NonMovable
 {
+	friend class ObjectFromPool<Object>;
 public:
-	ObjectPool(size_t size = 0)
-		: m_maxSize(size),
-		m_availableObjects(),
-		m_objectPool()
+	ObjectPool(size_t size = 0, size_t maxSize = 0,
+		std::unique_ptr<ObjectAllocator<Object>> objectAllocator = std::make_unique<HeapObjectAllocator<Object>>())
+		: m_maxSize(std::max(size, maxSize)),
+		m_objectAllocator(std::move(objectAllocator)),
+		m_objectPool(new PooledObject[m_maxSize]),
+		m_availableObjectsHead(INVALID_INDEX),
+		m_capacity(0),
+		m_allocated(0),
+		m_occupancy(0),
+		m_highWaterMark(0),
+		m_resizeMutex(),
+		m_retiredObjects()
 	{
-		m_objectPool.resize(size);
-		for (auto& object : m_objectPool)
-		{
-			m_availableObjects.push(object);
-		}
+		assert(m_maxSize < INVALID_INDEX);
+		resize(size);
 	}
 	~ObjectPool()
 	{
-		assert(m_availableObjects.size() == m_maxSize);
+		assert(m_occupancy == 0);
+		for (size_t i = 0; i < m_maxSize; ++i)
+		{
+			if (m_objectPool[i].object)
+			{
+				m_objectAllocator->deallocate(m_objectPool[i].object);
+			}
+		}
 	}
 
 	bool isObjectAvailable() const
 	{
-		return !m_availableObjects.empty();
+		return getIndex(m_availableObjectsHead.load(std::memory_order_acquire)) != INVALID_INDEX;
 	}
 
 	ObjectFromPool<Object> getAvailableObject()
 	{
-		assert(isObjectAvailable());
+		uint32_t index = popAvailableObject();
+		assert(index != INVALID_INDEX);
 
-		Object& objectInPool = m_availableObjects.top();
-		m_availableObjects.pop();
-		return ObjectFromPool<Object>(objectInPool, [this](Object& objectInPool)
+		PooledObject& pooledObject = m_objectPool[index];
+		if (!pooledObject.object)
 		{
-			return releaseObject(objectInPool);
-		});
+			pooledObject.object = m_objectAllocator->allocate();
+			m_allocated.fetch_add(1, std::memory_order_relaxed);
+		}
+		pooledObject.state.store(ePooledObjectState::InUse, std::memory_order_relaxed);
+
+		size_t occupancy = m_occupancy.fetch_add(1, std::memory_order_relaxed) + 1;
+		size_t highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+		while (occupancy > highWaterMark &&
+			!m_highWaterMark.compare_exchange_weak(highWaterMark, occupancy, std::memory_order_relaxed))
+		{}
+
+		ObjectPoolHandle<Object> handle = { index, pooledObject.generation.load(std::memory_order_relaxed) };
+		return ObjectFromPool<Object>(*this, handle);
+	}
+
+	bool isValid(ObjectPoolHandle<Object> handle) const
+	{
+		return handle.index < m_maxSize &&
+			m_objectPool[handle.index].generation.load(std::memory_order_relaxed) == handle.generation &&
+			m_objectPool[handle.index].state.load(std::memory_order_relaxed) == ePooledObjectState::InUse;
+	}
+
+	Object& get(ObjectPoolHandle<Object> handle)
+	{
+		assert(isValid(handle));
+		return *m_objectPool[handle.index].object;
+	}
+
+	const Object& get(ObjectPoolHandle<Object> handle) const
+	{
+		assert(isValid(handle));
+		return *m_objectPool[handle.index].object;
+	}
+
+	//Objects in use past the new size are retired once released rather than handed out again
+	//Not safe to call while objects are being taken from the pool
+	void resize(size_t size)
+	{
+		assert(size <= m_maxSize);
+		std::lock_guard<std::mutex> resizeLock(m_resizeMutex);
+		size_t capacity = m_capacity.load(std::memory_order_relaxed);
+		m_capacity.store(size, std::memory_order_release);
+
+		if (size > capacity)
+		{
+			m_retiredObjects.erase(std::remove_if(m_retiredObjects.begin(), m_retiredObjects.end(), [this, size](uint32_t index)
+			{
+				if (index < size)
+				{
+					m_objectPool[index].state.store(ePooledObjectState::Available, std::memory_order_relaxed);
+					pushAvailableObject(index);
+					return true;
+				}
+
+				return false;
+			}), m_retiredObjects.end());
+
+			for (size_t i = capacity; i < size; ++i)
+			{
+				PooledObject& pooledObject = m_objectPool[i];
+				if (pooledObject.state.load(std::memory_order_relaxed) == ePooledObjectState::Unallocated)
+				{
+					pooledObject.state.store(ePooledObjectState::Available, std::memory_order_relaxed);
+					pushAvailableObject(static_cast<uint32_t>(i));
+				}
+			}
+		}
+		else if (size < capacity)
+		{
+			std::vector<uint32_t> availableObjects;
+			for (uint32_t index = popAvailableObject(); index != INVALID_INDEX; index = popAvailableObject())
+			{
+				availableObjects.push_back(index);
+			}
+
+			for (auto index = availableObjects.rbegin(); index != availableObjects.rend(); ++index)
+			{
+				if (*index < size)
+				{
+					pushAvailableObject(*index);
+				}
+				else
+				{
+					retireObject(*index);
+				}
+			}
+		}
+	}
+
+	//Called from whichever thread is allowed to destroy objects of this type
+	void destroyRetiredObjects()
+	{
+		std::lock_guard<std::mutex> resizeLock(m_resizeMutex);
+		size_t capacity = m_capacity.load(std::memory_order_relaxed);
+		for (uint32_t index : m_retiredObjects)
+		{
+			PooledObject& pooledObject = m_objectPool[index];
+			assert(pooledObject.state.load(std::memory_order_relaxed) == ePooledObjectState::Retired);
+			if (pooledObject.object)
+			{
+				m_objectAllocator->deallocate(pooledObject.object);
+				pooledObject.object = nullptr;
+				m_allocated.fetch_sub(1, std::memory_order_relaxed);
+			}
+
+			if (index < capacity)
+			{
+				pooledObject.state.store(ePooledObjectState::Available, std::memory_order_relaxed);
+				pushAvailableObject(index);
+			}
+			else
+			{
+				pooledObject.state.store(ePooledObjectState::Unallocated, std::memory_order_relaxed);
+			}
+		}
+
+		m_retiredObjects.clear();
+	}
+
+	ObjectPoolStats getStats() const
+	{
+		ObjectPoolStats stats;
+		stats.maxSize = m_maxSize;
+		stats.capacity = m_capacity.load(std::memory_order_relaxed);
+		stats.allocated = m_allocated.load(std::memory_order_relaxed);
+		stats.occupancy = m_occupancy.load(std::memory_order_relaxed);
+		stats.highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+
+		return stats;
 	}
 
 private:
+	static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+	enum class ePooledObjectState
+	{
+		Unallocated = 0,
+		Available,
+		InUse,
+		Retired
+	};
+
+	struct PooledObject
+	{
+		Object* object = nullptr;
+		std::atomic<ePooledObjectState> state{ ePooledObjectState::Unallocated };
+		std::atomic<uint32_t> generation{ 0 };
+		std::atomic<uint32_t> nextAvailableObject{ INVALID_INDEX };
+	};
+
 	const size_t m_maxSize;
-	std::stack<std::reference_wrapper<Object>, std::vector<std::reference_wrapper<Object>>> m_availableObjects;
-	std::vector<Object> m_objectPool;
+	std::unique_ptr<ObjectAllocator<Object>> m_objectAllocator;
+	std::unique_ptr<PooledObject[]> m_objectPool;
+	//Upper 32 bits are bumped on every change so a stale head can't be swapped back in
+	std::atomic<uint64_t> m_availableObjectsHead;
+	std::atomic<size_t> m_capacity;
+	std::atomic<size_t> m_allocated;
+	std::atomic<size_t> m_occupancy;
+	std::atomic<size_t> m_highWaterMark;
+	std::mutex m_resizeMutex;
+	std::vector<uint32_t> m_retiredObjects;
+
+	static uint32_t getIndex(uint64_t head)
+	{
+		return static_cast<uint32_t>(head);
+	}
+
+	static uint64_t getNextHead(uint64_t head, uint32_t index)
+	{
+		return (((head >> 32) + 1) << 32) | index;
+	}
+
+	uint32_t popAvailableObject()
+	{
+		uint64_t head = m_availableObjectsHead.load(std::memory_order_acquire);
+		while (getIndex(head) != INVALID_INDEX)
+		{
+			uint32_t nextAvailableObject = m_objectPool[getIndex(head)].nextAvailableObject.load(std::memory_order_relaxed);
+			if (m_availableObjectsHead.compare_exchange_weak(head, getNextHead(head, nextAvailableObject),
+				std::memory_order_acquire, std::memory_order_acquire))
+			{
+				return getIndex(head);
+			}
+		}
+
+		return INVALID_INDEX;
+	}
 
-	void releaseObject(Object& objectInPool)
+	void pushAvailableObject(uint32_t index)
 	{
-		m_availableObjects.push(objectInPool);
+		uint64_t head = m_availableObjectsHead.load(std::memory_order_relaxed);
+		do
+		{
+			m_objectPool[index].nextAvailableObject.store(getIndex(head), std::memory_order_relaxed);
+		} while (!m_availableObjectsHead.compare_exchange_weak(head, getNextHead(head, index),
+			std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	void retireObject(uint32_t index)
+	{
+		m_objectPool[index].state.store(ePooledObjectState::Retired, std::memory_order_relaxed);
+		m_retiredObjects.push_back(index);
+	}
+
+	void releaseObject(ObjectPoolHandle<Object> handle)
+	{
+		assert(isValid(handle));
+
+		PooledObject& pooledObject = m_objectPool[handle.index];
+		pooledObject.object->reset();
+		pooledObject.generation.fetch_add(1, std::memory_order_relaxed);
+		m_occupancy.fetch_sub(1, std::memory_order_relaxed);
+
+		//After shrinking, objects in use past the capacity keep more objects allocated than the capacity allows
+		//so released objects are retired until that evens out
+		size_t capacity = m_capacity.load(std::memory_order_acquire);
+		if (handle.index < capacity && m_allocated.load(std::memory_order_relaxed) <= capacity)
+		{
+			pooledObject.state.store(ePooledObjectState::Available, std::memory_order_relaxed);
+			pushAvailableObject(handle.index);
+		}
+		else
+		{
+			std::lock_guard<std::mutex> resizeLock(m_resizeMutex);
+			capacity = m_capacity.load(std::memory_order_relaxed);
+			if (handle.index < capacity && m_allocated.load(std::memory_order_relaxed) - m_retiredObjects.size() <= capacity)
+			{
+				pooledObject.state.store(ePooledObjectState::Available, std::memory_order_relaxed);
+				pushAvailableObject(handle.index);
+			}
+			else
+			{
+				retireObject(handle.index);
+			}
+		}
 	}
 };
\ No newline at end of file
@@ -2,39 +2,28 @@
 
 #include "NonCopyable.h"
 #include "NonMovable.h"
+#include "Globals.h"
 #include "glm/glm.hpp"
 #include "Rectangle.h"
 #include <assert.h>
-#include <unordered_map>
-#include "glm/gtx/hash.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
-template <class Object>
-class ObjectQueue;
-class ObjectQueuePositionNode: private NonCopyable
+class ObjectQueuePositionNode : private NonCopyable
 {
-	friend class ObjectQueue<ObjectQueuePositionNode>;
 public:
 	ObjectQueuePositionNode(const glm::ivec3& position)
-		: position(position),
-		previous(nullptr),
-		next(nullptr)
+		: position(position)
 	{}
 	ObjectQueuePositionNode(ObjectQueuePositionNode&& orig) noexcept
-		: position(orig.position),
-		previous(orig.previous),
-		next(orig.next)
-	{
-		orig.previous = nullptr;
-		orig.next = nullptr;
-	}
+		: position(orig.position)
+	{}
 	ObjectQueuePositionNode& operator=(ObjectQueuePositionNode&& orig) noexcept
 	{
 		position = orig.position;
-		previous = orig.previous;
-		next = orig.next;
-
-		orig.previous = nullptr;
-		orig.next = nullptr;
 
 		return *this;
 	}
@@ -46,47 +35,28 @@ public:
 
 private:
 	glm::ivec3 position;
-	ObjectQueuePositionNode* previous;
-	ObjectQueuePositionNode* next;
 };
 
-template<class Object>
-class ObjectQueue;
 template <class Object>
 class ObjectQueueObjectNode : private NonCopyable
 {
-	friend class ObjectQueue<ObjectQueueObjectNode<Object>>;
 public:
 	ObjectQueueObjectNode(const glm::ivec3& position, Object&& object)
 		: object(std::move(object)),
-		position(position),
-		previous(nullptr),
-		next(nullptr)
+		position(position)
 	{}
 	ObjectQueueObjectNode(const glm::ivec3& position, Object& object)
 		: object(object),
-		position(position),
-		previous(nullptr),
-		next(nullptr)
+		position(position)
 	{}
 	ObjectQueueObjectNode(ObjectQueueObjectNode&& orig) noexcept
 		: object(std::move(orig.object)),
-		position(orig.position),
-		previous(orig.previous),
-		next(orig.next)
-	{
-		orig.previous = nullptr;
-		orig.next = nullptr;
-	}
+		position(orig.position)
+	{}
 	ObjectQueueObjectNode& operator=(ObjectQueueObjectNode&& orig) noexcept
 	{
 		object = std::move(orig.object);
 		position = orig.position;
-		previous = orig.previous;
-		next = orig.next;
-
-		orig.previous = nullptr;
-		orig.next = nullptr;
 
 		return *this;
 	}
@@ -100,232 +70,445 @@ public:
 
 private:
 	glm::ivec3 position;
-	ObjectQueueObjectNode* previous;
-	ObjectQueueObjectNode* next;
 };
 
+//Stays valid until the element it refers to leaves the queue - the generation no longer matches after that
+struct ObjectQueueHandle
+{
+	uint32_t index;
+	uint32_t generation;
+};
+
+//Slot map keyed by chunk starting position (y is always 0)
+//Elements live contiguously and are swapped and popped on removal, FIFO order is kept by a ring of handles
+//Handles left in the ring by removals from the middle are skipped when they reach the front
 template <class Object>
 class ObjectQueue : private NonCopyable, private NonMovable
 {
 public:
 	ObjectQueue()
-		: m_initialObjectAdded(nullptr),
-		m_recentObjectAdded(nullptr),
-		m_container()
+		: m_objects(),
+		m_objectSlots(),
+		m_slots(),
+		m_freeSlots(),
+		m_ring(),
+		m_ringHead(0),
+		m_ringSize(0),
+		m_positionIndex(),
+		m_positionIndexSize(0),
+		m_evictionBounds(),
+		m_evictionBoundsSet(false),
+		m_fullEvictionRequired(false),
+		m_evictionScratch()
 	{}
 
-	void add(Object&& newObject)
+	ObjectQueueHandle add(Object&& newObject)
 	{
-		glm::ivec3 position = newObject.position;
+		glm::ivec3 position = newObject.getPosition();
+		assert(position.y == 0 && !contains(position));
 
-		auto iter = m_container.find(position);
-		assert(iter == m_container.cend());
-		if (iter == m_container.cend())
+		uint32_t slotIndex = 0;
+		if (!m_freeSlots.empty())
 		{
-			if (m_container.empty())
-			{
-				assert(!m_initialObjectAdded && !m_recentObjectAdded);
-				Object& addedObject = m_container.emplace(std::piecewise_construct,
-					std::forward_as_tuple(position),
-					std::forward_as_tuple(std::move(newObject))).first->second;
-
-				addedObject.previous = nullptr;
-				m_initialObjectAdded = &addedObject;
-				m_recentObjectAdded = &addedObject;
-			}
-			else if (m_container.size() == 1)
-			{
-				assert(m_initialObjectAdded && m_recentObjectAdded);
-				Object& addedObject = m_container.emplace(std::piecewise_construct,
-					std::forward_as_tuple(position),
-					std::forward_as_tuple(std::move(newObject))).first->second;
-
-				addedObject.previous = m_initialObjectAdded;
-				m_initialObjectAdded->next = &addedObject;
-				m_recentObjectAdded = &addedObject;
-			}
-			else if (m_container.size() > 1)
-			{
-				assert(m_initialObjectAdded && m_recentObjectAdded);
-				Object& addedObject = m_container.emplace(std::piecewise_construct,
-					std::forward_as_tuple(position),
-					std::forward_as_tuple(std::move(newObject))).first->second;
-
-				addedObject.previous = m_recentObjectAdded;
-				m_recentObjectAdded->next = &addedObject;
-				m_recentObjectAdded = &addedObject;
-			}
+			slotIndex = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else
+		{
+			slotIndex = static_cast<uint32_t>(m_slots.size());
+			m_slots.emplace_back();
+		}
+
+		Slot& slot = m_slots[slotIndex];
+		slot.objectIndex = static_cast<uint32_t>(m_objects.size());
+		m_objects.push_back(std::move(newObject));
+		m_objectSlots.push_back(slotIndex);
+
+		ObjectQueueHandle handle = { slotIndex, slot.generation };
+		pushRing(handle);
+		insertPositionIndex(position, slotIndex);
+
+		//Eviction by strips relies on every element being inside the previous bounds
+		if (m_evictionBoundsSet && !isInBounds(position, m_evictionBounds))
+		{
+			m_fullEvictionRequired = true;
 		}
+
+		return handle;
 	}
 
 	bool contains(const glm::ivec3& position) const
 	{
-		return m_container.find(position) != m_container.cend();
+		return findPositionIndex(position) != INVALID_INDEX;
+	}
+
+	bool contains(ObjectQueueHandle handle) const
+	{
+		return handle.index < m_slots.size() &&
+			m_slots[handle.index].generation == handle.generation &&
+			m_slots[handle.index].objectIndex != INVALID_INDEX;
 	}
 
 	bool isEmpty() const
 	{
-		return m_container.empty();
+		return m_objects.empty();
 	}
 
-	Object* next(Object* object)
+	size_t size() const
 	{
-		assert(m_initialObjectAdded && m_recentObjectAdded && !m_container.empty());
-		if (object)
-		{
-			return object->next;
-		}
-		else
-		{
-			return nullptr;
-		}
+		return m_objects.size();
 	}
 
 	Object& front()
 	{
-		assert(m_initialObjectAdded && m_recentObjectAdded && !m_container.empty());
-
-		auto iter = m_container.find(m_initialObjectAdded->position);
+		assert(!isEmpty());
+		discardRemovedFromFront();
 
-		assert(iter != m_container.end());
-		return iter->second;
+		return m_objects[m_slots[m_ring[m_ringHead].index].objectIndex];
 	}
 
 	void pop()
 	{
-		assert(m_initialObjectAdded && m_recentObjectAdded && !m_container.empty());
+		assert(!isEmpty());
+		discardRemovedFromFront();
 
-		auto iter = m_container.find(m_initialObjectAdded->position);
-		assert(iter != m_container.end());
+		uint32_t slotIndex = m_ring[m_ringHead].index;
+		m_ringHead = (m_ringHead + 1) & (m_ring.size() - 1);
+		--m_ringSize;
 
-		if (m_container.size() == 1)
-		{
-			assert(m_initialObjectAdded == m_recentObjectAdded);
-			m_initialObjectAdded = nullptr;
-			m_recentObjectAdded = nullptr;
+		removeSlot(slotIndex);
+	}
 
+	bool remove(const glm::ivec3& position)
+	{
+		uint32_t positionIndex = findPositionIndex(position);
+		if (positionIndex != INVALID_INDEX)
+		{
+			removeSlot(m_positionIndex[positionIndex].slotIndex);
+			return true;
 		}
-		else if (m_container.size() > 1)
+
+		return false;
+	}
+
+	bool remove(ObjectQueueHandle handle)
+	{
+		if (contains(handle))
 		{
-			assert(m_initialObjectAdded->next);
-			m_initialObjectAdded = m_initialObjectAdded->next;
-			m_initialObjectAdded->previous = nullptr;
+			removeSlot(handle.index);
+			return true;
 		}
 
-		m_container.erase(iter);
+		return false;
 	}
 
 	void removeOutOfBoundsElements(const Rectangle& visibilityAABB)
+	{
+		removeOutOfBoundsElements(visibilityAABB, [](const Object&) {});
+	}
+
+	template <class OnRemove>
+	void removeOutOfBoundsElements(const Rectangle& visibilityAABB, OnRemove onRemove)
 	{
 		if (!isEmpty())
 		{
-			Object* object = &front();
-			while (object)
+			if (m_evictionBoundsSet && !m_fullEvictionRequired)
 			{
-				glm::ivec2 centrePosition(object->getPosition().x + 16, object->getPosition().z + 16);
-				Rectangle objectAABB(centrePosition, 16);
-				if (!visibilityAABB.contains(objectAABB))
-				{
-					object = remove(object);
-				}
-				else
-				{
-					object = next(object);
-				}
+				removeOutOfBoundsStrips(visibilityAABB, onRemove);
+			}
+			else
+			{
+				removeAllOutOfBoundsElements(visibilityAABB, onRemove);
 			}
 		}
+
+		m_evictionBounds = visibilityAABB;
+		m_evictionBoundsSet = true;
+		m_fullEvictionRequired = false;
 	}
 
-	Object* remove(const Object* object)
+private:
+	static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+	static constexpr size_t MIN_RING_SIZE = 16;
+	static constexpr size_t MIN_POSITION_INDEX_SIZE = 32;
+
+	struct Slot
 	{
-		assert(object);
-		auto iter = m_container.find(object->getPosition());
-		if (iter != m_container.end())
+		uint32_t objectIndex = INVALID_INDEX;
+		uint32_t generation = 0;
+	};
+
+	struct PositionIndexEntry
+	{
+		glm::ivec3 position;
+		uint32_t slotIndex = INVALID_INDEX;
+	};
+
+	struct GridRange
+	{
+		int begin;
+		int end;
+	};
+
+	std::vector<Object> m_objects;
+	std::vector<uint32_t> m_objectSlots;
+	std::vector<Slot> m_slots;
+	std::vector<uint32_t> m_freeSlots;
+	std::vector<ObjectQueueHandle> m_ring;
+	size_t m_ringHead;
+	size_t m_ringSize;
+	std::vector<PositionIndexEntry> m_positionIndex;
+	size_t m_positionIndexSize;
+	Rectangle m_evictionBounds;
+	bool m_evictionBoundsSet;
+	bool m_fullEvictionRequired;
+	std::vector<glm::ivec3> m_evictionScratch;
+
+	void removeSlot(uint32_t slotIndex)
+	{
+		Slot& slot = m_slots[slotIndex];
+		uint32_t objectIndex = slot.objectIndex;
+		assert(objectIndex != INVALID_INDEX);
+
+		erasePositionIndex(m_objects[objectIndex].getPosition());
+
+		uint32_t lastObjectIndex = static_cast<uint32_t>(m_objects.size() - 1);
+		if (objectIndex != lastObjectIndex)
 		{
-			assert(m_initialObjectAdded && m_recentObjectAdded);
-			Object* previousObject = iter->second.previous;
-			Object* nextObject = iter->second.next;
+			std::swap(m_objects[objectIndex], m_objects[lastObjectIndex]);
+			m_objectSlots[objectIndex] = m_objectSlots[lastObjectIndex];
+			m_slots[m_objectSlots[objectIndex]].objectIndex = objectIndex;
+		}
 
-			//Top
-			if (!nextObject && previousObject)
-			{
-				m_recentObjectAdded = previousObject;
-				m_recentObjectAdded->next = nullptr;
-				previousObject->next = nullptr;
-			}
-			//Bottom
-			else if (!previousObject && nextObject)
-			{
-				m_initialObjectAdded = nextObject;
-				m_initialObjectAdded->previous = nullptr;
-				nextObject->previous = nullptr;
-			}
-			//Inbetween
-			else if (previousObject && nextObject)
-			{
-				previousObject->next = nextObject;
-				nextObject->previous = previousObject;
-			}
-			else
+		m_objects.pop_back();
+		m_objectSlots.pop_back();
+
+		slot.objectIndex = INVALID_INDEX;
+		++slot.generation;
+		m_freeSlots.push_back(slotIndex);
+
+		if (m_objects.empty())
+		{
+			m_ringHead = 0;
+			m_ringSize = 0;
+		}
+	}
+
+	//Ring
+	void pushRing(ObjectQueueHandle handle)
+	{
+		if (m_ringSize == m_ring.size())
+		{
+			rebuildRing();
+		}
+
+		m_ring[(m_ringHead + m_ringSize) & (m_ring.size() - 1)] = handle;
+		++m_ringSize;
+	}
+
+	void rebuildRing()
+	{
+		size_t ringSize = MIN_RING_SIZE;
+		while (ringSize < m_objects.size() * 2)
+		{
+			ringSize *= 2;
+		}
+
+		std::vector<ObjectQueueHandle> ring(ringSize);
+		size_t liveHandles = 0;
+		for (size_t i = 0; i < m_ringSize; ++i)
+		{
+			ObjectQueueHandle handle = m_ring[(m_ringHead + i) & (m_ring.size() - 1)];
+			if (contains(handle))
 			{
-				assert(m_container.size() == 1);
-				m_initialObjectAdded = nullptr;
-				m_recentObjectAdded = nullptr;
+				ring[liveHandles] = handle;
+				++liveHandles;
 			}
+		}
 
-			m_container.erase(iter);
-			return nextObject;
+		m_ring.swap(ring);
+		m_ringHead = 0;
+		m_ringSize = liveHandles;
+	}
+
+	void discardRemovedFromFront()
+	{
+		while (!contains(m_ring[m_ringHead]))
+		{
+			assert(m_ringSize > 0);
+			m_ringHead = (m_ringHead + 1) & (m_ring.size() - 1);
+			--m_ringSize;
 		}
+	}
 
-		return nullptr;
+	//Position Index - open addressing with linear probing
+	static size_t getPositionHash(const glm::ivec3& position)
+	{
+		uint64_t hash = static_cast<uint64_t>(static_cast<uint32_t>(position.x)) * 0x9E3779B97F4A7C15ull;
+		hash ^= static_cast<uint64_t>(static_cast<uint32_t>(position.z)) * 0xC2B2AE3D27D4EB4Full;
+		hash ^= hash >> 29;
+
+		return static_cast<size_t>(hash);
 	}
 
-	Object* remove(const glm::ivec3& position)
+	uint32_t findPositionIndex(const glm::ivec3& position) const
 	{
-		auto iter = m_container.find(position);
-		if (iter != m_container.end())
+		if (m_positionIndex.empty())
 		{
-			assert(m_initialObjectAdded && m_recentObjectAdded);
-			Object* previousObject = iter->second.previous;
-			Object* nextObject = iter->second.next;
+			return INVALID_INDEX;
+		}
 
-			//Top
-			if (!nextObject && previousObject)
+		size_t mask = m_positionIndex.size() - 1;
+		for (size_t i = getPositionHash(position) & mask; m_positionIndex[i].slotIndex != INVALID_INDEX; i = (i + 1) & mask)
+		{
+			if (m_positionIndex[i].position == position)
 			{
-				m_recentObjectAdded = previousObject;
-				m_recentObjectAdded->next = nullptr;
-				previousObject->next = nullptr;
+				return static_cast<uint32_t>(i);
 			}
-			//Bottom
-			else if (!previousObject && nextObject)
+		}
+
+		return INVALID_INDEX;
+	}
+
+	void insertPositionIndex(const glm::ivec3& position, uint32_t slotIndex)
+	{
+		if ((m_positionIndexSize + 1) * 2 > m_positionIndex.size())
+		{
+			std::vector<PositionIndexEntry> positionIndex;
+			positionIndex.swap(m_positionIndex);
+			m_positionIndex.resize(positionIndex.empty() ? MIN_POSITION_INDEX_SIZE : positionIndex.size() * 2);
+			m_positionIndexSize = 0;
+
+			for (const auto& entry : positionIndex)
 			{
-				m_initialObjectAdded = nextObject;
-				m_initialObjectAdded->previous = nullptr;
-				nextObject->previous = nullptr;
+				if (entry.slotIndex != INVALID_INDEX)
+				{
+					insertPositionIndex(entry.position, entry.slotIndex);
+				}
 			}
-			//Inbetween
-			else if (previousObject && nextObject)
+		}
+
+		size_t mask = m_positionIndex.size() - 1;
+		size_t i = getPositionHash(position) & mask;
+		while (m_positionIndex[i].slotIndex != INVALID_INDEX)
+		{
+			i = (i + 1) & mask;
+		}
+
+		m_positionIndex[i].position = position;
+		m_positionIndex[i].slotIndex = slotIndex;
+		++m_positionIndexSize;
+	}
+
+	void erasePositionIndex(const glm::ivec3& position)
+	{
+		uint32_t positionIndex = findPositionIndex(position);
+		assert(positionIndex != INVALID_INDEX);
+
+		//Shift following entries of the probe sequence back so lookups never need tombstones
+		size_t mask = m_positionIndex.size() - 1;
+		size_t hole = positionIndex;
+		for (size_t i = (hole + 1) & mask; m_positionIndex[i].slotIndex != INVALID_INDEX; i = (i + 1) & mask)
+		{
+			size_t home = getPositionHash(m_positionIndex[i].position) & mask;
+			if (((i - home) & mask) >= ((i - hole) & mask))
 			{
-				previousObject->next = nextObject;
-				nextObject->previous = previousObject;
+				m_positionIndex[hole] = m_positionIndex[i];
+				hole = i;
 			}
-			else
+		}
+
+		m_positionIndex[hole].slotIndex = INVALID_INDEX;
+		--m_positionIndexSize;
+	}
+
+	//Eviction
+	static bool isInBounds(const glm::ivec3& position, const Rectangle& visibilityAABB)
+	{
+		glm::ivec2 centrePosition(position.x + Globals::CHUNK_WIDTH / 2, position.z + Globals::CHUNK_DEPTH / 2);
+		Rectangle objectAABB(centrePosition, Globals::CHUNK_WIDTH / 2);
+
+		return visibilityAABB.contains(objectAABB);
+	}
+
+	//Chunk grid positions whose AABB overlaps [min, max]
+	static GridRange getGridRange(float min, float max, int cellSize)
+	{
+		return { static_cast<int>(std::ceil((min - cellSize) / cellSize)) * cellSize,
+			static_cast<int>(std::floor(max / cellSize)) * cellSize };
+	}
+
+	template <class OnRemove>
+	void removeAllOutOfBoundsElements(const Rectangle& visibilityAABB, OnRemove& onRemove)
+	{
+		assert(m_evictionScratch.empty());
+		for (const auto& object : m_objects)
+		{
+			if (!isInBounds(object.getPosition(), visibilityAABB))
 			{
-				assert(m_container.size() == 1);
-				m_initialObjectAdded = nullptr;
-				m_recentObjectAdded = nullptr;
+				m_evictionScratch.push_back(object.getPosition());
 			}
+		}
 
-			m_container.erase(iter);
-			return nextObject;
+		for (const auto& position : m_evictionScratch)
+		{
+			uint32_t positionIndex = findPositionIndex(position);
+			assert(positionIndex != INVALID_INDEX);
+			uint32_t slotIndex = m_positionIndex[positionIndex].slotIndex;
+
+			onRemove(m_objects[m_slots[slotIndex].objectIndex]);
+			removeSlot(slotIndex);
 		}
-		
-		return nullptr;
+
+		m_evictionScratch.clear();
 	}
 
-private:
-	Object* m_initialObjectAdded;
-	Object* m_recentObjectAdded;
+	//Only the strips of the previous bounds not covered by the new bounds can hold out of bounds elements
+	template <class OnRemove>
+	void removeOutOfBoundsStrips(const Rectangle& visibilityAABB, OnRemove& onRemove)
+	{
+		GridRange previousX = getGridRange(m_evictionBounds.m_left, m_evictionBounds.m_right, Globals::CHUNK_WIDTH);
+		GridRange previousZ = getGridRange(m_evictionBounds.m_bottom, m_evictionBounds.m_top, Globals::CHUNK_DEPTH);
+		GridRange currentX = getGridRange(visibilityAABB.m_left, visibilityAABB.m_right, Globals::CHUNK_WIDTH);
+		GridRange currentZ = getGridRange(visibilityAABB.m_bottom, visibilityAABB.m_top, Globals::CHUNK_DEPTH);
+
+		int overlapWidth = std::max(0, std::min(previousX.end, currentX.end) - std::max(previousX.begin, currentX.begin) + Globals::CHUNK_WIDTH);
+		int overlapDepth = std::max(0, std::min(previousZ.end, currentZ.end) - std::max(previousZ.begin, currentZ.begin) + Globals::CHUNK_DEPTH);
+		size_t previousCells = static_cast<size_t>((previousX.end - previousX.begin) / Globals::CHUNK_WIDTH + 1) *
+			static_cast<size_t>((previousZ.end - previousZ.begin) / Globals::CHUNK_DEPTH + 1);
+		size_t overlapCells = static_cast<size_t>(overlapWidth / Globals::CHUNK_WIDTH) *
+			static_cast<size_t>(overlapDepth / Globals::CHUNK_DEPTH);
+
+		size_t stripCells = previousCells - overlapCells;
+		if (stripCells == 0)
+		{
+			return;
+		}
+		else if (stripCells > m_objects.size())
+		{
+			removeAllOutOfBoundsElements(visibilityAABB, onRemove);
+			return;
+		}
 
-	std::unordered_map<glm::ivec3, Object> m_container;
+		for (int z = previousZ.begin; z <= previousZ.end; z += Globals::CHUNK_DEPTH)
+		{
+			bool rowInBounds = z >= currentZ.begin && z <= currentZ.end;
+			for (int x = previousX.begin; x <= previousX.end; x += Globals::CHUNK_WIDTH)
+			{
+				if (rowInBounds && x >= currentX.begin && x <= currentX.end)
+				{
+					x = currentX.end;
+					continue;
+				}
+
+				uint32_t positionIndex = findPositionIndex({ x, 0, z });
+				if (positionIndex != INVALID_INDEX)
+				{
+					uint32_t slotIndex = m_positionIndex[positionIndex].slotIndex;
+					onRemove(m_objects[m_slots[slotIndex].objectIndex]);
+					removeSlot(slotIndex);
+				}
+			}
+		}
+	}
 };
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 330 core
+
+out vec4 color;
+
+//Left, bottom, right, top of the loaded chunks the heightmap is kept out of
+uniform vec4 uVisibilityHole;
+
+in vec3 vColour;
+in vec2 vWorldPosition;
+
+void main()
+{
+	if (vWorldPosition.x > uVisibilityHole.x && vWorldPosition.x < uVisibilityHole.z &&
+		vWorldPosition.y > uVisibilityHole.y && vWorldPosition.y < uVisibilityHole.w)
+	{
+		discard;
+	}
+
+	color = vec4(vColour, 1.0);
+}
\ No newline at end of file
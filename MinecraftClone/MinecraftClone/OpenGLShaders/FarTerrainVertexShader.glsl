@@ -0,0 +1,17 @@
+#version 330 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aColour;
+
+uniform mat4 uView;
+uniform mat4 uProjection;
+
+out vec3 vColour;
+out vec2 vWorldPosition;
+
+void main()
+{
+	gl_Position = uProjection * uView * vec4(aPos, 1.0);
+	vColour = aColour;
+	vWorldPosition = aPos.xz;
+}
\ No newline at end of file
@@ -1,15 +1,87 @@
 #include "PickupManager.h"
 #include "Player.h"
+#include "ChunkManager.h"
 #include "Globals.h"
 #include "ShaderHandler.h"
 #include "GameMessenger.h"
 #include "GameMessages.h"
+#include "CollisionHandler.h"
+#include "MeshGenerator.h"
+#include "MemoryAccounting.h"
+#include "Frustum.h"
+#include "Rectangle.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr size_t INITIAL_PICKUP_CAPACITY = 256;
+	constexpr float MOVEMENT_SPEED = 3.0f;
+	constexpr float GRAVITY = 9.0f;
+	//Leaves room underneath for the pickup to bob up and down
+	constexpr float HOVER_HEIGHT = 0.15f;
+	constexpr glm::vec3 COLLISION_BOX_MINIMUM = { 0.0f, -HOVER_HEIGHT, 0.0f };
+	constexpr glm::vec3 COLLISION_BOX_MAXIMUM = { Globals::PICKUP_CUBE_FACE_SIZE, Globals::PICKUP_CUBE_FACE_SIZE, Globals::PICKUP_CUBE_FACE_SIZE };
+	constexpr float MAXIMUM_DISTANCE_FROM_PLAYER = 2.5f;
+	constexpr float MINIMUM_DISTANCE_FROM_PLAYER = 1.0f;
+	constexpr float DESTROYED_CUBE_MIN_TIME_COLLECTION = 0.5f;
+	constexpr float PLAYER_DISGARD_MIN_TIME_COLLECTION = 1.5;
+	constexpr glm::vec3 STARTING_POSITION_OFFSET = { 0.35f, 0.35f, 0.35f };
+	constexpr glm::vec3 INITIAL_FORCE_AMPLIFIER = { 1.5f, 2.8f, 1.5f };
+	constexpr unsigned int INSTANCE_POSITION_ATTRIBUTE = 3;
+	//Matches the size of an inventory item
+	constexpr int MAX_STACK_QUANTITY = 64;
+	//Also the size of a cell in the spatial hash so merges are only ever with the surrounding cells
+	constexpr float MERGE_DISTANCE = 0.75f;
+
+	glm::ivec3 getCell(const glm::vec3& position)
+	{
+		return { std::floor(position.x / MERGE_DISTANCE), std::floor(position.y / MERGE_DISTANCE), std::floor(position.z / MERGE_DISTANCE) };
+	}
+
+	size_t getCellHash(const glm::ivec3& cell, eCubeType cubeType)
+	{
+		return (static_cast<size_t>(static_cast<unsigned int>(cell.x) * 73856093u) ^
+			static_cast<size_t>(static_cast<unsigned int>(cell.y) * 19349663u) ^
+			static_cast<size_t>(static_cast<unsigned int>(cell.z) * 83492791u) ^
+			static_cast<size_t>(static_cast<unsigned int>(cubeType) * 2654435761u));
+	}
+}
 
 PickupManager::PickupManager()
-	: m_pickUps()
+	: m_cubeTypes(),
+	m_quantities(),
+	m_positions(),
+	m_velocities(),
+	m_collectionTimes(),
+	m_yOffsets(),
+	m_timeElasped(),
+	m_onGround(),
+	m_cellHeads(),
+	m_nextInCell(),
+	m_meshes(),
+	m_visiblePickups(),
+	m_instancePositions(),
+	m_instanceCounts(),
+	m_instanceBufferID(Globals::INVALID_OPENGL_ID),
+	m_instanceBufferCapacity(0)
 {
+	m_cubeTypes.reserve(INITIAL_PICKUP_CAPACITY);
+	m_quantities.reserve(INITIAL_PICKUP_CAPACITY);
+	m_positions.reserve(INITIAL_PICKUP_CAPACITY);
+	m_velocities.reserve(INITIAL_PICKUP_CAPACITY);
+	m_collectionTimes.reserve(INITIAL_PICKUP_CAPACITY);
+	m_yOffsets.reserve(INITIAL_PICKUP_CAPACITY);
+	m_timeElasped.reserve(INITIAL_PICKUP_CAPACITY);
+	m_onGround.reserve(INITIAL_PICKUP_CAPACITY);
+	m_nextInCell.reserve(INITIAL_PICKUP_CAPACITY);
+	m_visiblePickups.reserve(INITIAL_PICKUP_CAPACITY);
+	m_instancePositions.reserve(INITIAL_PICKUP_CAPACITY);
+
 	subscribeToMessenger<GameMessages::SpawnPickUp>([this](const GameMessages::SpawnPickUp& message) { return onSpawnPickUp(message); }, this);
-	
+
 	subscribeToMessenger<GameMessages::PlayerDisgardPickup>(
 		[this](const GameMessages::PlayerDisgardPickup& gameMessage) { return onPlayerDisgardPickup(gameMessage); }, this);
 }
@@ -18,52 +90,322 @@ PickupManager::~PickupManager()
 {
 	unsubscribeToMessenger<GameMessages::SpawnPickUp>(this);
 	unsubscribeToMessenger<GameMessages::PlayerDisgardPickup>(this);
+
+	if (m_instanceBufferID != Globals::INVALID_OPENGL_ID)
+	{
+		glDeleteBuffers(1, &m_instanceBufferID);
+		MemoryAccounting::onRelease(eMemoryCategory::GPUMeshes, m_instanceBufferCapacity * sizeof(glm::vec3));
+	}
 }
 
-void PickupManager::update(float deltaTime, const Player& player, std::mutex& chunkInteractionMutex, const ChunkManager& chunkManager)
+void PickupManager::update(float deltaTime, const Player& player, InstrumentedMutex& chunkInteractionMutex, const ChunkManager& chunkManager)
 {
-	Rectangle visibilityRect = Globals::getVisibilityRect(player.getPosition());
-	std::lock_guard<std::mutex> chunkInteractionLock(chunkInteractionMutex);
-	for (auto pickup = m_pickUps.begin(); pickup != m_pickUps.end();)
+	PROFILE_SCOPE("PickupManager::update");
+	static MetricGauge& pickups = Metrics::getGauge("Pickups");
+	Rectangle visibilityRect = Globals::getVisibilityRect(player.getPosition(), chunkManager.getVisibilityDistance());
+	glm::vec3 playerMiddlePosition = player.getMiddlePosition();
+	InstrumentedLock chunkInteractionLock(chunkInteractionMutex, LOCK_SITE("PickupManager::update"));
+	for (size_t i = 0; i < m_positions.size();)
 	{
-		const glm::vec3& pickupPosition = pickup->getPosition();
-		if (!visibilityRect.contains({ pickupPosition.x, pickupPosition.z }))
+		if (!visibilityRect.contains({ m_positions[i].x, m_positions[i].z }))
 		{
-			pickup = m_pickUps.erase(pickup);
+			removePickup(i);
 		}
-		else if (pickup->isInReachOfPlayer(player.getMiddlePosition()))
+		else if (m_collectionTimes[i] <= 0.0f &&
+			Globals::getSqrMagnitude(m_positions[i], playerMiddlePosition) <= MINIMUM_DISTANCE_FROM_PLAYER * MINIMUM_DISTANCE_FROM_PLAYER &&
+			player.getInventory().getAddableQuantity(m_cubeTypes[i]) > 0)
 		{
-			broadcastToMessenger<GameMessages::AddToInventory>({ pickup->getCubeType() });
-			//GameMessenger<GameMessages::AddToInventory>::getInstance().broadcast({ pickup->getCubeType() });
-			//GameMessenger::getInstance().broadcast<GameMessages::AddToInventory>({ pickup->getCubeType() });
-			pickup = m_pickUps.erase(pickup);
+			//Whatever doesn't fit in the inventory is left behind as a smaller stack
+			int quantity = std::min(m_quantities[i], player.getInventory().getAddableQuantity(m_cubeTypes[i]));
+			broadcastToMessenger<GameMessages::AddToInventory>({ m_cubeTypes[i], quantity });
+			m_quantities[i] -= quantity;
+			if (m_quantities[i] == 0)
+			{
+				removePickup(i);
+			}
+			else
+			{
+				++i;
+			}
 		}
 		else
 		{
-			pickup->update(player, deltaTime, chunkManager);
-			++pickup;
+			++i;
 		}
 	}
+
+	std::array<bool, MESH_COUNT> addableCubeTypes;
+	for (size_t cubeType = 0; cubeType < addableCubeTypes.size(); ++cubeType)
+	{
+		addableCubeTypes[cubeType] = player.getInventory().isItemAddable(static_cast<eCubeType>(cubeType));
+	}
+
+	for (size_t i = 0; i < m_positions.size(); ++i)
+	{
+		m_collectionTimes[i] -= deltaTime;
+		m_velocities[i].y -= m_onGround[i] ? 0.0f : GRAVITY * deltaTime;
+	}
+
+	for (size_t i = 0; i < m_positions.size(); ++i)
+	{
+		glm::vec3 towardsPlayer = playerMiddlePosition - m_positions[i];
+		if (m_collectionTimes[i] <= 0.0f && addableCubeTypes[static_cast<size_t>(m_cubeTypes[i])] &&
+			glm::dot(towardsPlayer, towardsPlayer) <= MAXIMUM_DISTANCE_FROM_PLAYER * MAXIMUM_DISTANCE_FROM_PLAYER)
+		{
+			m_velocities[i] += glm::normalize(towardsPlayer) * MOVEMENT_SPEED;
+		}
+	}
+
+	//Only the collision needs the chunks so is the only pass that isn't a straight run over the arrays
+	for (size_t i = 0; i < m_positions.size(); ++i)
+	{
+		glm::vec3& position = m_positions[i];
+		glm::vec3& velocity = m_velocities[i];
+
+		//A cube has been placed on top of the pickup
+		if (CollisionHandler::isColliding(position, COLLISION_BOX_MINIMUM, COLLISION_BOX_MAXIMUM, chunkManager))
+		{
+			position.y = std::floor(position.y + COLLISION_BOX_MINIMUM.y) + Globals::CUBE_FACE_SIZE - COLLISION_BOX_MINIMUM.y;
+			velocity.y = 0.0f;
+		}
+
+		CollisionHandler::move(position, velocity, deltaTime, COLLISION_BOX_MINIMUM, COLLISION_BOX_MAXIMUM, chunkManager);
+		m_onGround[i] = velocity.y <= 0.0f && CollisionHandler::isOnGround(position, COLLISION_BOX_MINIMUM, COLLISION_BOX_MAXIMUM, chunkManager);
+		if (m_onGround[i])
+		{
+			velocity.y = 0.0f;
+		}
+	}
+
+	for (size_t i = 0; i < m_positions.size(); ++i)
+	{
+		if (m_onGround[i])
+		{
+			m_timeElasped[i] += deltaTime;
+			m_yOffsets[i] = glm::sin(m_timeElasped[i] * 2.0f) * 0.1f;
+		}
+
+		CollisionHandler::applyDrag(m_velocities[i].x, m_velocities[i].z, 0.95f);
+	}
+
+	mergeRestingPickups();
+	pickups.set(static_cast<int64_t>(m_positions.size()));
 }
 
 void PickupManager::render(const Frustum& frustum, ShaderHandler& shaderHandler, const glm::mat4& view, const glm::mat4& projection)
 {
+	PROFILE_SCOPE("PickupManager::render");
+	//Bucket the visible pickups by cube type so each type is one contiguous run of the instance buffer
+	m_visiblePickups.clear();
+	m_instanceCounts.fill(0);
+	for (size_t i = 0; i < m_positions.size(); ++i)
+	{
+		if (frustum.isPositionInFrustum(m_positions[i]))
+		{
+			m_visiblePickups.push_back(i);
+			++m_instanceCounts[static_cast<size_t>(m_cubeTypes[i])];
+		}
+	}
+
+	if (m_visiblePickups.empty())
+	{
+		return;
+	}
+
+	std::array<int, MESH_COUNT> instanceOffsets;
+	int instanceOffset = 0;
+	for (size_t cubeType = 0; cubeType < MESH_COUNT; ++cubeType)
+	{
+		instanceOffsets[cubeType] = instanceOffset;
+		instanceOffset += m_instanceCounts[cubeType];
+	}
+
+	m_instancePositions.resize(m_visiblePickups.size());
+	std::array<int, MESH_COUNT> instanceIndicies = instanceOffsets;
+	for (size_t i : m_visiblePickups)
+	{
+		m_instancePositions[instanceIndicies[static_cast<size_t>(m_cubeTypes[i])]++] = m_positions[i] + glm::vec3(0.0f, m_yOffsets[i], 0.0f);
+	}
+
+	uploadInstancePositions();
+
+	int64_t drawCalls = 0;
+	int64_t indices = 0;
 	shaderHandler.switchToShader(eShaderType::Pickup);
 	shaderHandler.setUniformMat4f(eShaderType::Pickup, "uView", view);
 	shaderHandler.setUniformMat4f(eShaderType::Pickup, "uProjection", projection);
 
-	for (auto& pickUp : m_pickUps)
+	for (size_t cubeType = 0; cubeType < MESH_COUNT; ++cubeType)
+	{
+		if (m_instanceCounts[cubeType] == 0)
+		{
+			continue;
+		}
+
+		VertexArray& mesh = m_meshes[cubeType];
+		if (mesh.m_opaqueVertexBuffer.bindToVAO)
+		{
+			mesh.attachOpaqueVBO();
+			glEnableVertexAttribArray(INSTANCE_POSITION_ATTRIBUTE);
+			glVertexAttribDivisor(INSTANCE_POSITION_ATTRIBUTE, 1);
+		}
+
+		assert(mesh.m_opaqueVertexBuffer.displayable);
+		mesh.bindOpaqueVAO();
+		glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferID);
+		glVertexAttribPointer(INSTANCE_POSITION_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3),
+			(const void*)(instanceOffsets[cubeType] * sizeof(glm::vec3)));
+
+		glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(mesh.m_opaqueVertexBuffer.indicies.size()), GL_UNSIGNED_INT, nullptr,
+			m_instanceCounts[cubeType]);
+		++drawCalls;
+		indices += static_cast<int64_t>(mesh.m_opaqueVertexBuffer.indicies.size()) * m_instanceCounts[cubeType];
+	}
+
+	Metrics::addFrameDraws(drawCalls, indices);
+}
+
+void PickupManager::addPickup(eCubeType cubeType, const glm::vec3& position, const glm::vec3& velocity, float collectionTime)
+{
+	VertexBuffer& mesh = m_meshes[static_cast<size_t>(cubeType)].m_opaqueVertexBuffer;
+	if (!mesh.displayable && !mesh.bindToVAO)
 	{
-		pickUp.render(frustum, shaderHandler);
+		MeshGenerator::generatePickUpMesh(mesh, cubeType);
 	}
+
+	m_cubeTypes.push_back(cubeType);
+	m_quantities.push_back(1);
+	m_positions.push_back(position);
+	m_velocities.push_back(velocity);
+	m_collectionTimes.push_back(collectionTime);
+	m_yOffsets.push_back(0.0f);
+	m_timeElasped.push_back(0.0f);
+	m_onGround.push_back(false);
+}
+
+void PickupManager::removePickup(size_t index)
+{
+	assert(index < m_positions.size());
+	size_t lastIndex = m_positions.size() - 1;
+	m_cubeTypes[index] = m_cubeTypes[lastIndex];
+	m_quantities[index] = m_quantities[lastIndex];
+	m_positions[index] = m_positions[lastIndex];
+	m_velocities[index] = m_velocities[lastIndex];
+	m_collectionTimes[index] = m_collectionTimes[lastIndex];
+	m_yOffsets[index] = m_yOffsets[lastIndex];
+	m_timeElasped[index] = m_timeElasped[lastIndex];
+	m_onGround[index] = m_onGround[lastIndex];
+
+	m_cubeTypes.pop_back();
+	m_quantities.pop_back();
+	m_positions.pop_back();
+	m_velocities.pop_back();
+	m_collectionTimes.pop_back();
+	m_yOffsets.pop_back();
+	m_timeElasped.pop_back();
+	m_onGround.pop_back();
+}
+
+void PickupManager::mergeRestingPickups()
+{
+	//Buckets of the spatial hash are chained through m_nextInCell - both only grow, so merging doesn't allocate once warmed up
+	size_t cellHeadCount = 1;
+	while (cellHeadCount < m_positions.size() * 2)
+	{
+		cellHeadCount *= 2;
+	}
+
+	m_cellHeads.assign(std::max(cellHeadCount, m_cellHeads.size()), -1);
+	m_nextInCell.resize(m_positions.size());
+	size_t cellHashMask = m_cellHeads.size() - 1;
+	int restingPickupCount = 0;
+	for (size_t i = 0; i < m_positions.size(); ++i)
+	{
+		if (m_onGround[i])
+		{
+			size_t cellHead = getCellHash(getCell(m_positions[i]), m_cubeTypes[i]) & cellHashMask;
+			m_nextInCell[i] = m_cellHeads[cellHead];
+			m_cellHeads[cellHead] = static_cast<int>(i);
+			++restingPickupCount;
+		}
+	}
+
+	if (restingPickupCount < 2)
+	{
+		return;
+	}
+
+	//Merged pickups are left with no quantity until they're removed below
+	for (size_t i = 0; i < m_positions.size(); ++i)
+	{
+		if (!m_onGround[i] || m_quantities[i] == 0 || m_quantities[i] >= MAX_STACK_QUANTITY)
+		{
+			continue;
+		}
+
+		glm::ivec3 cell = getCell(m_positions[i]);
+		for (int x = cell.x - 1; x <= cell.x + 1; ++x)
+		{
+			for (int y = cell.y - 1; y <= cell.y + 1; ++y)
+			{
+				for (int z = cell.z - 1; z <= cell.z + 1; ++z)
+				{
+					for (int j = m_cellHeads[getCellHash({ x, y, z }, m_cubeTypes[i]) & cellHashMask]; j != -1; j = m_nextInCell[j])
+					{
+						if (j != static_cast<int>(i) && m_quantities[j] > 0 &&
+							m_cubeTypes[j] == m_cubeTypes[i] &&
+							m_quantities[i] + m_quantities[j] <= MAX_STACK_QUANTITY &&
+							Globals::getSqrMagnitude(m_positions[i], m_positions[j]) <= MERGE_DISTANCE * MERGE_DISTANCE)
+						{
+							m_quantities[i] += m_quantities[j];
+							m_quantities[j] = 0;
+							m_collectionTimes[i] = std::max(m_collectionTimes[i], m_collectionTimes[j]);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	for (size_t i = m_positions.size(); i-- > 0;)
+	{
+		if (m_quantities[i] == 0)
+		{
+			removePickup(i);
+		}
+	}
+}
+
+void PickupManager::uploadInstancePositions()
+{
+	if (m_instanceBufferID == Globals::INVALID_OPENGL_ID)
+	{
+		glGenBuffers(1, &m_instanceBufferID);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferID);
+	if (m_instancePositions.size() > m_instanceBufferCapacity)
+	{
+		size_t instanceBufferCapacity = std::max(m_instancePositions.capacity(), INITIAL_PICKUP_CAPACITY);
+		MemoryAccounting::onResize(eMemoryCategory::GPUMeshes, m_instanceBufferCapacity * sizeof(glm::vec3),
+			instanceBufferCapacity * sizeof(glm::vec3));
+		m_instanceBufferCapacity = instanceBufferCapacity;
+	}
+
+	//Orphaned each frame so the driver never waits on last frame's draws
+	glBufferData(GL_ARRAY_BUFFER, m_instanceBufferCapacity * sizeof(glm::vec3), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, m_instancePositions.size() * sizeof(glm::vec3), m_instancePositions.data());
 }
 
 void PickupManager::onPlayerDisgardPickup(const GameMessages::PlayerDisgardPickup& gameMessage)
 {
-	m_pickUps.emplace_back(gameMessage.cubeType, gameMessage.position, gameMessage.initialVelocity);
+	addPickup(gameMessage.cubeType, gameMessage.position, gameMessage.initialVelocity, PLAYER_DISGARD_MIN_TIME_COLLECTION);
 }
 
 void PickupManager::onSpawnPickUp(const GameMessages::SpawnPickUp& gameMessage)
 {
-	m_pickUps.emplace_back(gameMessage.type, gameMessage.position);
+	glm::vec2 n = glm::normalize(glm::vec2(Globals::getRandomNumber(-1.0f, 1.0f), Globals::getRandomNumber(-1.0f, 1.0f)));
+	glm::vec3 initialVelocity(INITIAL_FORCE_AMPLIFIER.x * n.x, INITIAL_FORCE_AMPLIFIER.y, INITIAL_FORCE_AMPLIFIER.z * n.y);
+
+	addPickup(gameMessage.type, gameMessage.position + STARTING_POSITION_OFFSET, initialVelocity, DESTROYED_CUBE_MIN_TIME_COLLECTION);
 }
\ No newline at end of file
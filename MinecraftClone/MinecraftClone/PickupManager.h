@@ -3,28 +3,57 @@
 #include "Globals.h"
 #include "NonCopyable.h"
 #include "NonMovable.h"
-#include "Pickup.h"
-#include <mutex>
+#include "CubeType.h"
+#include "VertexArray.h"
+#include "InstrumentedMutex.h"
+#include <array>
+#include <vector>
 
 class Frustum;
 class ShaderHandler;
 class Player;
+class ChunkManager;
 namespace GameMessages
 {
 	struct PlayerDisgardPickup;
 	struct SpawnPickUp;
 }
+//Pickups are held as parallel arrays - removed by swapping in the last pickup
+//Drawn instanced with one shared mesh per cube type, positions streamed in every frame
+//Resting pickups of the same type close to each other merge into one stack
 class PickupManager : private NonCopyable, private NonMovable
 {
 public:
+	static constexpr size_t MESH_COUNT = static_cast<size_t>(eCubeType::Max) + 1;
+
 	PickupManager();
 	~PickupManager();
 
-	void update(float deltaTime, const Player& player, std::mutex& chunkInteractionMutex, const ChunkManager& chunkManager);
+	void update(float deltaTime, const Player& player, InstrumentedMutex& chunkInteractionMutex, const ChunkManager& chunkManager);
 	void render(const Frustum& frustum, ShaderHandler& shaderHandler, const glm::mat4& view, const glm::mat4& projection);
 
 private:
-	std::vector<Pickup> m_pickUps;
+	std::vector<eCubeType> m_cubeTypes;
+	std::vector<int> m_quantities;
+	std::vector<glm::vec3> m_positions;
+	std::vector<glm::vec3> m_velocities;
+	std::vector<float> m_collectionTimes;
+	std::vector<float> m_yOffsets;
+	std::vector<float> m_timeElasped;
+	std::vector<char> m_onGround;
+	std::vector<int> m_cellHeads;
+	std::vector<int> m_nextInCell;
+	std::array<VertexArray, MESH_COUNT> m_meshes;
+	std::vector<size_t> m_visiblePickups;
+	std::vector<glm::vec3> m_instancePositions;
+	std::array<int, MESH_COUNT> m_instanceCounts;
+	unsigned int m_instanceBufferID;
+	size_t m_instanceBufferCapacity;
+
+	void addPickup(eCubeType cubeType, const glm::vec3& position, const glm::vec3& velocity, float collectionTime);
+	void removePickup(size_t index);
+	void mergeRestingPickups();
+	void uploadInstancePositions();
 
 	void onPlayerDisgardPickup(const GameMessages::PlayerDisgardPickup& gameMessage);
 	void onSpawnPickUp(const GameMessages::SpawnPickUp& gameMessage);
@@ -4,13 +4,13 @@
 #include <cmath>
 #include <iostream>
 #include "BoundingBox.h"
-#include "PickUp.h"
 #include "CollisionHandler.h"
 #include "Gui.h"
 #include "DestroyBlockVisual.h"
 #include "SelectedVoxelVisual.h"
 #include "GameMessenger.h"
 #include "GameMessages.h"
+#include "Profiler.h"
 #include <memory>
 
 namespace 
@@ -34,63 +34,16 @@ namespace
 	constexpr float JUMP_BREAK = 1.0f;
 	constexpr float MS_BETWEEN_JUMP = .25f;
 
-	constexpr float DESTROY_BLOCK_MAX_DISTANCE = 5.0f;
-	constexpr float DESTROY_BLOCK_INCREMENT = 0.5f;
-	constexpr float PLACE_BLOCK_RANGE = 5.0f;
-	constexpr float PLACE_BLOCK_INCREMENT = 0.1f;
+	//Selecting, destroying and placing cubes all share the one ray a frame
+	constexpr float REACH_DISTANCE = 5.0f;
 
 	constexpr float COLLISION_OFFSET = 0.35f;
+	constexpr glm::vec3 COLLISION_BOX_MINIMUM = { -COLLISION_OFFSET, -HEAD_HEIGHT, -COLLISION_OFFSET };
+	constexpr glm::vec3 COLLISION_BOX_MAXIMUM = { COLLISION_OFFSET, COLLISION_OFFSET, COLLISION_OFFSET };
 	
 	constexpr float MS_BETWEEN_PLACE_CUBE = 0.25f;
 
 	constexpr glm::vec3 DISCARD_ITEM_SPEED = { 10.0f, 5.7f, 10.0f };
-
-	constexpr float SLOW_DESTROY_TIME = 4.0f;
-	const CubeTypeComparison SLOW_DESTROYABLE_CUBE_TYPES =
-	{
-		{eCubeType::Stone,
-		eCubeType::Log,
-		eCubeType::LogTop}
-	};
-
-	constexpr float NORMAL_DESTROY_TIME = 0.75f;
-	const CubeTypeComparison NORMAL_DESTROYABLE_CUBE_TYPES =
-	{
-		{eCubeType::Grass, 
-		eCubeType::Dirt}
-	};
-
-	constexpr float FAST_DESTROY_TIME = 0.35f;
-	const CubeTypeComparison FAST_DESTROYABLE_CUBE_TYPES =
-	{
-		{eCubeType::Sand,
-		eCubeType::Leaves,
-		eCubeType::Cactus,
-		eCubeType::CactusTop}
-	};
-
-	const CubeTypeComparison INSTANT_DESTROYABLE_CUBE_TYPES =
-	{
-		{eCubeType::TallGrass,
-		eCubeType::Shrub}
-	};
-
-	const CubeTypeComparison NON_DESTROYABLE_CUBE_TYPES =
-	{
-		{eCubeType::Water}
-	};
-
-	const CubeTypeComparison NON_COLLECTABLE_CUBE_TYPES =
-	{
-		{ eCubeType::Shrub,
-		eCubeType::TallGrass,
-		eCubeType::Leaves}
-	};
-
-	const CubeTypeComparison NON_SELECTABLE_CUBE_TYPES =
-	{
-		{eCubeType::Water}
-	};
 }
 
 //Camera
@@ -98,7 +51,7 @@ Camera::Camera()
 	: FOV(50.0f),
 	sensitivity(4.0f),
 	nearPlaneDistance(0.1f),
-	farPlaneDistance(1750.f),
+	farPlaneDistance(12000.0f),
 	front(),
 	right(),
 	up({ 0.0f, 1.0f, 0.0f }),
@@ -166,7 +119,7 @@ const Timer& Player::getDestroyCubeTimer() const
 	return m_destroyCubeTimer;
 }
 
-bool Player::isUnderWater(const ChunkManager& chunkManager, std::mutex& chunkInteractionMutex) const
+bool Player::isUnderWater(const ChunkManager& chunkManager, InstrumentedMutex& chunkInteractionMutex) const
 {
 	if (m_currentState != ePlayerState::InWater)
 	{
@@ -174,7 +127,7 @@ bool Player::isUnderWater(const ChunkManager& chunkManager, std::mutex& chunkInt
 	}
 
 	eCubeType cubeAtHeadPosition;
-	std::lock_guard<std::mutex> playerLock(chunkInteractionMutex);
+	InstrumentedLock playerLock(chunkInteractionMutex, LOCK_SITE("Player::isUnderWater"));
 	if (chunkManager.isCubeAtPosition( { std::floor(m_position.x), std::floor(m_position.y) + 0.35f, std::floor(m_position.z) }, cubeAtHeadPosition))
 	{
 		assert(cubeAtHeadPosition != eCubeType::Air);
@@ -205,141 +158,81 @@ const Inventory& Player::getInventory() const
 	return m_inventory;
 }
 
-void Player::placeBlock(ChunkManager& chunkManager)
+void Player::placeBlock(ChunkManager& chunkManager, const VoxelRaycastHit& facingCube)
 {
-	if (m_inventory.isSelectedItemEmpty())
+	if (m_inventory.isSelectedItemEmpty() || !facingCube.placementFound)
 	{
 		return;
 	}
-	
-	bool blockPlaced = false;
-	for (int i = 0; i <= std::ceil(PLACE_BLOCK_RANGE / PLACE_BLOCK_INCREMENT); ++i)
+
+	for (int y = -static_cast<int>(HEAD_HEIGHT); y <= 0; y++)
 	{
-		glm::vec3 rayPosition = m_camera.front * (static_cast<float>(i) * PLACE_BLOCK_INCREMENT) + m_position;
-		if (chunkManager.isCubeAtPosition({ std::floor(rayPosition.x), std::floor(rayPosition.y), std::floor(rayPosition.z) }))
+		if (glm::ivec3(std::floor(m_position.x), std::floor(m_position.y - 2.0f), std::floor(m_position.z)) ==
+			glm::ivec3(facingCube.placementPosition.x, facingCube.placementPosition.y + y, facingCube.placementPosition.z))
 		{
-			for (int j = i; j >= 0; --j)
-			{
-				rayPosition = m_camera.front * (static_cast<float>(j) * PLACE_BLOCK_INCREMENT) + m_position;
-				if (!chunkManager.isCubeAtPosition({ std::floor(rayPosition.x), std::floor(rayPosition.y), std::floor(rayPosition.z) }))
-				{
-					bool availablePostion = true;
-					for (int y = -static_cast<int>(HEAD_HEIGHT); y <= 0; y++)
-					{
-						if (glm::vec3(std::floor(m_position.x), std::floor(m_position.y - 2.0f), std::floor(m_position.z)) == 
-						glm::vec3(std::floor(rayPosition.x), std::floor(rayPosition.y + y), std::floor(rayPosition.z) ))
-						{
-							availablePostion = false;
-							break;
-						}
-					}
-
-					if (availablePostion)
-					{
-						eCubeType cubeTypeToPlace = m_inventory.getSelectedItemType();
-						if (chunkManager.placeCubeAtPosition({ std::floor(rayPosition.x), std::floor(rayPosition.y), std::floor(rayPosition.z) }, cubeTypeToPlace))
-						{
-							m_inventory.reduceSelectedItem();
-						}
-					}
-					
-					blockPlaced = true;
-					break;
-				}
-			}
-
-			break;
+			return;
 		}
 	}
 
-	if (!blockPlaced)
+	eCubeType cubeTypeToPlace = m_inventory.getSelectedItemType();
+	if (chunkManager.placeCubeAtPosition(facingCube.placementPosition, cubeTypeToPlace))
 	{
-		for (int i = static_cast<int>(std::ceil(PLACE_BLOCK_RANGE / PLACE_BLOCK_INCREMENT)); i >= 0; --i)
-		{
-			glm::vec3 rayPosition = m_camera.front * (static_cast<float>(i) * PLACE_BLOCK_INCREMENT) + m_position;
-			eCubeType cubeTypeToPlace = m_inventory.getSelectedItemType();
-			if (chunkManager.placeCubeAtPosition({ std::floor(rayPosition.x), std::floor(rayPosition.y), std::floor(rayPosition.z) }, cubeTypeToPlace))
-			{
-				m_inventory.reduceSelectedItem();
-				break;
-			}
-		}
+		m_inventory.reduceSelectedItem();
 	}
 }
 
-void Player::destroyFacingBlock(ChunkManager& chunkManager)
+void Player::destroyFacingBlock(ChunkManager& chunkManager, const VoxelRaycastHit* facingCube)
 {
 	eCubeType cubeTypeToDestroy;
 	if (m_destroyCubeTimer.isExpired() &&
 		chunkManager.destroyCubeAtPosition(m_cubeToDestroyPosition, cubeTypeToDestroy))
 	{
 		assert(cubeTypeToDestroy != eCubeType::Air &&
-			!NON_DESTROYABLE_CUBE_TYPES.isMatch(cubeTypeToDestroy));
+			getCubeTypeProperties(cubeTypeToDestroy).destroyable);
 
 		m_destroyCubeTimer.resetElaspedTime();
 		m_destroyCubeTimer.setActive(false);
 
-		if (!NON_COLLECTABLE_CUBE_TYPES.isMatch(cubeTypeToDestroy))
+		if (getCubeTypeProperties(cubeTypeToDestroy).collectable)
 		{
 			broadcastToMessenger<GameMessages::SpawnPickUp>({ cubeTypeToDestroy, m_cubeToDestroyPosition });
 		}
 		
 		m_destroyBlockVisual.reset();
+		//The facing cube was found before it was destroyed - pick the next one next frame
+		return;
 	}
-	
-	for (int i = 0; i <= std::ceil(DESTROY_BLOCK_MAX_DISTANCE / DESTROY_BLOCK_INCREMENT); ++i)
+
+	if (facingCube && getCubeTypeProperties(facingCube->cubeType).destroyable)
 	{
-		glm::vec3 rayPosition = m_camera.front * (static_cast<float>(i) * DESTROY_BLOCK_INCREMENT) + m_position;
-		if (chunkManager.isCubeAtPosition({ std::floor(rayPosition.x), std::floor(rayPosition.y), std::floor(rayPosition.z) }, cubeTypeToDestroy) &&
-			!NON_DESTROYABLE_CUBE_TYPES.isMatch(cubeTypeToDestroy))
+		float destroyTime = getCubeTypeProperties(facingCube->cubeType).destroyTime;
+		if (destroyTime != CubeTypeRegistry::INSTANT_DESTROY_TIME)
 		{
-			if (!INSTANT_DESTROYABLE_CUBE_TYPES.isMatch(cubeTypeToDestroy))
-			{
-				if (!m_destroyCubeTimer.isActive() || glm::ivec3(std::floor(rayPosition.x), std::floor(rayPosition.y), std::floor(rayPosition.z)) !=
-						m_cubeToDestroyPosition)
-				{
-					float destroyTime = 0.0f;
-					if (SLOW_DESTROYABLE_CUBE_TYPES.isMatch(cubeTypeToDestroy))
-					{
-						destroyTime = SLOW_DESTROY_TIME;
-					}
-					else if (NORMAL_DESTROYABLE_CUBE_TYPES.isMatch(cubeTypeToDestroy))
-					{
-						destroyTime = NORMAL_DESTROY_TIME;
-					}
-					else if (FAST_DESTROYABLE_CUBE_TYPES.isMatch(cubeTypeToDestroy))
-					{
-						destroyTime = FAST_DESTROY_TIME;
-					}
-					assert(destroyTime != 0.0f);
-
-					m_destroyCubeTimer.resetElaspedTime();
-					m_cubeToDestroyPosition = { std::floor(rayPosition.x), std::floor(rayPosition.y), std::floor(rayPosition.z) };
-					m_destroyCubeTimer.setNewExpirationTime(destroyTime);
-					m_destroyCubeTimer.setActive(true);
-					
-					m_destroyBlockVisual.set(m_cubeToDestroyPosition, m_destroyCubeTimer.getExpirationTime());
-				}
-			}
-			else
+			if (!m_destroyCubeTimer.isActive() || facingCube->position != m_cubeToDestroyPosition)
 			{
-				chunkManager.destroyCubeAtPosition(
-					{ std::floor(rayPosition.x), std::floor(rayPosition.y), std::floor(rayPosition.z) }, cubeTypeToDestroy);
-			}
+				m_destroyCubeTimer.resetElaspedTime();
+				m_cubeToDestroyPosition = facingCube->position;
+				m_destroyCubeTimer.setNewExpirationTime(destroyTime);
+				m_destroyCubeTimer.setActive(true);
 
-			break;
+				m_destroyBlockVisual.set(m_cubeToDestroyPosition, m_destroyCubeTimer.getExpirationTime());
+			}
+		}
+		else
+		{
+			chunkManager.destroyCubeAtPosition(facingCube->position, cubeTypeToDestroy);
 		}
 	}
 }
 
-void Player::spawn(const ChunkManager& chunkManager, std::mutex& chunkInteractionMutex)
+void Player::spawn(const ChunkManager& chunkManager, InstrumentedMutex& chunkInteractionMutex)
 {
 	bool spawned = false;
 	while (!spawned)
 	{
 		std::this_thread::sleep_for(std::chrono::milliseconds(MS_BETWEEN_ATTEMPT_SPAWN));
 
-		std::lock_guard<std::mutex> playerLock(chunkInteractionMutex);
+		InstrumentedLock playerLock(chunkInteractionMutex, LOCK_SITE("Player::spawn"));
 		if (chunkManager.isChunkAtPosition(Globals::PLAYER_STARTING_POSITION))
 		{
 			glm::vec3 highestCubePosition = { 0.0f, 0.0f, 0.0f };
@@ -368,13 +261,14 @@ void Player::handleAutoJump(const ChunkManager& chunkManager)
 		m_position.y,
 		m_position.z + glm::normalize(glm::vec2(m_velocity.x, m_velocity.z)).y);
 
+	VoxelAccessor voxelAccessor(chunkManager);
 	bool autoJumpAllowed = false;
-	if (CollisionHandler::isCollision({ collisionPosition.x, collisionPosition.y - HEAD_HEIGHT + (HEAD_HEIGHT / 2.0f), collisionPosition.z }, chunkManager))
+	if (CollisionHandler::isCollision({ collisionPosition.x, collisionPosition.y - HEAD_HEIGHT + (HEAD_HEIGHT / 2.0f), collisionPosition.z }, voxelAccessor))
 	{
 		autoJumpAllowed = true;
 		for (int y = -static_cast<int>(HEAD_HEIGHT) + 1; y <= 1; y++)
 		{
-			if (CollisionHandler::isCollision({ collisionPosition.x, collisionPosition.y + y, collisionPosition.z }, chunkManager))
+			if (CollisionHandler::isCollision({ collisionPosition.x, collisionPosition.y + y, collisionPosition.z }, voxelAccessor))
 			{
 				autoJumpAllowed = false;
 				break;
@@ -390,23 +284,13 @@ void Player::handleAutoJump(const ChunkManager& chunkManager)
 	}
 }
 
-void Player::handleSelectedCube(const ChunkManager& chunkManager)
+void Player::handleSelectedCube(const VoxelRaycastHit* facingCube)
 {
-	bool selectedCubeFound = false;
-	eCubeType selectedCubeType;
-	for (int i = 0; i <= std::ceil(DESTROY_BLOCK_MAX_DISTANCE / DESTROY_BLOCK_INCREMENT); ++i)
+	if (facingCube)
 	{
-		glm::vec3 rayPosition = m_camera.front * (static_cast<float>(i) * DESTROY_BLOCK_INCREMENT) + m_position;
-		if (chunkManager.isCubeAtPosition({ std::floor(rayPosition.x), std::floor(rayPosition.y), std::floor(rayPosition.z) }, selectedCubeType) &&
-			!NON_SELECTABLE_CUBE_TYPES.isMatch(selectedCubeType))
-		{
-			m_selectedBlockVisual.setPosition({ std::floor(rayPosition.x), std::floor(rayPosition.y), std::floor(rayPosition.z) });
-			selectedCubeFound = true;
-			break;
-		}
+		m_selectedBlockVisual.setPosition(facingCube->position);
 	}
-
-	if (!selectedCubeFound)
+	else
 	{
 		m_selectedBlockVisual.setActive(false);
 	}
@@ -414,11 +298,10 @@ void Player::handleSelectedCube(const ChunkManager& chunkManager)
 
 void Player::onAddToInventory(const GameMessages::AddToInventory& gameMessage)
 {
-	m_inventory.add(gameMessage.type);
+	m_inventory.add(gameMessage.type, gameMessage.quantity);
 }
 
-void Player::handleInputEvents(const sf::Event& currentSFMLEvent,
-	ChunkManager& chunkManager, std::mutex& chunkInteractionMutex, const sf::Window& window)
+void Player::handleInputEvents(const sf::Event& currentSFMLEvent)
 {
 	switch (currentSFMLEvent.type)
 	{
@@ -434,9 +317,6 @@ void Player::handleInputEvents(const sf::Event& currentSFMLEvent,
 
 		m_inventory.handleInputEvents(currentSFMLEvent);
 		break;
-	case sf::Event::MouseMoved:
-		handleSelectedCube(chunkManager);
-		break;
 	case sf::Event::MouseWheelMoved:
 		m_inventory.handleInputEvents(currentSFMLEvent);
 		break;
@@ -448,28 +328,37 @@ void Player::handleInputEvents(const sf::Event& currentSFMLEvent,
 	}
 }
 
-void Player::update(float deltaTime, std::mutex& chunkInteractionMutex, ChunkManager& chunkManager, const sf::Window& window)
+void Player::update(float deltaTime, InstrumentedMutex& chunkInteractionMutex, ChunkManager& chunkManager, const sf::Window& window)
 {
+	PROFILE_SCOPE("Player::update");
 	m_destroyBlockVisual.update(deltaTime);
 	m_camera.update(window, deltaTime);
 	m_placeCubeTimer.update(deltaTime);
 	m_destroyCubeTimer.update(deltaTime);
 
-	std::unique_lock<std::mutex> chunkInteractionLock(chunkInteractionMutex);
+	InstrumentedLock chunkInteractionLock(chunkInteractionMutex, LOCK_SITE("Player::update"));
+	//One ray a frame for the selected, destroyed and placed cube
+	VoxelRaycastHit facingCube;
+	bool facingCubeFound = chunkManager.raycast(m_position, m_camera.front, REACH_DISTANCE,
+		[](eCubeType cubeType) { return getCubeTypeProperties(cubeType).selectable; }, facingCube);
+
 	if (sf::Mouse::isButtonPressed(sf::Mouse::Button::Left))
 	{
-		destroyFacingBlock(chunkManager);
+		destroyFacingBlock(chunkManager, facingCubeFound ? &facingCube : nullptr);
 	}
 	else if (sf::Mouse::isButtonPressed(sf::Mouse::Button::Right) && m_placeCubeTimer.isExpired())
 	{
-		placeBlock(chunkManager);
+		placeBlock(chunkManager, facingCube);
 		m_placeCubeTimer.resetElaspedTime();
 	}
 
+	handleSelectedCube(facingCubeFound ? &facingCube : nullptr);
+
+	VoxelAccessor voxelAccessor(chunkManager);
 	for (int y = -static_cast<int>(HEAD_HEIGHT); y <= 0; y++)
 	{
 		if (CollisionHandler::isCollision({ std::floor(m_position.x), std::floor(m_position.y + y), std::floor(m_position.z) },
-			chunkManager, eCubeType::Water))
+			voxelAccessor, eCubeType::Water))
 		{
 			m_currentState = ePlayerState::InWater;
 			break;
@@ -477,11 +366,9 @@ void Player::update(float deltaTime, std::mutex& chunkInteractionMutex, ChunkMan
 	}
 
 	move(chunkManager);
-	handleCollisions(chunkManager);
+	handleCollisions(chunkManager, deltaTime);
 	chunkInteractionLock.unlock();
 
-	m_position += m_velocity * deltaTime;
-	
 	switch (m_currentState)
 	{
 	case ePlayerState::Flying:
@@ -617,127 +504,37 @@ void Player::move(const ChunkManager& chunkManager)
 }
 
 //https://sites.google.com/site/letsmakeavoxelengine/home/collision-detection
-void Player::handleCollisions(const ChunkManager& chunkManager)
+void Player::handleCollisions(const ChunkManager& chunkManager, float deltaTime)
 {
-	eCubeType cubeType = eCubeType::Air;
+	if (m_currentState == ePlayerState::OnGround)
+	{
+		handleAutoJump(chunkManager);
+	}
+
+	bool falling = m_velocity.y < 0.0f;
+	glm::bvec3 blockedAxes = CollisionHandler::move(m_position, m_velocity, deltaTime, 
+		COLLISION_BOX_MINIMUM, COLLISION_BOX_MAXIMUM, chunkManager);
+
 	switch (m_currentState)
 	{
 	case ePlayerState::Flying:
 	case ePlayerState::InAir:
-		if (m_velocity.y > 0.0f && CollisionHandler::isCollision({ m_position.x, m_position.y + COLLISION_OFFSET, m_position.z }, chunkManager))
+		if (blockedAxes.y && falling)
 		{
-			m_velocity.y = 0.0f;
-			m_position.y -= std::abs(m_position.y - HEAD_HEIGHT - (std::floor(m_position.y - HEAD_HEIGHT)));
+			m_currentState = ePlayerState::OnGround;
 		}
-		else if(m_velocity.y < 0.0f && CollisionHandler::isCollision({ m_position.x, m_position.y - HEAD_HEIGHT, m_position.z }, chunkManager))
-		{
-			m_velocity.y = 0.0f;
-			m_position.y += std::abs(m_position.y - HEAD_HEIGHT - (std::floor(m_position.y - HEAD_HEIGHT) + 1));
-			m_position.y = std::floor(m_position.y);
-
-			m_currentState = ePlayerState::OnGround;	
-		}
-
-		if (m_velocity.x != 0.0f)
-		{
-			for (int y = -static_cast<int>(HEAD_HEIGHT); y <= 0; y++)
-			{
-				if (CollisionHandler::handleXAxisCollision(m_velocity.x, COLLISION_OFFSET, chunkManager, 
-					{ m_position.x, m_position.y + y, m_position.z }))
-				{
-					break;
-				}
-			}
-		}
-
-		if (m_velocity.z != 0.0f)
-		{
-			for (int y = -static_cast<int>(HEAD_HEIGHT); y <= 0; y++)
-			{
-				if (CollisionHandler::handleZAxisCollision(m_velocity.z, COLLISION_OFFSET, chunkManager,
-					{ m_position.x, m_position.y + y, m_position.z }))
-				{
-					break;
-				}
-			}
-		}
-
 		break;
 	case ePlayerState::OnGround:
-		handleAutoJump(chunkManager);
-
-		if (m_velocity.x != 0.0f)
-		{
-			for (int y = -static_cast<int>(HEAD_HEIGHT); y <= 0; y++)
-			{
-				if(CollisionHandler::handleXAxisCollision(m_velocity.x, COLLISION_OFFSET, chunkManager, 
-					{ m_position.x, m_position.y + y, m_position.z }))
-				{
-					break;
-				}
-			}
-		}
-
-		if (m_velocity.z != 0.0f)
+		if (!CollisionHandler::isOnGround(m_position, COLLISION_BOX_MINIMUM, COLLISION_BOX_MAXIMUM, chunkManager))
 		{
-			for (int y = -static_cast<int>(HEAD_HEIGHT); y <= 0; y++)
-			{
-				if (CollisionHandler::handleZAxisCollision(m_velocity.z, COLLISION_OFFSET, chunkManager, 
-					{ m_position.x, m_position.y + y, m_position.z }))
-				{
-					break;
-				}
-			}
-		}
-		
-		if (!CollisionHandler::isCollision({ m_position.x, m_position.y - HEAD_HEIGHT, m_position.z }, chunkManager))
-		{
-			m_currentState = (m_currentState == ePlayerState::Flying ? m_currentState : ePlayerState::InAir);
+			m_currentState = ePlayerState::InAir;
 		}
-
 		break;
 	case ePlayerState::InWater:
-		if (m_velocity.y > 0.0f && CollisionHandler::isCollision({ m_position.x, m_position.y + COLLISION_OFFSET, m_position.z }, chunkManager))
-		{
-			m_velocity.y = 0.0f;
-			m_position.y -= std::abs(m_position.y - HEAD_HEIGHT - (std::floor(m_position.y - HEAD_HEIGHT)));
-		}
-		else if (m_velocity.y < 0 && (CollisionHandler::isCollision({ m_position.x, m_position.y - HEAD_HEIGHT, m_position.z }, chunkManager)))
-		{
-			m_velocity.y = 0.0f;
-			m_position.y += std::abs(m_position.y - HEAD_HEIGHT - (std::floor(m_position.y - HEAD_HEIGHT) + 1));
-			//m_position.y = std::floor(m_position.y);
-		}
-
-		if (m_velocity.x != 0.0f)
-		{
-			for (int y = -static_cast<int>(HEAD_HEIGHT); y <= 0; y++)
-			{
-				if (CollisionHandler::handleXAxisCollision(m_velocity.x, COLLISION_OFFSET, chunkManager,
-					{ m_position.x, m_position.y + y, m_position.z }))
-				{
-					break;
-				}
-			}
-		}
-
-		if (m_velocity.z != 0.0f)
-		{
-			for (int y = -static_cast<int>(HEAD_HEIGHT); y <= 0; y++)
-			{
-				if (CollisionHandler::handleZAxisCollision(m_velocity.z, COLLISION_OFFSET, chunkManager,
-					{ m_position.x, m_position.y + y, m_position.z }))
-				{
-					break;
-				}
-			}
-		}
-
 		if (!CollisionHandler::isCollision({ m_position.x, m_position.y - (HEAD_HEIGHT + 1.5f), m_position.z }, chunkManager))
 		{
 			m_currentState = ePlayerState::InAir;
 		}
-
 		break;
 	default:
 		assert(false);
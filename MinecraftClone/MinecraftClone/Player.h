@@ -11,7 +11,7 @@
 #include "Timer.h"
 #include "DestroyBlockVisual.h"
 #include "SelectedVoxelVisual.h"
-#include <mutex>
+#include "InstrumentedMutex.h"
 #include <SFML/Graphics.hpp>
 #include <vector>
 
@@ -42,6 +42,7 @@ enum class ePlayerState
 };
 
 class ChunkManager;
+struct VoxelRaycastHit;
 namespace GameMessages
 {
 	struct AddToInventory;
@@ -53,16 +54,15 @@ public:
 	~Player();
 
 	const Timer& getDestroyCubeTimer() const;
-	bool isUnderWater(const ChunkManager& chunkManager, std::mutex& chunkInteractionMutex) const;
+	bool isUnderWater(const ChunkManager& chunkManager, InstrumentedMutex& chunkInteractionMutex) const;
 	const glm::vec3 getMiddlePosition() const;
 	const glm::vec3& getPosition() const;
 	const Camera& getCamera() const;
 	const Inventory& getInventory() const;
 
-	void spawn(const ChunkManager& chunkManager, std::mutex& chunkInteractionMutex);
-	void handleInputEvents(const sf::Event& currentSFMLEvent,
-		ChunkManager& chunkManager, std::mutex& chunkInteractionMutex, const sf::Window& window);
-	void update(float deltaTime, std::mutex& chunkInteractionMutex, ChunkManager& chunkManager, const sf::Window& window);
+	void spawn(const ChunkManager& chunkManager, InstrumentedMutex& chunkInteractionMutex);
+	void handleInputEvents(const sf::Event& currentSFMLEvent);
+	void update(float deltaTime, InstrumentedMutex& chunkInteractionMutex, ChunkManager& chunkManager, const sf::Window& window);
 	void renderDestroyBlock();
 	void renderSelectedVoxel();
 
@@ -82,12 +82,12 @@ private:
 	Timer m_destroyCubeTimer;
 
 	void move(const ChunkManager& chunkManager);
-	void handleCollisions(const ChunkManager& chunkManager);
+	void handleCollisions(const ChunkManager& chunkManager, float deltaTime);
 	void discardItem();
-	void placeBlock(ChunkManager& chunkManager);
-	void destroyFacingBlock(ChunkManager& chunkManager);
+	void placeBlock(ChunkManager& chunkManager, const VoxelRaycastHit& facingCube);
+	void destroyFacingBlock(ChunkManager& chunkManager, const VoxelRaycastHit* facingCube);
 	void handleAutoJump(const ChunkManager& chunkManager);
-	void handleSelectedCube(const ChunkManager& chunkManager);
+	void handleSelectedCube(const VoxelRaycastHit* facingCube);
 
 	void onAddToInventory(const GameMessages::AddToInventory& gameMessage);
 };
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <assert.h>
+
+using Profiler::ProfileTrack;
+
+namespace
+{
+	constexpr size_t EVENTS_PER_TRACK = 1 << 17;
+
+	struct ProfileEvent
+	{
+		const char* name;
+		int64_t startTime;
+		int64_t endTime;
+	};
+
+	//Relaxed atomics so the export can read a slot while the owning thread overwrites it
+	struct RecordedProfileEvent
+	{
+		std::atomic<const char*> name;
+		std::atomic<int64_t> startTime;
+		std::atomic<int64_t> endTime;
+	};
+}
+
+//Only one thread writes to a track - exporting copies the ring and throws away whatever was overwritten during the copy
+//Tracks outlive their threads so a finished thread still shows up in the trace
+//A new thread takes over a track left behind by a finished one - the chunk generation thread is restarted on every reset
+struct Profiler::ProfileTrack : private NonCopyable, private NonMovable
+{
+	ProfileTrack(int trackID);
+
+	std::atomic<const char*> name;
+	const int trackID;
+	bool inUse;
+	std::atomic<size_t> eventCount;
+	std::array<RecordedProfileEvent, EVENTS_PER_TRACK> events;
+};
+
+Profiler::ProfileTrack::ProfileTrack(int trackID)
+	: name(nullptr),
+	trackID(trackID),
+	inUse(true),
+	eventCount(0),
+	events()
+{
+	for (RecordedProfileEvent& event : events)
+	{
+		event.name.store(nullptr, std::memory_order_relaxed);
+		event.startTime.store(0, std::memory_order_relaxed);
+		event.endTime.store(0, std::memory_order_relaxed);
+	}
+}
+
+namespace
+{
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	std::mutex profileTracksMutex;
+	std::vector<std::unique_ptr<ProfileTrack>> profileTracks;
+
+	ProfileTrack* acquireProfileTrack()
+	{
+		std::lock_guard<std::mutex> profileTracksLock(profileTracksMutex);
+		auto profileTrack = std::find_if(profileTracks.begin(), profileTracks.end(), [](const auto& profileTrack)
+		{
+			return !profileTrack->inUse;
+		});
+		if (profileTrack != profileTracks.end())
+		{
+			(*profileTrack)->inUse = true;
+			(*profileTrack)->name.store(nullptr, std::memory_order_relaxed);
+			return profileTrack->get();
+		}
+
+		//Heap allocated as the ring is too big for some thread_local storage
+		profileTracks.emplace_back(std::make_unique<ProfileTrack>(static_cast<int>(profileTracks.size())));
+		return profileTracks.back().get();
+	}
+
+	struct ThreadTrackHandle : private NonCopyable, private NonMovable
+	{
+		ThreadTrackHandle()
+			: profileTrack(acquireProfileTrack())
+		{}
+
+		~ThreadTrackHandle()
+		{
+			std::lock_guard<std::mutex> profileTracksLock(profileTracksMutex);
+			assert(profileTrack->inUse);
+			profileTrack->inUse = false;
+		}
+
+		ProfileTrack* const profileTrack;
+	};
+
+	ProfileTrack& getThreadTrack()
+	{
+		thread_local ThreadTrackHandle profileTrackHandle;
+		return *profileTrackHandle.profileTrack;
+	}
+
+	void writeEscaped(std::ofstream& file, const char* text)
+	{
+		for (; *text; ++text)
+		{
+			if (*text == '"' || *text == '\\')
+			{
+				file << '\\';
+			}
+			file << *text;
+		}
+	}
+}
+
+int64_t Profiler::getTime()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Profiler::setThreadName(const char* name)
+{
+	getThreadTrack().name.store(name, std::memory_order_relaxed);
+}
+
+ProfileTrack& Profiler::createTrack(const char* name)
+{
+	//Never released so no thread ever takes it over
+	ProfileTrack& profileTrack = *acquireProfileTrack();
+	profileTrack.name.store(name, std::memory_order_relaxed);
+	return profileTrack;
+}
+
+void Profiler::recordScope(const char* name, int64_t startTime, int64_t endTime)
+{
+	recordScope(getThreadTrack(), name, startTime, endTime);
+}
+
+void Profiler::recordScope(ProfileTrack& profileTrack, const char* name, int64_t startTime, int64_t endTime)
+{
+	size_t eventCount = profileTrack.eventCount.load(std::memory_order_relaxed);
+	RecordedProfileEvent& event = profileTrack.events[eventCount & (EVENTS_PER_TRACK - 1)];
+	event.name.store(name, std::memory_order_relaxed);
+	event.startTime.store(startTime, std::memory_order_relaxed);
+	event.endTime.store(endTime, std::memory_order_relaxed);
+	profileTrack.eventCount.store(eventCount + 1, std::memory_order_release);
+}
+
+size_t Profiler::exportChromeTrace(const std::string& filePath)
+{
+	std::ofstream file(filePath);
+	if (!file.is_open())
+	{
+		return 0;
+	}
+
+	std::vector<ProfileEvent> events;
+	size_t exportedEventCount = 0;
+	file << "{\"traceEvents\":[";
+	std::lock_guard<std::mutex> profileTracksLock(profileTracksMutex);
+	for (const auto& profileTrack : profileTracks)
+	{
+		size_t lastEventCount = profileTrack->eventCount.load(std::memory_order_acquire);
+		size_t firstEventCount = lastEventCount > EVENTS_PER_TRACK ? lastEventCount - EVENTS_PER_TRACK : 0;
+		events.clear();
+		for (size_t i = firstEventCount; i < lastEventCount; ++i)
+		{
+			const RecordedProfileEvent& event = profileTrack->events[i & (EVENTS_PER_TRACK - 1)];
+			events.push_back({ event.name.load(std::memory_order_relaxed), event.startTime.load(std::memory_order_relaxed),
+				event.endTime.load(std::memory_order_relaxed) });
+		}
+
+		//The owning thread kept recording while the events were copied - drop the ones it may have overwritten, including by the event it is writing now
+		std::atomic_thread_fence(std::memory_order_acquire);
+		size_t writingEventCount = profileTrack->eventCount.load(std::memory_order_relaxed) + 1;
+		size_t firstIntactEventCount = writingEventCount > EVENTS_PER_TRACK ? writingEventCount - EVENTS_PER_TRACK : 0;
+		size_t skippedEventCount = std::min(firstIntactEventCount > firstEventCount ? firstIntactEventCount - firstEventCount : 0, events.size());
+
+		if (exportedEventCount > 0)
+		{
+			file << ",";
+		}
+		file << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << profileTrack->trackID << ",\"args\":{\"name\":\"";
+		const char* threadName = profileTrack->name.load(std::memory_order_relaxed);
+		if (threadName)
+		{
+			writeEscaped(file, threadName);
+		}
+		else
+		{
+			file << "Thread " << profileTrack->trackID;
+		}
+		file << "\"}}";
+		++exportedEventCount;
+
+		for (size_t i = skippedEventCount; i < events.size(); ++i)
+		{
+			file << ",\n{\"name\":\"";
+			writeEscaped(file, events[i].name);
+			file << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << profileTrack->trackID << ",\"ts\":" << events[i].startTime <<
+				",\"dur\":" << events[i].endTime - events[i].startTime << "}";
+			++exportedEventCount;
+		}
+	}
+
+	file << "\n]}\n";
+	return exportedEventCount;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "NonCopyable.h"
+#include "NonMovable.h"
+#include <cstdint>
+#include <string>
+
+//Set to 0 to compile every profile scope away
+#ifndef PROFILING_ENABLED
+#define PROFILING_ENABLED 1
+#endif
+
+//Each thread records the scopes it leaves into its own ring of the most recent events - recording never locks
+//Scopes nest by time, so the exported trace shows them as a hierarchy per thread
+namespace Profiler
+{
+	struct ProfileTrack;
+
+	//Microseconds since the profiler started
+	int64_t getTime();
+	//Names have to outlive the profiler - string literals
+	void setThreadName(const char* name);
+	void recordScope(const char* name, int64_t startTime, int64_t endTime);
+	//A timeline of its own for work that isn't done by the recording thread - like the GPU
+	//Only one thread may record to a track
+	ProfileTrack& createTrack(const char* name);
+	void recordScope(ProfileTrack& profileTrack, const char* name, int64_t startTime, int64_t endTime);
+	//Chrome trace_event JSON - open in chrome://tracing or Perfetto
+	//Returns the number of events written
+	size_t exportChromeTrace(const std::string& filePath);
+
+	class ScopedProfile : private NonCopyable, private NonMovable
+	{
+	public:
+		ScopedProfile(const char* name)
+			: m_name(name),
+			m_startTime(getTime())
+		{}
+
+		~ScopedProfile()
+		{
+			recordScope(m_name, m_startTime, getTime());
+		}
+
+	private:
+		const char* m_name;
+		int64_t m_startTime;
+	};
+}
+
+#if PROFILING_ENABLED
+#define PROFILE_CONCATENATE_INNER(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_INNER(a, b)
+#define PROFILE_SCOPE(name) Profiler::ScopedProfile PROFILE_CONCATENATE(profileScope, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_THREAD_NAME(name)
+#endif
\ No newline at end of file
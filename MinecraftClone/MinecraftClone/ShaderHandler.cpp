@@ -135,6 +135,9 @@ std::unique_ptr<ShaderHandler> ShaderHandler::create(const glm::ivec2& windowSiz
 		case eShaderType::PostProcessing:
 			shaderLoaded = createShaderProgram(shader.getID(), "PostProcessingVertexShader.glsl", "PostProcessingFragmentShader.glsl");
 			break;
+		case eShaderType::FarTerrain:
+			shaderLoaded = createShaderProgram(shader.getID(), "FarTerrainVertexShader.glsl", "FarTerrainFragmentShader.glsl");
+			break;
 		default:
 			assert(false);
 		}
@@ -180,6 +183,14 @@ void ShaderHandler::setUniform1f(eShaderType shaderType, const std::string& unif
 	glUniform1f(uniformLocation, value);
 }
 
+void ShaderHandler::setUniform4f(eShaderType shaderType, const std::string& uniformName, const glm::vec4& value)
+{
+	assert(shaderType == m_currentShaderType);
+	int uniformLocation = m_shader[static_cast<int>(shaderType)].getUniformLocation(uniformName);
+	assert(uniformLocation != INVALID_UNIFORM_LOCATION);
+	glUniform4f(uniformLocation, value.x, value.y, value.z, value.w);
+}
+
 void ShaderHandler::switchToShader(eShaderType shaderType)
 {
 	assert(shaderType != m_currentShaderType);
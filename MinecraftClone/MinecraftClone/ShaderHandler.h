@@ -20,7 +20,8 @@ enum class eShaderType
 	UIToolbar,
 	UIFont,
 	PostProcessing,
-	Max = PostProcessing
+	FarTerrain,
+	Max = FarTerrain
 };
 
 class ShaderHandler : private NonCopyable, private NonMovable
@@ -49,6 +50,7 @@ public:
 	void setUniformMat4f(eShaderType shaderType, const std::string& uniformName, const glm::mat4& matrix);
 	void setUniform1i(eShaderType shaderType, const std::string& uniformName, int value);
 	void setUniform1f(eShaderType shaderType, const std::string& uniformName, float value);
+	void setUniform4f(eShaderType shaderType, const std::string& uniformName, const glm::vec4& value);
 	void switchToShader(eShaderType shaderType);
 
 private:
@@ -65,6 +67,7 @@ private:
 		eShaderType::UIItem,
 		eShaderType::UIToolbar,
 		eShaderType::UIFont,
-		eShaderType::PostProcessing
+		eShaderType::PostProcessing,
+		eShaderType::FarTerrain
 	};
 };
\ No newline at end of file
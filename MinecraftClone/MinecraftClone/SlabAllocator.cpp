@@ -0,0 +1,71 @@
+#include "SlabAllocator.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+size_t SlabMemory::getPageSize()
+{
+#ifdef _WIN32
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	return systemInfo.dwAllocationGranularity;
+#else
+	return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+void* SlabMemory::reserve(size_t bytes)
+{
+#ifdef _WIN32
+	void* memory = VirtualAlloc(nullptr, bytes, MEM_RESERVE, PAGE_NOACCESS);
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+#else
+	void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+	{
+		throw std::bad_alloc();
+	}
+#endif
+
+	return memory;
+}
+
+void SlabMemory::commit(void* memory, size_t bytes)
+{
+#ifdef _WIN32
+	if (!VirtualAlloc(memory, bytes, MEM_COMMIT, PAGE_READWRITE))
+	{
+		throw std::bad_alloc();
+	}
+#else
+	//Pages released with madvise are faulted back in as zeroes on first touch
+	(void)memory;
+	(void)bytes;
+#endif
+}
+
+void SlabMemory::decommit(void* memory, size_t bytes)
+{
+#ifdef _WIN32
+	VirtualFree(memory, bytes, MEM_DECOMMIT);
+#else
+	madvise(memory, bytes, MADV_DONTNEED);
+#endif
+}
+
+void SlabMemory::release(void* memory, size_t bytes)
+{
+#ifdef _WIN32
+	VirtualFree(memory, 0, MEM_RELEASE);
+#else
+	munmap(memory, bytes);
+#endif
+}
\ No newline at end of file
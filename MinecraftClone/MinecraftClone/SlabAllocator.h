@@ -0,0 +1,146 @@
+#pragma once
+
+#include "ObjectPool.h"
+#include "MemoryAccounting.h"
+#include "NonCopyable.h"
+#include "NonMovable.h"
+#include <bitset>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <assert.h>
+
+//Page level memory straight from the OS so released slabs are handed back rather than kept by the heap
+namespace SlabMemory
+{
+	size_t getPageSize();
+	void* reserve(size_t bytes);
+	void commit(void* memory, size_t bytes);
+	void decommit(void* memory, size_t bytes);
+	void release(void* memory, size_t bytes);
+}
+
+//Objects are placed in slabs of OBJECTS_PER_SLAB - a slab's pages go back to the OS once its last object is destroyed
+template <class Object, size_t OBJECTS_PER_SLAB>
+class SlabAllocator : public ObjectAllocator<Object>, private NonCopyable, private NonMovable
+{
+public:
+	SlabAllocator(eMemoryCategory memoryCategory)
+		: m_memoryCategory(memoryCategory),
+		m_slabSize(getSlabSize()),
+		m_mutex(),
+		m_slabs(),
+		m_slabIndices()
+	{}
+	~SlabAllocator()
+	{
+		for (auto& slab : m_slabs)
+		{
+			assert(slab.usedSlots.none());
+			if (slab.committed)
+			{
+				MemoryAccounting::onRelease(m_memoryCategory, m_slabSize);
+			}
+			SlabMemory::release(slab.memory, m_slabSize);
+		}
+	}
+
+	Object* allocate() override
+	{
+		char* memory = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			Slab& slab = getSlabWithFreeSlot();
+			for (size_t i = 0; i < OBJECTS_PER_SLAB; ++i)
+			{
+				if (!slab.usedSlots.test(i))
+				{
+					slab.usedSlots.set(i);
+					memory = slab.memory + i * sizeof(Object);
+					break;
+				}
+			}
+		}
+
+		assert(memory);
+		return new (memory) Object();
+	}
+
+	void deallocate(Object* object) override
+	{
+		object->~Object();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		char* memory = reinterpret_cast<char*>(object);
+		//The slab starting closest below the object is the one it's in
+		auto slabIndex = m_slabIndices.upper_bound(memory);
+		assert(slabIndex != m_slabIndices.begin());
+		Slab& slab = m_slabs[std::prev(slabIndex)->second];
+		assert(memory >= slab.memory && memory < slab.memory + OBJECTS_PER_SLAB * sizeof(Object));
+
+		size_t slot = static_cast<size_t>(memory - slab.memory) / sizeof(Object);
+		assert(slab.usedSlots.test(slot));
+		slab.usedSlots.reset(slot);
+
+		if (slab.usedSlots.none())
+		{
+			SlabMemory::decommit(slab.memory, m_slabSize);
+			slab.committed = false;
+			MemoryAccounting::onRelease(m_memoryCategory, m_slabSize);
+		}
+	}
+
+private:
+	struct Slab
+	{
+		char* memory = nullptr;
+		bool committed = false;
+		std::bitset<OBJECTS_PER_SLAB> usedSlots;
+	};
+
+	const eMemoryCategory m_memoryCategory;
+	const size_t m_slabSize;
+	std::mutex m_mutex;
+	std::vector<Slab> m_slabs;
+	//Slabs by their first byte
+	std::map<const char*, size_t> m_slabIndices;
+
+	static size_t getSlabSize()
+	{
+		size_t pageSize = SlabMemory::getPageSize();
+		return (OBJECTS_PER_SLAB * sizeof(Object) + pageSize - 1) / pageSize * pageSize;
+	}
+
+	//Partly used slabs are filled first so empty slabs stay released
+	Slab& getSlabWithFreeSlot()
+	{
+		Slab* releasedSlab = nullptr;
+		for (auto& slab : m_slabs)
+		{
+			if (slab.committed && !slab.usedSlots.all())
+			{
+				return slab;
+			}
+			else if (!slab.committed && !releasedSlab)
+			{
+				releasedSlab = &slab;
+			}
+		}
+
+		if (!releasedSlab)
+		{
+			m_slabs.emplace_back();
+			releasedSlab = &m_slabs.back();
+			releasedSlab->memory = static_cast<char*>(SlabMemory::reserve(m_slabSize));
+			m_slabIndices.emplace(releasedSlab->memory, m_slabs.size() - 1);
+		}
+
+		SlabMemory::commit(releasedSlab->memory, m_slabSize);
+		releasedSlab->committed = true;
+		MemoryAccounting::onAllocate(m_memoryCategory, m_slabSize);
+
+		return *releasedSlab;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,643 @@
+#include "TerrainNoise.h"
+#include "Chunk.h"
+#include "glm/gtc/noise.hpp"
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	constexpr int LATTICE_SPACING = 4;
+	constexpr int REGION_SIZE = Globals::CHUNK_WIDTH * 8;
+	constexpr int REGION_LATTICE_SIZE = REGION_SIZE / LATTICE_SPACING + 1;
+	constexpr int MAX_CACHED_REGIONS = 16;
+	constexpr int CHUNK_BENCHMARK_ROUNDS = 5;
+	//The last terrain octave repeats every ~5 blocks - too fine for the lattice so it's sampled per column
+	constexpr int TERRAIN_LATTICE_OCTAVES = Globals::TERRAIN_OCTAVES - 1;
+	//Only the plains/desert threshold matters so every biome octave goes on the lattice
+	constexpr int BIOME_LATTICE_OCTAVES = Globals::BIOME_OCTAVES;
+	constexpr float PLAINS_BIOME_THRESHOLD = 0.4f;
+	constexpr float CAVE_FREQUENCY = 1.0f / 40.0f;
+	constexpr float CAVE_HEIGHT_FREQUENCY = 1.0f / 24.0f;
+	constexpr int MIN_CAVE_SECTION = (Globals::WATER_MAX_HEIGHT + 1) / CaveDensityField::HEIGHT_SPACING;
+	constexpr int CAVE_LATTICE_HEIGHT = CaveDensityField::SECTIONS_HEIGHT + 1;
+
+	static_assert(REGION_SIZE % Globals::CHUNK_WIDTH == 0 && REGION_SIZE % LATTICE_SPACING == 0, "Chunks must tile regions");
+	static_assert(CaveDensityField::SPACING == LATTICE_SPACING, "Cave density columns sit on the region lattice");
+
+	static int SEED = Globals::getRandomNumber(0, Globals::MAP_SIZE);
+	thread_local int noiseCalls = 0;
+
+	template <class Position>
+	float getNoise(const Position& position)
+	{
+		++noiseCalls;
+		return glm::perlin(position);
+	}
+
+	float getElevationNoise(int x, int z, int firstOctave, int lastOctave)
+	{
+		double ex = (x + SEED) / static_cast<float>(Globals::MAP_SIZE);
+		double ey = (z + SEED) / static_cast<float>(Globals::MAP_SIZE);
+
+		float elevation = 0.0f;
+
+		float persistence = Globals::TERRAIN_PERSISTENCE;
+		float lacunarity = Globals::TERRAIN_LACUNARITY;
+		for (int i = 0; i < lastOctave; ++i)
+		{
+			if (i >= firstOctave)
+			{
+				elevation += persistence * getNoise(glm::vec2((ex * 1.5f)* lacunarity, (ey * 1.5f) * lacunarity));
+			}
+
+			persistence /= 2.0f;
+			lacunarity *= 2.0f;
+		}
+
+		return elevation;
+	}
+
+	int getElevation(float elevation)
+	{
+		float persistence = Globals::TERRAIN_PERSISTENCE;
+		float total = 0.0f;
+		for (int i = 0; i < Globals::TERRAIN_OCTAVES; ++i)
+		{
+			total += persistence;
+			persistence /= 2.0f;
+		}
+
+		elevation /= total;
+		elevation = (elevation + 1) / 2;
+		elevation = glm::pow(elevation, 3.0f);
+		elevation = elevation * (float)Globals::CHUNK_HEIGHT - 1;
+
+		return static_cast<int>(elevation);
+	}
+
+	float getBiomeNoise(int x, int z, int firstOctave, int lastOctave)
+	{
+		double bx = x / 1000.0f;
+		double by = z / 1000.0f;
+
+		float biomeType = 0.0f;
+		float moisturePersistence = Globals::BIOME_PERSISTENCE;
+		float moistureLacunarity = Globals::BIOME_LACUNARITY;
+		for (int i = 0; i < lastOctave; ++i)
+		{
+			if (i >= firstOctave)
+			{
+				biomeType += moisturePersistence * getNoise(glm::vec2(bx * moistureLacunarity, by * moistureLacunarity));
+			}
+
+			moisturePersistence /= 2.0f;
+			moistureLacunarity *= 2.0f;
+		}
+
+		return biomeType;
+	}
+
+	eBiomeType getBiomeType(float biomeType)
+	{
+		float persistence = Globals::BIOME_PERSISTENCE;
+		float total = 0.0f;
+		for (int i = 0; i < Globals::BIOME_OCTAVES; ++i)
+		{
+			total += persistence;
+			persistence /= 2.0f;
+		}
+
+		biomeType /= total;
+		biomeType = (biomeType + 1) / 2;
+
+		if (biomeType >= PLAINS_BIOME_THRESHOLD)
+		{
+			return eBiomeType::Plains;
+		}
+		else
+		{
+			return eBiomeType::Desert;
+		}
+	}
+
+	//Ken Perlin's improved noise - a fraction of the cost of glm::perlin's shader port when sampled a point at a time
+	constexpr std::array<int, 256> PERMUTATION =
+	{
+		151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225,
+		140, 36, 103, 30, 69, 142, 8, 99, 37, 240, 21, 10, 23, 190, 6, 148,
+		247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117, 35, 11, 32,
+		57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175,
+		74, 165, 71, 134, 139, 48, 27, 166, 77, 146, 158, 231, 83, 111, 229, 122,
+		60, 211, 133, 230, 220, 105, 92, 41, 55, 46, 245, 40, 244, 102, 143, 54,
+		65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89, 18, 169,
+		200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64,
+		52, 217, 226, 250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212,
+		207, 206, 59, 227, 47, 16, 58, 17, 182, 189, 28, 42, 223, 183, 170, 213,
+		119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43, 172, 9,
+		129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104,
+		218, 246, 97, 228, 251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241,
+		81, 51, 145, 235, 249, 14, 239, 107, 49, 192, 214, 31, 181, 199, 106, 157,
+		184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254, 138, 236, 205, 93,
+		222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180
+	};
+
+	int getPermutation(int i)
+	{
+		return PERMUTATION[i & 255];
+	}
+
+	float getFade(float t)
+	{
+		return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+	}
+
+	float getGradient(int hash, float x, float y, float z)
+	{
+		int h = hash & 15;
+		float u = h < 8 ? x : y;
+		float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+		return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+	}
+
+	float getGradientNoise(const glm::vec3& position)
+	{
+		++noiseCalls;
+		glm::vec3 floor = glm::floor(position);
+		int X = static_cast<int>(floor.x) & 255;
+		int Y = static_cast<int>(floor.y) & 255;
+		int Z = static_cast<int>(floor.z) & 255;
+		float x = position.x - floor.x;
+		float y = position.y - floor.y;
+		float z = position.z - floor.z;
+		float u = getFade(x);
+		float v = getFade(y);
+		float w = getFade(z);
+
+		int A = getPermutation(X) + Y;
+		int AA = getPermutation(A) + Z;
+		int AB = getPermutation(A + 1) + Z;
+		int B = getPermutation(X + 1) + Y;
+		int BA = getPermutation(B) + Z;
+		int BB = getPermutation(B + 1) + Z;
+
+		return glm::mix(
+			glm::mix(glm::mix(getGradient(getPermutation(AA), x, y, z), getGradient(getPermutation(BA), x - 1, y, z), u),
+				glm::mix(getGradient(getPermutation(AB), x, y - 1, z), getGradient(getPermutation(BB), x - 1, y - 1, z), u), v),
+			glm::mix(glm::mix(getGradient(getPermutation(AA + 1), x, y, z - 1), getGradient(getPermutation(BA + 1), x - 1, y, z - 1), u),
+				glm::mix(getGradient(getPermutation(AB + 1), x, y - 1, z - 1), getGradient(getPermutation(BB + 1), x - 1, y - 1, z - 1), u), v), w);
+	}
+
+	float getCaveDensity(int x, int y, int z)
+	{
+		glm::vec3 position((x + SEED) * CAVE_FREQUENCY, y * CAVE_HEIGHT_FREQUENCY, (z + SEED) * CAVE_FREQUENCY);
+		return getGradientNoise(position) + 0.5f * getGradientNoise(position * 2.0f);
+	}
+
+	int roundDownToMultiple(int position, int multiple)
+	{
+		return (position >= 0 ? position / multiple : (position + 1) / multiple - 1) * multiple;
+	}
+
+	//Lattice points are sampled the first time a chunk needs them
+	//Cave density columns are shared the same way and only sampled as high as a chunk has needed them so far
+	struct NoiseRegion
+	{
+		NoiseRegion()
+			: startingPosition(),
+			lastUsed(0),
+			elevationNoise(REGION_LATTICE_SIZE * REGION_LATTICE_SIZE),
+			biomeNoise(REGION_LATTICE_SIZE * REGION_LATTICE_SIZE),
+			caveDensities(REGION_LATTICE_SIZE * REGION_LATTICE_SIZE * CAVE_LATTICE_HEIGHT),
+			caveLatticeHeights(REGION_LATTICE_SIZE * REGION_LATTICE_SIZE)
+		{}
+
+		void reset(const glm::ivec2& regionStartingPosition)
+		{
+			startingPosition = regionStartingPosition;
+			std::fill(elevationNoise.begin(), elevationNoise.end(), std::numeric_limits<float>::quiet_NaN());
+			std::fill(biomeNoise.begin(), biomeNoise.end(), std::numeric_limits<float>::quiet_NaN());
+			std::fill(caveLatticeHeights.begin(), caveLatticeHeights.end(), MIN_CAVE_SECTION);
+		}
+
+		void sample(int latticeX, int latticeZ)
+		{
+			int i = latticeZ * REGION_LATTICE_SIZE + latticeX;
+			if (std::isnan(elevationNoise[i]))
+			{
+				int x = startingPosition.x + latticeX * LATTICE_SPACING;
+				int z = startingPosition.y + latticeZ * LATTICE_SPACING;
+				elevationNoise[i] = getElevationNoise(x, z, 0, TERRAIN_LATTICE_OCTAVES);
+				biomeNoise[i] = getBiomeNoise(x, z, 0, BIOME_LATTICE_OCTAVES);
+			}
+		}
+
+		//Indexed by lattice y
+		const float* sampleCaveColumn(int latticeX, int latticeZ, int maxLatticeY)
+		{
+			assert(maxLatticeY < CAVE_LATTICE_HEIGHT);
+			int i = latticeZ * REGION_LATTICE_SIZE + latticeX;
+			float* caveColumn = &caveDensities[i * CAVE_LATTICE_HEIGHT];
+			for (int latticeY = caveLatticeHeights[i]; latticeY <= maxLatticeY; ++latticeY)
+			{
+				caveColumn[latticeY] = getCaveDensity(startingPosition.x + latticeX * LATTICE_SPACING, latticeY * CaveDensityField::HEIGHT_SPACING,
+					startingPosition.y + latticeZ * LATTICE_SPACING);
+			}
+
+			caveLatticeHeights[i] = std::max(caveLatticeHeights[i], maxLatticeY + 1);
+			return caveColumn;
+		}
+
+		glm::ivec2 startingPosition;
+		unsigned int lastUsed;
+		std::vector<float> elevationNoise;
+		std::vector<float> biomeNoise;
+		std::vector<float> caveDensities;
+		//Lattice points below this in each column have been sampled
+		std::vector<int> caveLatticeHeights;
+	};
+
+	class NoiseRegionCache
+	{
+	public:
+		NoiseRegionCache()
+			: m_regions(),
+			m_usedRegions(0),
+			m_useCount(0)
+		{}
+
+		NoiseRegion& getRegion(const glm::ivec2& position)
+		{
+			glm::ivec2 regionStartingPosition(roundDownToMultiple(position.x, REGION_SIZE), roundDownToMultiple(position.y, REGION_SIZE));
+			NoiseRegion* region = nullptr;
+			for (int i = 0; i < m_usedRegions; ++i)
+			{
+				if (m_regions[i].startingPosition == regionStartingPosition)
+				{
+					region = &m_regions[i];
+					break;
+				}
+			}
+
+			if (!region)
+			{
+				if (m_usedRegions < MAX_CACHED_REGIONS)
+				{
+					region = &m_regions[m_usedRegions++];
+				}
+				else
+				{
+					region = &*std::min_element(m_regions.begin(), m_regions.end(), [](const auto& a, const auto& b)
+					{
+						return a.lastUsed < b.lastUsed;
+					});
+				}
+
+				region->reset(regionStartingPosition);
+			}
+
+			region->lastUsed = ++m_useCount;
+			return *region;
+		}
+
+		//Regions are refilled as they are next needed
+		void clear()
+		{
+			m_usedRegions = 0;
+		}
+
+	private:
+		std::array<NoiseRegion, MAX_CACHED_REGIONS> m_regions;
+		int m_usedRegions;
+		unsigned int m_useCount;
+	};
+
+	float interpolate(const std::vector<float>& lattice, int i, float tx, float tz)
+	{
+		float top = glm::mix(lattice[i], lattice[i + 1], tx);
+		float bottom = glm::mix(lattice[i + REGION_LATTICE_SIZE], lattice[i + REGION_LATTICE_SIZE + 1], tx);
+		return glm::mix(top, bottom, tz);
+	}
+
+	void sampleChunk(NoiseRegionCache& noiseRegionCache, const glm::ivec3& chunkStartingPosition, eNoiseSampling sampling,
+		ChunkElevations& elevations, ChunkBiomeTypes& biomeTypes)
+	{
+		if (sampling == eNoiseSampling::Exact)
+		{
+			for (int z = 0; z < Globals::CHUNK_DEPTH; ++z)
+			{
+				for (int x = 0; x < Globals::CHUNK_WIDTH; ++x)
+				{
+					elevations[z * Globals::CHUNK_WIDTH + x] = TerrainNoise::getElevation(chunkStartingPosition.x + x, chunkStartingPosition.z + z);
+					biomeTypes[z * Globals::CHUNK_WIDTH + x] = TerrainNoise::getBiomeType(chunkStartingPosition.x + x, chunkStartingPosition.z + z);
+				}
+			}
+
+			return;
+		}
+
+		assert(roundDownToMultiple(chunkStartingPosition.x, Globals::CHUNK_WIDTH) == chunkStartingPosition.x &&
+			roundDownToMultiple(chunkStartingPosition.z, Globals::CHUNK_DEPTH) == chunkStartingPosition.z);
+		NoiseRegion& region = noiseRegionCache.getRegion({ chunkStartingPosition.x, chunkStartingPosition.z });
+		glm::ivec2 regionPosition(chunkStartingPosition.x - region.startingPosition.x, chunkStartingPosition.z - region.startingPosition.y);
+		for (int latticeZ = regionPosition.y / LATTICE_SPACING; latticeZ <= (regionPosition.y + Globals::CHUNK_DEPTH) / LATTICE_SPACING; ++latticeZ)
+		{
+			for (int latticeX = regionPosition.x / LATTICE_SPACING; latticeX <= (regionPosition.x + Globals::CHUNK_WIDTH) / LATTICE_SPACING; ++latticeX)
+			{
+				region.sample(latticeX, latticeZ);
+			}
+		}
+
+		for (int z = 0; z < Globals::CHUNK_DEPTH; ++z)
+		{
+			int latticeZ = (regionPosition.y + z) / LATTICE_SPACING;
+			float tz = static_cast<float>((regionPosition.y + z) % LATTICE_SPACING) / LATTICE_SPACING;
+			for (int x = 0; x < Globals::CHUNK_WIDTH; ++x)
+			{
+				int latticeX = (regionPosition.x + x) / LATTICE_SPACING;
+				float tx = static_cast<float>((regionPosition.x + x) % LATTICE_SPACING) / LATTICE_SPACING;
+				int i = latticeZ * REGION_LATTICE_SIZE + latticeX;
+
+				float elevation = interpolate(region.elevationNoise, i, tx, tz) + getElevationNoise(chunkStartingPosition.x + x,
+					chunkStartingPosition.z + z, TERRAIN_LATTICE_OCTAVES, Globals::TERRAIN_OCTAVES);
+				float biomeType = interpolate(region.biomeNoise, i, tx, tz) + getBiomeNoise(chunkStartingPosition.x + x,
+					chunkStartingPosition.z + z, BIOME_LATTICE_OCTAVES, Globals::BIOME_OCTAVES);
+
+				elevations[z * Globals::CHUNK_WIDTH + x] = getElevation(elevation);
+				biomeTypes[z * Globals::CHUNK_WIDTH + x] = getBiomeType(biomeType);
+			}
+		}
+	}
+
+	thread_local NoiseRegionCache noiseRegionCache;
+}
+
+constexpr float CaveDensityField::DENSITY_THRESHOLD;
+
+CaveDensityField::CaveDensityField()
+	: m_densities(),
+	m_highestSurfaces()
+{}
+
+void CaveDensityField::sample(const glm::ivec3& chunkStartingPosition, const ChunkElevations& elevations)
+{
+	for (int sectionZ = 0; sectionZ < SECTIONS_DEPTH; ++sectionZ)
+	{
+		for (int sectionX = 0; sectionX < SECTIONS_WIDTH; ++sectionX)
+		{
+			int highestSurface = -1;
+			for (int z = sectionZ * SPACING; z < (sectionZ + 1) * SPACING; ++z)
+			{
+				for (int x = sectionX * SPACING; x < (sectionX + 1) * SPACING; ++x)
+				{
+					highestSurface = std::max(highestSurface, elevations[z * Globals::CHUNK_WIDTH + x]);
+				}
+			}
+
+			m_highestSurfaces[sectionZ * SECTIONS_WIDTH + sectionX] = highestSurface;
+		}
+	}
+
+	//Each lattice column goes as high as the tallest section it's a corner of
+	//Columns on the chunk's edges are shared with its neighbours through the noise region
+	NoiseRegion& region = noiseRegionCache.getRegion({ chunkStartingPosition.x, chunkStartingPosition.z });
+	glm::ivec2 regionLatticePosition((chunkStartingPosition.x - region.startingPosition.x) / SPACING,
+		(chunkStartingPosition.z - region.startingPosition.y) / SPACING);
+	for (int latticeZ = 0; latticeZ < LATTICE_DEPTH; ++latticeZ)
+	{
+		for (int latticeX = 0; latticeX < LATTICE_WIDTH; ++latticeX)
+		{
+			int highestSurface = -1;
+			for (int sectionZ = std::max(0, latticeZ - 1); sectionZ <= std::min(SECTIONS_DEPTH - 1, latticeZ); ++sectionZ)
+			{
+				for (int sectionX = std::max(0, latticeX - 1); sectionX <= std::min(SECTIONS_WIDTH - 1, latticeX); ++sectionX)
+				{
+					highestSurface = std::max(highestSurface, getHighestSurface(sectionX, sectionZ));
+				}
+			}
+
+			int maxLatticeY = std::min(SECTIONS_HEIGHT - 1, highestSurface / HEIGHT_SPACING) + 1;
+			const float* caveColumn = region.sampleCaveColumn(regionLatticePosition.x + latticeX, regionLatticePosition.y + latticeZ, maxLatticeY);
+			for (int latticeY = MIN_CAVE_SECTION; latticeY <= maxLatticeY; ++latticeY)
+			{
+				m_densities[(latticeY * LATTICE_DEPTH + latticeZ) * LATTICE_WIDTH + latticeX] = caveColumn[latticeY];
+			}
+		}
+	}
+}
+
+int CaveDensityField::getMinSection() const
+{
+	return MIN_CAVE_SECTION;
+}
+
+int CaveDensityField::getHighestSurface(int sectionX, int sectionZ) const
+{
+	assert(sectionX >= 0 && sectionX < SECTIONS_WIDTH && sectionZ >= 0 && sectionZ < SECTIONS_DEPTH);
+	return m_highestSurfaces[sectionZ * SECTIONS_WIDTH + sectionX];
+}
+
+eCaveSection CaveDensityField::getSection(int sectionX, int sectionY, int sectionZ) const
+{
+	assert(sectionY >= MIN_CAVE_SECTION && sectionY * HEIGHT_SPACING <= getHighestSurface(sectionX, sectionZ));
+	float minDensity = std::numeric_limits<float>::max();
+	float maxDensity = std::numeric_limits<float>::lowest();
+	for (int y = sectionY; y <= sectionY + 1; ++y)
+	{
+		for (int z = sectionZ; z <= sectionZ + 1; ++z)
+		{
+			for (int x = sectionX; x <= sectionX + 1; ++x)
+			{
+				minDensity = std::min(minDensity, getDensity(x, y, z));
+				maxDensity = std::max(maxDensity, getDensity(x, y, z));
+			}
+		}
+	}
+
+	if (maxDensity <= DENSITY_THRESHOLD)
+	{
+		return eCaveSection::Solid;
+	}
+	else if (minDensity > DENSITY_THRESHOLD)
+	{
+		return eCaveSection::Carved;
+	}
+	else
+	{
+		return eCaveSection::Mixed;
+	}
+}
+
+void CaveDensityField::interpolateSection(int sectionX, int sectionY, int sectionZ, std::array<float, SECTION_VOLUME>& densities) const
+{
+	assert(sectionY >= MIN_CAVE_SECTION && sectionY * HEIGHT_SPACING <= getHighestSurface(sectionX, sectionZ));
+	//Corners are lerped along z and y first so the innermost loop is a straight run along x
+	for (int y = 0; y < HEIGHT_SPACING; ++y)
+	{
+		float ty = static_cast<float>(y) / HEIGHT_SPACING;
+		for (int z = 0; z < SPACING; ++z)
+		{
+			float tz = static_cast<float>(z) / SPACING;
+			float left = glm::mix(glm::mix(getDensity(sectionX, sectionY, sectionZ), getDensity(sectionX, sectionY, sectionZ + 1), tz),
+				glm::mix(getDensity(sectionX, sectionY + 1, sectionZ), getDensity(sectionX, sectionY + 1, sectionZ + 1), tz), ty);
+			float right = glm::mix(glm::mix(getDensity(sectionX + 1, sectionY, sectionZ), getDensity(sectionX + 1, sectionY, sectionZ + 1), tz),
+				glm::mix(getDensity(sectionX + 1, sectionY + 1, sectionZ), getDensity(sectionX + 1, sectionY + 1, sectionZ + 1), tz), ty);
+
+			float* row = &densities[(y * SPACING + z) * SPACING];
+			for (int x = 0; x < SPACING; ++x)
+			{
+				row[x] = left + (right - left) * (static_cast<float>(x) / SPACING);
+			}
+		}
+	}
+}
+
+float CaveDensityField::getDensity(int latticeX, int latticeY, int latticeZ) const
+{
+	return m_densities[(latticeY * LATTICE_DEPTH + latticeZ) * LATTICE_WIDTH + latticeX];
+}
+
+int TerrainNoise::getElevation(int x, int z)
+{
+	return ::getElevation(getElevationNoise(x, z, 0, Globals::TERRAIN_OCTAVES));
+}
+
+uint32_t TerrainNoise::getStructureSeed(const glm::ivec3& chunkStartingPosition)
+{
+	uint32_t seed = static_cast<uint32_t>(SEED);
+	seed = (seed ^ static_cast<uint32_t>(chunkStartingPosition.x)) * 0x9E3779B1u;
+	seed = (seed ^ (seed >> 15) ^ static_cast<uint32_t>(chunkStartingPosition.z)) * 0x85EBCA77u;
+	seed ^= seed >> 13;
+
+	return seed;
+}
+
+eBiomeType TerrainNoise::getBiomeType(int x, int z)
+{
+	return ::getBiomeType(getBiomeNoise(x, z, 0, Globals::BIOME_OCTAVES));
+}
+
+void TerrainNoise::sampleChunk(const glm::ivec3& chunkStartingPosition, eNoiseSampling sampling,
+	ChunkElevations& elevations, ChunkBiomeTypes& biomeTypes)
+{
+	::sampleChunk(noiseRegionCache, chunkStartingPosition, sampling, elevations, biomeTypes);
+}
+
+TerrainNoiseBenchmark TerrainNoise::runBenchmark(const glm::ivec3& position, int chunkRadius)
+{
+	glm::ivec3 centreChunkStartingPosition(roundDownToMultiple(position.x, Globals::CHUNK_WIDTH), 0,
+		roundDownToMultiple(position.z, Globals::CHUNK_DEPTH));
+
+	std::vector<glm::ivec3> chunkStartingPositions;
+	for (int z = -chunkRadius; z <= chunkRadius; ++z)
+	{
+		for (int x = -chunkRadius; x <= chunkRadius; ++x)
+		{
+			chunkStartingPositions.emplace_back(centreChunkStartingPosition.x + x * Globals::CHUNK_WIDTH, 0,
+				centreChunkStartingPosition.z + z * Globals::CHUNK_DEPTH);
+		}
+	}
+
+	//Own cache so the regions cached for chunk generation aren't disturbed
+	std::unique_ptr<NoiseRegionCache> benchmarkRegionCache = std::make_unique<NoiseRegionCache>();
+	std::vector<ChunkElevations> exactElevations(chunkStartingPositions.size());
+	std::vector<ChunkBiomeTypes> exactBiomeTypes(chunkStartingPositions.size());
+	std::vector<ChunkElevations> interpolatedElevations(chunkStartingPositions.size());
+	std::vector<ChunkBiomeTypes> interpolatedBiomeTypes(chunkStartingPositions.size());
+	TerrainNoiseBenchmark benchmark;
+
+	int previousNoiseCalls = noiseCalls;
+	auto startTime = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < chunkStartingPositions.size(); ++i)
+	{
+		::sampleChunk(*benchmarkRegionCache, chunkStartingPositions[i], eNoiseSampling::Exact, exactElevations[i], exactBiomeTypes[i]);
+	}
+	auto endTime = std::chrono::high_resolution_clock::now();
+	benchmark.exactMilliseconds = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+	benchmark.exactNoiseCalls = noiseCalls - previousNoiseCalls;
+
+	previousNoiseCalls = noiseCalls;
+	startTime = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < chunkStartingPositions.size(); ++i)
+	{
+		::sampleChunk(*benchmarkRegionCache, chunkStartingPositions[i], eNoiseSampling::Interpolated, interpolatedElevations[i], interpolatedBiomeTypes[i]);
+	}
+	endTime = std::chrono::high_resolution_clock::now();
+	benchmark.interpolatedMilliseconds = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+	benchmark.interpolatedNoiseCalls = noiseCalls - previousNoiseCalls;
+
+	//Cave density comes from this thread's noise regions so they start empty as they would for unexplored terrain
+	noiseRegionCache.clear();
+	previousNoiseCalls = noiseCalls;
+	startTime = std::chrono::high_resolution_clock::now();
+	std::unique_ptr<CaveDensityField> caveDensityField = std::make_unique<CaveDensityField>();
+	for (size_t i = 0; i < chunkStartingPositions.size(); ++i)
+	{
+		caveDensityField->sample(chunkStartingPositions[i], interpolatedElevations[i]);
+		for (int z = 0; z < CaveDensityField::SECTIONS_DEPTH; ++z)
+		{
+			for (int x = 0; x < CaveDensityField::SECTIONS_WIDTH; ++x)
+			{
+				for (int y = caveDensityField->getMinSection(); y * CaveDensityField::HEIGHT_SPACING <= caveDensityField->getHighestSurface(x, z); ++y)
+				{
+					++benchmark.caveSections;
+					if (caveDensityField->getSection(x, y, z) == eCaveSection::Mixed)
+					{
+						++benchmark.mixedCaveSections;
+					}
+				}
+			}
+		}
+	}
+	endTime = std::chrono::high_resolution_clock::now();
+	benchmark.caveMilliseconds = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+	benchmark.caveNoiseCalls = noiseCalls - previousNoiseCalls;
+
+	//Each pass fills this thread's noise regions from empty so both pay what unexplored terrain would
+	//Passes take turns and the fastest of each is kept so a stall on one pass doesn't skew the comparison
+	std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>();
+	auto generateChunks = [&chunk, &chunkStartingPositions](bool caves)
+	{
+		noiseRegionCache.clear();
+		auto startTime = std::chrono::high_resolution_clock::now();
+		for (const auto& chunkStartingPosition : chunkStartingPositions)
+		{
+			chunk->reuse(chunkStartingPosition, caves);
+		}
+		return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	};
+
+	generateChunks(true);
+	benchmark.chunkMilliseconds = std::numeric_limits<float>::max();
+	benchmark.chunkWithoutCavesMilliseconds = std::numeric_limits<float>::max();
+	for (int i = 0; i < CHUNK_BENCHMARK_ROUNDS; ++i)
+	{
+		benchmark.chunkWithoutCavesMilliseconds = std::min(benchmark.chunkWithoutCavesMilliseconds, generateChunks(false));
+		benchmark.chunkMilliseconds = std::min(benchmark.chunkMilliseconds, generateChunks(true));
+	}
+	benchmark.chunks = static_cast<int>(chunkStartingPositions.size());
+
+	int totalElevationDifference = 0;
+	for (size_t i = 0; i < chunkStartingPositions.size(); ++i)
+	{
+		for (size_t column = 0; column < exactElevations[i].size(); ++column)
+		{
+			int elevationDifference = std::abs(exactElevations[i][column] - interpolatedElevations[i][column]);
+			totalElevationDifference += elevationDifference;
+			benchmark.maxElevationDifference = std::max(benchmark.maxElevationDifference, elevationDifference);
+			if (exactBiomeTypes[i][column] != interpolatedBiomeTypes[i][column])
+			{
+				++benchmark.biomeMismatches;
+			}
+		}
+	}
+
+	benchmark.columns = static_cast<int>(chunkStartingPositions.size() * exactElevations.front().size());
+	benchmark.meanElevationDifference = static_cast<float>(totalElevationDifference) / benchmark.columns;
+
+	return benchmark;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include "Globals.h"
+#include <array>
+#include <cstdint>
+
+enum class eBiomeType
+{
+	Plains = 0,
+	Desert
+};
+
+enum class eNoiseSampling
+{
+	Exact = 0,
+	//Low octaves sampled every few blocks and interpolated - shared between chunks in the same region
+	Interpolated
+};
+
+using ChunkElevations = std::array<int, Globals::CHUNK_WIDTH * Globals::CHUNK_DEPTH>;
+using ChunkBiomeTypes = std::array<eBiomeType, Globals::CHUNK_WIDTH * Globals::CHUNK_DEPTH>;
+
+enum class eCaveSection
+{
+	Solid = 0,
+	Carved,
+	Mixed
+};
+
+//3D cave density for one chunk, sampled every SPACING blocks across and HEIGHT_SPACING blocks up
+//Cubes where the interpolated density is above DENSITY_THRESHOLD are carved out
+class CaveDensityField
+{
+public:
+	static constexpr int SPACING = 4;
+	static constexpr int HEIGHT_SPACING = 8;
+	static constexpr int SECTIONS_WIDTH = Globals::CHUNK_WIDTH / SPACING;
+	static constexpr int SECTIONS_HEIGHT = Globals::CHUNK_HEIGHT / HEIGHT_SPACING;
+	static constexpr int SECTIONS_DEPTH = Globals::CHUNK_DEPTH / SPACING;
+	static constexpr int SECTION_VOLUME = SPACING * HEIGHT_SPACING * SPACING;
+	static constexpr float DENSITY_THRESHOLD = 0.45f;
+
+	CaveDensityField();
+
+	//Only sections between the water line and the highest column beneath them are sampled
+	void sample(const glm::ivec3& chunkStartingPosition, const ChunkElevations& elevations);
+	int getMinSection() const;
+	int getHighestSurface(int sectionX, int sectionZ) const;
+	//The interpolated density never leaves the range of a section's corners
+	eCaveSection getSection(int sectionX, int sectionY, int sectionZ) const;
+	//Indexed (y * SPACING + z) * SPACING + x from the section's lowest corner
+	void interpolateSection(int sectionX, int sectionY, int sectionZ, std::array<float, SECTION_VOLUME>& densities) const;
+
+private:
+	static constexpr int LATTICE_WIDTH = SECTIONS_WIDTH + 1;
+	static constexpr int LATTICE_HEIGHT = SECTIONS_HEIGHT + 1;
+	static constexpr int LATTICE_DEPTH = SECTIONS_DEPTH + 1;
+
+	std::array<float, LATTICE_WIDTH * LATTICE_HEIGHT * LATTICE_DEPTH> m_densities;
+	std::array<int, SECTIONS_WIDTH * SECTIONS_DEPTH> m_highestSurfaces;
+
+	float getDensity(int latticeX, int latticeY, int latticeZ) const;
+};
+
+struct TerrainNoiseBenchmark
+{
+	int columns = 0;
+	int exactNoiseCalls = 0;
+	int interpolatedNoiseCalls = 0;
+	float exactMilliseconds = 0.0f;
+	float interpolatedMilliseconds = 0.0f;
+	int maxElevationDifference = 0;
+	float meanElevationDifference = 0.0f;
+	int biomeMismatches = 0;
+	int caveNoiseCalls = 0;
+	float caveMilliseconds = 0.0f;
+	int caveSections = 0;
+	int mixedCaveSections = 0;
+	int chunks = 0;
+	float chunkMilliseconds = 0.0f;
+	float chunkWithoutCavesMilliseconds = 0.0f;
+};
+
+namespace TerrainNoise
+{
+	constexpr eNoiseSampling SAMPLING = eNoiseSampling::Interpolated;
+
+	int getElevation(int x, int z);
+	//Seeds random structure placement so a chunk places the same structures whenever it is generated
+	uint32_t getStructureSeed(const glm::ivec3& chunkStartingPosition);
+	eBiomeType getBiomeType(int x, int z);
+
+	//Columns are indexed z * CHUNK_WIDTH + x
+	void sampleChunk(const glm::ivec3& chunkStartingPosition, eNoiseSampling sampling,
+		ChunkElevations& elevations, ChunkBiomeTypes& biomeTypes);
+
+	//Samples the chunks around the position both ways and compares the results
+	//Then generates the same chunks with and without caves to show what carving them costs
+	//Takes long enough to stall a frame and empties the calling thread's noise regions - run it on a thread of its own
+	TerrainNoiseBenchmark runBenchmark(const glm::ivec3& position, int chunkRadius);
+}
\ No newline at end of file
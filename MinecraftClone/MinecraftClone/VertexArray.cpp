@@ -9,10 +9,7 @@ VertexArray::VertexArray()
 	m_transparentVertexBuffer(),
 	m_opaqueID(Globals::INVALID_OPENGL_ID),
 	m_transparentID(Globals::INVALID_OPENGL_ID)
-{
-	glGenVertexArrays(1, &m_opaqueID);
-	glGenVertexArrays(1, &m_transparentID);
-}
+{}
 
 VertexArray::~VertexArray()
 {
@@ -57,12 +54,22 @@ void VertexArray::reset()
 
 void VertexArray::attachOpaqueVBO()
 {
+	if (m_opaqueID == Globals::INVALID_OPENGL_ID)
+	{
+		glGenVertexArrays(1, &m_opaqueID);
+	}
+
 	bindOpaqueVAO();
 	m_opaqueVertexBuffer.bind();
 }
 
 void VertexArray::attachTransparentVBO()
 {	
+	if (m_transparentID == Globals::INVALID_OPENGL_ID)
+	{
+		glGenVertexArrays(1, &m_transparentID);
+	}
+
 	bindTransparentVAO();
 	m_transparentVertexBuffer.bind();
 }
@@ -79,14 +86,13 @@ void VertexArray::bindTransparentVAO() const
 
 void VertexArray::onDestroy()
 {
-	if (m_opaqueID != Globals::INVALID_OPENGL_ID &&
-		m_transparentID != Globals::INVALID_OPENGL_ID)
+	if (m_opaqueID != Globals::INVALID_OPENGL_ID)
 	{
 		glDeleteVertexArrays(1, &m_opaqueID);
-		glDeleteVertexArrays(1, &m_transparentID);
 	}
-	else
+
+	if (m_transparentID != Globals::INVALID_OPENGL_ID)
 	{
-		assert(m_opaqueID == Globals::INVALID_OPENGL_ID && m_transparentID == Globals::INVALID_OPENGL_ID);
+		glDeleteVertexArrays(1, &m_transparentID);
 	}
 }
@@ -1,5 +1,6 @@
 #include "VertexBuffer.h"
 #include "VertexArray.h"
+#include "MemoryAccounting.h"
 #include <iostream>
 
 VertexBuffer::VertexBuffer()
@@ -13,13 +14,10 @@ VertexBuffer::VertexBuffer()
 	textCoordsID(Globals::INVALID_OPENGL_ID),
 	textCoords(),
 	indiciesID(Globals::INVALID_OPENGL_ID),
-	indicies()
-{
-	glGenBuffers(1, &positionsID);
-	glGenBuffers(1, &lightIntensityID);
-	glGenBuffers(1, &textCoordsID);
-	glGenBuffers(1, &indiciesID);
-}
+	indicies(),
+	CPUMemoryUsage(0),
+	GPUMemoryUsage(0)
+{}
 
 VertexBuffer::VertexBuffer(VertexBuffer&& rhs) noexcept
 	: elementBufferIndex(rhs.elementBufferIndex),
@@ -32,8 +30,12 @@ VertexBuffer::VertexBuffer(VertexBuffer&& rhs) noexcept
 	textCoordsID(rhs.textCoordsID),
 	textCoords(std::move(rhs.textCoords)),
 	indiciesID(rhs.indiciesID),
-	indicies(std::move(rhs.indicies))
+	indicies(std::move(rhs.indicies)),
+	CPUMemoryUsage(rhs.CPUMemoryUsage),
+	GPUMemoryUsage(rhs.GPUMemoryUsage)
 {
+	rhs.CPUMemoryUsage = 0;
+	rhs.GPUMemoryUsage = 0;
 	rhs.elementBufferIndex = 0;
 	rhs.bindToVAO = false;
 	rhs.displayable = false;
@@ -61,7 +63,11 @@ VertexBuffer& VertexBuffer::operator=(VertexBuffer&& rhs) noexcept
 		textCoords = std::move(rhs.textCoords);
 		indiciesID = rhs.indiciesID;
 		indicies = std::move(rhs.indicies);
+		CPUMemoryUsage = rhs.CPUMemoryUsage;
+		GPUMemoryUsage = rhs.GPUMemoryUsage;
 
+		rhs.CPUMemoryUsage = 0;
+		rhs.GPUMemoryUsage = 0;
 		rhs.elementBufferIndex = 0;
 		rhs.bindToVAO = false;
 		rhs.displayable = false;
@@ -85,6 +91,15 @@ void VertexBuffer::bind()
 	bindToVAO = false;
 	displayable = true;
 
+	//Generated on first upload so vertex buffers can be created away from the OpenGL context thread
+	if (positionsID == Globals::INVALID_OPENGL_ID)
+	{
+		glGenBuffers(1, &positionsID);
+		glGenBuffers(1, &lightIntensityID);
+		glGenBuffers(1, &textCoordsID);
+		glGenBuffers(1, &indiciesID);
+	}
+
 	if (!positions.empty())
 	{
 		glBindBuffer(GL_ARRAY_BUFFER, positionsID);
@@ -115,6 +130,13 @@ void VertexBuffer::bind()
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indiciesID);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicies.size() * sizeof(unsigned int), indicies.data(), GL_STATIC_DRAW);
 
+	size_t uploadedMemory = positions.size() * sizeof(glm::vec3) +
+		lightIntensityVertices.size() * sizeof(float) +
+		textCoords.size() * sizeof(glm::vec3) +
+		indicies.size() * sizeof(unsigned int);
+	MemoryAccounting::onResize(eMemoryCategory::GPUMeshes, GPUMemoryUsage, uploadedMemory);
+	GPUMemoryUsage = uploadedMemory;
+
 	//glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	std::vector<glm::vec3> newPositions;
@@ -127,6 +149,7 @@ void VertexBuffer::bind()
 	lightIntensityVertices.swap(newLightIntensityVertices);
 
 	indicies.shrink_to_fit();
+	updateCPUMemoryUsage();
 }
 
 void VertexBuffer::clear()
@@ -146,10 +169,28 @@ void VertexBuffer::clear()
 	
 	std::vector<unsigned int> newIndicies;
 	indicies.swap(newIndicies);
+
+	updateCPUMemoryUsage();
+}
+
+void VertexBuffer::updateCPUMemoryUsage()
+{
+	size_t memoryUsage = positions.capacity() * sizeof(glm::vec3) +
+		lightIntensityVertices.capacity() * sizeof(float) +
+		textCoords.capacity() * sizeof(glm::vec3) +
+		indicies.capacity() * sizeof(unsigned int);
+
+	MemoryAccounting::onResize(eMemoryCategory::CPUMeshes, CPUMemoryUsage, memoryUsage);
+	CPUMemoryUsage = memoryUsage;
 }
 
 void VertexBuffer::onDestroy()
 {
+	MemoryAccounting::onRelease(eMemoryCategory::CPUMeshes, CPUMemoryUsage);
+	MemoryAccounting::onRelease(eMemoryCategory::GPUMeshes, GPUMemoryUsage);
+	CPUMemoryUsage = 0;
+	GPUMemoryUsage = 0;
+
 	if (positionsID != Globals::INVALID_OPENGL_ID &&
 		lightIntensityID != Globals::INVALID_OPENGL_ID &&
 		textCoordsID != Globals::INVALID_OPENGL_ID &&
@@ -16,6 +16,7 @@ struct VertexBuffer : private NonCopyable
 
 	void bind();
 	void clear();
+	void updateCPUMemoryUsage();
 
 	int elementBufferIndex;
 	bool bindToVAO;
@@ -30,5 +31,8 @@ struct VertexBuffer : private NonCopyable
 	std::vector<unsigned int> indicies;
 
 private:
+	size_t CPUMemoryUsage;
+	size_t GPUMemoryUsage;
+
 	void onDestroy();
 };
\ No newline at end of file
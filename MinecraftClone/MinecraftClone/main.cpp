@@ -16,6 +16,13 @@
 #include "SelectedVoxelVisual.h"
 #include "FrameBuffer.h"
 #include "PickupManager.h"
+#include "TerrainNoise.h"
+#include "FarTerrain.h"
+#include "GameMessenger.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include "GPUTimer.h"
+#include "InstrumentedMutex.h"
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -24,6 +31,7 @@
 #include <memory>
 #include <unordered_map>
 #include <thread>
+#include <future>
 
 #include "BoundingBox.h"
 
@@ -146,13 +154,31 @@ int main()
 	FrameBuffer frameBuffer(windowSize);
 	Gui gui(windowSize);
 	Frustum frustum;
+	FarTerrain farTerrain;
+	GPUTimer renderPassTimer;
 	Player player;
+	AutoVisibilityDistance autoVisibilityDistance(Globals::AUTO_VISIBILITY_TARGET_FRAME_TIME);
 	std::atomic<bool> resetGame = false;
-	std::mutex renderingMutex;
-	std::mutex chunkInteractionMutex;
+	InstrumentedMutex renderingMutex("Rendering");
+	InstrumentedMutex chunkInteractionMutex("Chunk interaction");
+	MetricsDump metricsDump("Metrics.jsonl", eMetricsDumpFormat::JSONLines, Globals::METRICS_DUMP_INTERVAL);
+	MetricHistogram& frameTime = Metrics::getHistogram("Frame time (us)");
+	MetricGauge& voxelMemoryUsage = Metrics::getGauge("Voxel bytes");
+	MetricGauge& CPUMeshMemoryUsage = Metrics::getGauge("CPU mesh bytes");
+	MetricGauge& GPUMeshMemoryUsage = Metrics::getGauge("GPU mesh bytes");
+	MetricGauge& queuedMessages = Metrics::getGauge("Queued messages");
+	MetricGauge& messagesQueued = Metrics::getGauge("Messages queued");
+	MetricGauge& messagesDelivered = Metrics::getGauge("Messages delivered");
+	MetricGauge& messagesDropped = Metrics::getGauge("Messages dropped");
+	std::vector<std::string> metricsOverlayLines;
+	std::vector<std::string> lockContentionLines;
+	//Generates a few hundred chunks so it runs on its own thread and is reported once done
+	std::future<TerrainNoiseBenchmark> terrainNoiseBenchmark;
+	float metricsOverlayElapsedTime = Globals::METRICS_OVERLAY_INTERVAL;
 	float deltaTime = 0.0f;
 	sf::Clock deltaClock;
 	deltaClock.restart();
+	sf::Clock frameClock;
 
 	std::thread chunkGenerationThread([&](std::unique_ptr<ChunkManager>* chunkGenerator)
 		{chunkGenerator->get()->update(std::ref(player), std::ref(window), std::ref(resetGame), 
@@ -165,9 +191,12 @@ int main()
 	std::cout << glGetError() << "\n";
 	std::cout << glGetError() << "\n\n\n";
 
+	PROFILE_THREAD_NAME("Main");
 	while (window.isOpen())
 	{
+		PROFILE_SCOPE("Frame");
 		deltaTime = deltaClock.restart().asSeconds();
+		frameClock.restart();
 
 		//Handle Inputs
 		sf::Event currentSFMLEvent;
@@ -182,11 +211,14 @@ int main()
 				switch (currentSFMLEvent.key.code)
 				{
 				case sf::Keyboard::R:
+				{
 					resetGame = true;
 					chunkGenerationThread.join();
 					resetGame = false;
+					int visibilityDistance = chunkManager->getVisibilityDistance();
+					size_t memoryBudget = chunkManager->getMemoryBudget();
 					chunkManager.reset();
-					chunkManager = std::make_unique<ChunkManager>();
+					chunkManager = std::make_unique<ChunkManager>(visibilityDistance, memoryBudget);
 
 					chunkGenerationThread = std::thread{ [&](std::unique_ptr<ChunkManager>* chunkManager)
 						{chunkManager->get()->update(std::ref(player), std::ref(window), std::ref(resetGame),
@@ -194,18 +226,76 @@ int main()
 
 					player.spawn(*chunkManager, chunkInteractionMutex);
 					break;
+				}
+				case sf::Keyboard::PageUp:
+					autoVisibilityDistance.setEnabled(false);
+					chunkManager->setVisibilityDistance(chunkManager->getVisibilityDistance() + Globals::CHUNK_WIDTH);
+					break;
+				case sf::Keyboard::PageDown:
+					autoVisibilityDistance.setEnabled(false);
+					chunkManager->setVisibilityDistance(chunkManager->getVisibilityDistance() - Globals::CHUNK_WIDTH);
+					break;
+				case sf::Keyboard::Home:
+					autoVisibilityDistance.setEnabled(!autoVisibilityDistance.isEnabled());
+					break;
+				case sf::Keyboard::F3:
+				{
+					if (!terrainNoiseBenchmark.valid())
+					{
+						terrainNoiseBenchmark = std::async(std::launch::async, [](const glm::vec3& position)
+						{
+							PROFILE_THREAD_NAME("Terrain noise benchmark");
+							return TerrainNoise::runBenchmark(position, 8);
+						}, player.getPosition());
+					}
+
+					break;
+				}
+				case sf::Keyboard::F4:
+				{
+					size_t profileEventCount = Profiler::exportChromeTrace("ProfileTrace.json");
+					std::cout << "Wrote " << profileEventCount << " profile events to ProfileTrace.json\n";
+					break;
+				}
+				case sf::Keyboard::F5:
+					gui.setMetricsOverlayActive(!gui.isMetricsOverlayActive());
+					metricsOverlayElapsedTime = Globals::METRICS_OVERLAY_INTERVAL;
+					break;
 				case sf::Keyboard::Escape:
 					window.close();
 					break;
 				}
 			}
 
-			player.handleInputEvents(currentSFMLEvent, *chunkManager, chunkInteractionMutex, window);
+			player.handleInputEvents(currentSFMLEvent);
+		}
+
+		if (terrainNoiseBenchmark.valid() && terrainNoiseBenchmark.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			//Written out with the rest of the metrics on the next dump
+			TerrainNoiseBenchmark benchmark = terrainNoiseBenchmark.get();
+			Metrics::getGauge("Benchmark terrain columns").set(benchmark.columns);
+			Metrics::getGauge("Benchmark exact noise calls").set(benchmark.exactNoiseCalls);
+			Metrics::getGauge("Benchmark exact noise time (us)").set(static_cast<int64_t>(benchmark.exactMilliseconds * 1000.0f));
+			Metrics::getGauge("Benchmark interpolated noise calls").set(benchmark.interpolatedNoiseCalls);
+			Metrics::getGauge("Benchmark interpolated noise time (us)").set(static_cast<int64_t>(benchmark.interpolatedMilliseconds * 1000.0f));
+			Metrics::getGauge("Benchmark max elevation difference").set(benchmark.maxElevationDifference);
+			Metrics::getGauge("Benchmark biome mismatches").set(benchmark.biomeMismatches);
+			Metrics::getGauge("Benchmark cave noise calls").set(benchmark.caveNoiseCalls);
+			Metrics::getGauge("Benchmark cave time (us)").set(static_cast<int64_t>(benchmark.caveMilliseconds * 1000.0f));
+			Metrics::getGauge("Benchmark cave sections").set(benchmark.caveSections);
+			Metrics::getGauge("Benchmark mixed cave sections").set(benchmark.mixedCaveSections);
+			Metrics::getGauge("Benchmark chunks").set(benchmark.chunks);
+			Metrics::getGauge("Benchmark chunk time (us)").set(static_cast<int64_t>(benchmark.chunkMilliseconds * 1000.0f));
+			Metrics::getGauge("Benchmark chunk without caves time (us)").set(static_cast<int64_t>(benchmark.chunkWithoutCavesMilliseconds * 1000.0f));
+			std::cout << "Terrain noise benchmark finished - results are in Metrics.jsonl\n";
 		}
 
 		//Update
+		deliverQueuedMessages();
 		player.update(deltaTime, chunkInteractionMutex, *chunkManager.get(), window);
 		pickupManager.update(deltaTime, player, chunkInteractionMutex, *chunkManager);
+		farTerrain.update(player.getPosition());
 
 		glm::mat4 view = glm::lookAt(player.getPosition(), player.getPosition() + player.getCamera().front, player.getCamera().up);
 		glm::mat4 projection = glm::perspective(glm::radians(player.getCamera().FOV),
@@ -213,66 +303,136 @@ int main()
 
 		frustum.update(projection * view);
 	
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		shaderHandler->switchToShader(eShaderType::Chunk);
-		shaderHandler->setUniformMat4f(eShaderType::Chunk, "uView", view);
-		shaderHandler->setUniformMat4f(eShaderType::Chunk, "uProjection", projection);
+		Metrics::resetFrameDraws();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-		std::lock_guard<std::mutex> renderingLock(renderingMutex);
+		InstrumentedLock renderingLock(renderingMutex, LOCK_SITE("Render"));
+		chunkManager->destroyRetiredChunkMeshes();
 		glEnable(GL_CULL_FACE);
 		glCullFace(GL_BACK);
 
-		textureArray->bind();
-		chunkManager->renderOpaque(frustum);
+		//Draw Opaque Chunks - marking the pixels covered by chunks so the far terrain only fills the rest
+		{
+			PROFILE_SCOPE("Render opaque chunks");
+			ScopedGPUTimer renderPassTimerScope(renderPassTimer, eRenderPass::OpaqueChunks);
+			shaderHandler->switchToShader(eShaderType::Chunk);
+			shaderHandler->setUniformMat4f(eShaderType::Chunk, "uView", view);
+			shaderHandler->setUniformMat4f(eShaderType::Chunk, "uProjection", projection);
+
+			textureArray->bind();
+			glEnable(GL_STENCIL_TEST);
+			glStencilFunc(GL_ALWAYS, 1, 0xFF);
+			glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+			chunkManager->renderOpaque(frustum);
+			glDisable(GL_STENCIL_TEST);
+		}
+
+		{
+			ScopedGPUTimer renderPassTimerScope(renderPassTimer, eRenderPass::Pickups);
+			pickupManager.render(frustum, *shaderHandler, view, projection);
+		}
 
-		pickupManager.render(frustum, *shaderHandler, view, projection);
+		//Draw Far Terrain - behind the chunks and in front of the skybox
+		glEnable(GL_STENCIL_TEST);
+		glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
+		glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+		{
+			ScopedGPUTimer renderPassTimerScope(renderPassTimer, eRenderPass::FarTerrain);
+			farTerrain.render(*shaderHandler, view, projection, player.getPosition(), chunkManager->getVisibilityDistance());
+		}
+		glDisable(GL_STENCIL_TEST);
 
 		glDisable(GL_CULL_FACE);
 		glEnable(GL_BLEND);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-		shaderHandler->switchToShader(eShaderType::Chunk);
-		shaderHandler->setUniformMat4f(eShaderType::Chunk, "uView", view);
-		shaderHandler->setUniformMat4f(eShaderType::Chunk, "uProjection", projection);
-		chunkManager->renderTransparent(frustum);
-
-		destroyBlockTexture->bind();
-		shaderHandler->switchToShader(eShaderType::DestroyBlock);
-		shaderHandler->setUniformMat4f(eShaderType::DestroyBlock, "uView", view);
-		shaderHandler->setUniformMat4f(eShaderType::DestroyBlock, "uProjection", projection);
-		player.renderDestroyBlock();
+		//Draw Transparent Chunks
+		{
+			PROFILE_SCOPE("Render transparent chunks");
+			ScopedGPUTimer renderPassTimerScope(renderPassTimer, eRenderPass::TransparentChunks);
+			shaderHandler->switchToShader(eShaderType::Chunk);
+			shaderHandler->setUniformMat4f(eShaderType::Chunk, "uView", view);
+			shaderHandler->setUniformMat4f(eShaderType::Chunk, "uProjection", projection);
+			chunkManager->renderTransparent(frustum);
+		}
 
-		if (!player.getDestroyCubeTimer().isActive())
+		//Draw Player Visuals
 		{
-			glPolygonOffset(-1.f, -2.f);
-			glEnable(GL_POLYGON_OFFSET_FILL);
-			//https://www.khronos.org/registry/OpenGL-Refpages/es2.0/xhtml/glPolygonOffset.xml
-			voxelSelectionTexture->bind();
-			shaderHandler->switchToShader(eShaderType::SelectedVoxel);
-			shaderHandler->setUniformMat4f(eShaderType::SelectedVoxel, "uView", view);
-			shaderHandler->setUniformMat4f(eShaderType::SelectedVoxel, "uProjection", projection);
-			player.renderSelectedVoxel();
-			glDisable(GL_POLYGON_OFFSET_FILL);
+			PROFILE_SCOPE("Render player visuals");
+			ScopedGPUTimer renderPassTimerScope(renderPassTimer, eRenderPass::PlayerVisuals);
+			destroyBlockTexture->bind();
+			shaderHandler->switchToShader(eShaderType::DestroyBlock);
+			shaderHandler->setUniformMat4f(eShaderType::DestroyBlock, "uView", view);
+			shaderHandler->setUniformMat4f(eShaderType::DestroyBlock, "uProjection", projection);
+			player.renderDestroyBlock();
+
+			if (!player.getDestroyCubeTimer().isActive())
+			{
+				glPolygonOffset(-1.f, -2.f);
+				glEnable(GL_POLYGON_OFFSET_FILL);
+				//https://www.khronos.org/registry/OpenGL-Refpages/es2.0/xhtml/glPolygonOffset.xml
+				voxelSelectionTexture->bind();
+				shaderHandler->switchToShader(eShaderType::SelectedVoxel);
+				shaderHandler->setUniformMat4f(eShaderType::SelectedVoxel, "uView", view);
+				shaderHandler->setUniformMat4f(eShaderType::SelectedVoxel, "uProjection", projection);
+				player.renderSelectedVoxel();
+				glDisable(GL_POLYGON_OFFSET_FILL);
+			}
 		}
 
 		glDisable(GL_BLEND);
 
 		//Draw Skybox
-		glDepthFunc(GL_LEQUAL);
-		shaderHandler->switchToShader(eShaderType::Skybox);
-		shaderHandler->setUniformMat4f(eShaderType::Skybox, "uView", glm::mat4(glm::mat3(view)));
-		shaderHandler->setUniformMat4f(eShaderType::Skybox, "uProjection", projection);
-
-		skybox->render();
-		glDepthFunc(GL_LESS);
+		{
+			PROFILE_SCOPE("Render skybox");
+			ScopedGPUTimer renderPassTimerScope(renderPassTimer, eRenderPass::Skybox);
+			glDepthFunc(GL_LEQUAL);
+			shaderHandler->switchToShader(eShaderType::Skybox);
+			shaderHandler->setUniformMat4f(eShaderType::Skybox, "uView", glm::mat4(glm::mat3(view)));
+			shaderHandler->setUniformMat4f(eShaderType::Skybox, "uProjection", projection);
+
+			skybox->render();
+			glDepthFunc(GL_LESS);
+		}
 
 		//Draw GUI
-		textureArray->bind();
-		gui.render(*shaderHandler, *widjetsTexture, *fontTexture);
+		{
+			PROFILE_SCOPE("Render GUI");
+			ScopedGPUTimer renderPassTimerScope(renderPassTimer, eRenderPass::Gui);
+			textureArray->bind();
+			gui.render(*shaderHandler, *widjetsTexture, *fontTexture);
+		}
+		renderPassTimer.endFrame();
 		
+		autoVisibilityDistance.update(deltaTime, frameClock.getElapsedTime().asSeconds(), *chunkManager);
+
+		frameTime.record(frameClock.getElapsedTime().asMicroseconds());
+		MemoryUsage memoryUsage = chunkManager->getMemoryUsage();
+		voxelMemoryUsage.set(static_cast<int64_t>(memoryUsage.voxels));
+		CPUMeshMemoryUsage.set(static_cast<int64_t>(memoryUsage.CPUMeshes));
+		GPUMeshMemoryUsage.set(static_cast<int64_t>(memoryUsage.GPUMeshes));
+		MessageQueueStats messageQueueStats = getQueuedMessageStats();
+		queuedMessages.set(static_cast<int64_t>(messageQueueStats.depth));
+		messagesQueued.set(static_cast<int64_t>(messageQueueStats.queued));
+		messagesDelivered.set(static_cast<int64_t>(messageQueueStats.delivered));
+		messagesDropped.set(static_cast<int64_t>(messageQueueStats.dropped));
+		metricsDump.update(deltaTime);
+
+		//Shows up from the next frame
+		metricsOverlayElapsedTime += deltaTime;
+		if (gui.isMetricsOverlayActive() && metricsOverlayElapsedTime >= Globals::METRICS_OVERLAY_INTERVAL)
+		{
+			metricsOverlayElapsedTime = 0.0f;
+			Metrics::getSummary(metricsOverlayLines);
+			getLockContentionSummary(lockContentionLines, Globals::MOST_CONTENDED_LOCK_SITES);
+			metricsOverlayLines.insert(metricsOverlayLines.end(), lockContentionLines.cbegin(), lockContentionLines.cend());
+			gui.setMetricsOverlayText(metricsOverlayLines);
+		}
 
-		window.display();
+		{
+			PROFILE_SCOPE("Display");
+			window.display();
+		}
 	}
 
 	chunkGenerationThread.join();